@@ -1,14 +1,15 @@
 #ifndef _AUTH_HANDLER_H_
 #define _AUTH_HANDLER_H_
 
-#include <Sockets/SocketHandler.h>
+#include "PolledSocketHandler.h"
+#include <string>
 
 /**
  * @brief Authentication socket handler
  * 
  * AuthHandler manages authentication socket connections and events.
  */
-class AuthHandler : public SocketHandler {
+class AuthHandler : public PolledSocketHandler {
 public:
     /**
      * @brief Default constructor
@@ -2,6 +2,7 @@
 #define _AUTH_SOCKET_H_
 
 #include "ByteBuffer.h"
+#include "ByteBufferPool.h"
 #include "MessageTypes.h"
 #include <Sockets/Socket.h>
 #include <Sockets/SocketHandler.h>
@@ -247,6 +248,14 @@ private:
      */
     void BuildHeader(uint16_t type, uint32_t length, ByteBuffer& buffer);
     
+    /**
+     * @brief Acquire a pooled send buffer
+     * 
+     * @param length Message length that will follow the header
+     * @return Empty buffer from the thread's ByteBufferPool
+     */
+    PooledBuffer AcquireSendBuffer(size_t length) { return PooledBuffer(COMMON_HEADER_SIZE + length); }
+    
     /**
      * @brief Send raw data
      * 
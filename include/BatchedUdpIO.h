@@ -0,0 +1,133 @@
+#ifndef _BATCHED_UDP_IO_H_
+#define _BATCHED_UDP_IO_H_
+
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#endif
+
+/**
+ * @brief Batched UDP receive and send
+ * 
+ * BatchedUdpIO pulls up to a batch of datagrams per system call with
+ * recvmmsg and collects outbound datagrams for a tick so they can be
+ * flushed with a single sendmmsg. On platforms without these calls it
+ * falls back to one recvfrom/sendto per datagram with the same API.
+ */
+class BatchedUdpIO {
+public:
+    /**
+     * @brief Callback for a received datagram
+     * 
+     * Called with the datagram data, its length and the sender address.
+     * The data is only valid for the duration of the call.
+     */
+    typedef std::function<void(const char*, size_t, struct sockaddr*, socklen_t)> ReceiveCallback;
+
+    /**
+     * @brief I/O statistics
+     */
+    struct Stats {
+        uint64_t receiveCalls;       ///< Receive system calls
+        uint64_t datagramsReceived;  ///< Datagrams received
+        uint64_t sendCalls;          ///< Send system calls
+        uint64_t datagramsSent;      ///< Datagrams sent
+        uint64_t sendErrors;         ///< Datagrams that could not be sent
+    };
+
+    /**
+     * @brief Constructor
+     * 
+     * @param batchSize Maximum datagrams per system call
+     * @param maxDatagramSize Largest datagram accepted on receive
+     */
+    BatchedUdpIO(size_t batchSize = 64, size_t maxDatagramSize = 2048);
+
+    /**
+     * @brief Receive all pending datagrams
+     * 
+     * Reads in batches until the socket has no more data or maxBatches
+     * batches have been read, calling the callback for every datagram.
+     * Truncated datagrams are dropped without a callback. The reads
+     * never block, but the socket should still be non-blocking.
+     * 
+     * @param fd Socket descriptor
+     * @param callback Callback for each datagram
+     * @param maxBatches Maximum batches to read in this call
+     * @return Number of datagrams passed to the callback
+     */
+    size_t Receive(int fd, const ReceiveCallback& callback, size_t maxBatches = 8);
+
+    /**
+     * @brief Queue a datagram for the next flush
+     * 
+     * @param addr Destination address
+     * @param addrLen Destination address length, clamped to sockaddr_storage
+     * @param chain Datagram segments
+     */
+    void Queue(const struct sockaddr* addr, socklen_t addrLen, ByteBufferChain&& chain);
+
+    /**
+     * @brief Queue a datagram for the next flush
+     * 
+     * @param addr Destination address
+     * @param addrLen Destination address length
+     * @param datagram Datagram data
+     */
+    void Queue(const struct sockaddr* addr, socklen_t addrLen, ByteBuffer&& datagram);
+
+    /**
+     * @brief Get the number of queued datagrams
+     * 
+     * @return Number of queued datagrams
+     */
+    size_t GetQueuedCount() const { return m_outbound.size(); }
+
+    /**
+     * @brief Send all queued datagrams
+     * 
+     * @param fd Socket descriptor
+     * @return Number of datagrams sent
+     */
+    size_t Flush(int fd);
+
+    /**
+     * @brief Get I/O statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const { stats = m_stats; }
+
+private:
+    /**
+     * @brief Queued outbound datagram
+     */
+    struct Outbound {
+        struct sockaddr_storage addr;  ///< Destination address
+        socklen_t addrLen;             ///< Destination address length
+        ByteBufferChain chain;         ///< Datagram segments
+    };
+
+    size_t m_batchSize;                     ///< Maximum datagrams per system call
+    size_t m_maxDatagramSize;               ///< Receive buffer size per datagram
+    std::vector<char> m_recvData;           ///< Receive buffers for one batch
+    std::vector<struct sockaddr_storage> m_recvAddrs; ///< Sender addresses for one batch
+    std::vector<Outbound> m_outbound;       ///< Datagrams queued for the next flush
+#if defined(__linux__)
+    std::vector<struct mmsghdr> m_recvMsgs; ///< recvmmsg headers
+    std::vector<struct iovec> m_recvIovs;   ///< recvmmsg buffers
+    std::vector<struct mmsghdr> m_sendMsgs; ///< sendmmsg headers
+    std::vector<struct iovec> m_sendIovs;   ///< sendmmsg segments
+#endif
+    Stats m_stats;                          ///< I/O statistics
+};
+
+#endif // _BATCHED_UDP_IO_H_
@@ -0,0 +1,120 @@
+#ifndef _BROADCAST_ENGINE_H_
+#define _BROADCAST_ENGINE_H_
+
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include "MessageTypes.h"
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+class GameSocket;
+class GameHandler;
+class GameShardSet;
+class InterestManager;
+
+/**
+ * @brief Serialize-once fan-out of game messages
+ * 
+ * A broadcast message is serialized exactly once into an immutable,
+ * reference counted message block. Every recipient's packet then only
+ * adds its own game header (sequence, ack, flags) in front of the shared
+ * block, and encryption when the connection requires it.
+ */
+class BroadcastEngine {
+public:
+    /**
+     * @brief Broadcast statistics
+     */
+    struct Stats {
+        uint64_t messagesSerialized;  ///< Messages serialized
+        uint64_t bytesSerialized;     ///< Bytes produced by serialization
+        uint64_t packetsSent;         ///< Packets handed to recipients
+        uint64_t bytesSent;           ///< Block bytes queued to recipients (headers are per packet)
+    };
+
+    /**
+     * @brief Default constructor
+     */
+    BroadcastEngine();
+
+    /**
+     * @brief Serialize a message into a shared message block
+     * 
+     * @param message Message to serialize
+     * @return Immutable block (type, length, data), or null if the data exceeds MAX_BLOCK_DATA_SIZE
+     */
+    ByteBufferChain::SharedBuffer Serialize(const MessageBase& message);
+
+    /**
+     * @brief Send a shared message block to a list of recipients
+     * 
+     * @param type Message type
+     * @param block Shared message block; null blocks are ignored
+     * @param recipients Sockets to send to
+     * @param reliable Is the message reliable
+     * @param encrypted Encrypt the message; each recipient's packet is encrypted separately
+     */
+    void Send(uint16_t type, const ByteBufferChain::SharedBuffer& block, const std::vector<GameSocket*>& recipients, bool reliable = true, bool encrypted = false);
+
+    /**
+     * @brief Broadcast a message to all sockets in a district
+     * 
+     * @param handler Game socket handler
+     * @param district District ID
+     * @param message Message to send
+     * @param exceptId Player ID to exclude (0 = none)
+     */
+    void BroadcastToDistrict(GameHandler& handler, uint8_t district, const MessageBase& message, uint32_t exceptId = 0);
+
+    /**
+     * @brief Broadcast a message to all sockets
+     * 
+     * @param handler Game socket handler
+     * @param message Message to send
+     * @param exceptId Player ID to exclude (0 = none)
+     */
+    void BroadcastToAll(GameHandler& handler, const MessageBase& message, uint32_t exceptId = 0);
+
+    /**
+     * @brief Broadcast a message about an object to the players that see it
+     * 
+     * @param handler Game socket handler
+     * @param interest Area-of-interest manager
+     * @param objectId Object the message is about
+     * @param message Message to send
+     * @param reliable Is the message reliable
+     * @param encrypted Encrypt the message
+     */
+    void BroadcastToObservers(GameHandler& handler, const InterestManager& interest, uint32_t objectId, const MessageBase& message, bool reliable = true, bool encrypted = false);
+    
+    /**
+     * @brief Broadcast a message about an object to the players that see it, through the shards
+     * 
+     * The block is queued to the shard that owns each observer's session
+     * and sent from the shard thread.
+     * 
+     * @param shards Game receive shards
+     * @param interest Area-of-interest manager
+     * @param objectId Object the message is about
+     * @param message Message to send
+     * @param reliable Is the message reliable
+     * @param encrypted Encrypt the message
+     */
+    void BroadcastToObservers(GameShardSet& shards, const InterestManager& interest, uint32_t objectId, const MessageBase& message, bool reliable = true, bool encrypted = false);
+
+    /**
+     * @brief Get broadcast statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const;
+
+private:
+    std::atomic<uint64_t> m_messagesSerialized;  ///< Messages serialized
+    std::atomic<uint64_t> m_bytesSerialized;     ///< Bytes produced by serialization
+    std::atomic<uint64_t> m_packetsSent;         ///< Packets handed to recipients
+    std::atomic<uint64_t> m_bytesSent;           ///< Bytes sent including headers
+};
+
+#endif // _BROADCAST_ENGINE_H_
@@ -6,12 +6,47 @@
 #include <cstring>
 #include <cstdint>
 #include <cassert>
+#include <utility>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
 
 /**
  * @brief Typedef for byte
  */
 typedef uint8_t byte;
 
+/**
+ * @brief Allocator that default-initialises instead of value-initialising
+ * 
+ * Used for ByteBuffer storage so growing the buffer does not zero-fill
+ * bytes that are about to be overwritten anyway.
+ */
+template <typename T, typename A = std::allocator<T> >
+class DefaultInitAllocator : public A {
+    typedef std::allocator_traits<A> traits;
+public:
+    template <typename U>
+    struct rebind {
+        typedef DefaultInitAllocator<U, typename traits::template rebind_alloc<U> > other;
+    };
+    
+    DefaultInitAllocator() {}
+    
+    template <typename U>
+    DefaultInitAllocator(const DefaultInitAllocator<U, typename traits::template rebind_alloc<U> >& other) : A(other) {}
+    
+    template <typename U>
+    void construct(U* ptr) {
+        ::new(static_cast<void*>(ptr)) U;
+    }
+    
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        traits::construct(static_cast<A&>(*this), ptr, std::forward<Args>(args)...);
+    }
+};
+
 /**
  * @brief Class for handling binary data
  * 
@@ -20,6 +55,11 @@ typedef uint8_t byte;
  */
 class ByteBuffer {
 public:
+    /**
+     * @brief Underlying storage type
+     */
+    typedef std::vector<byte, DefaultInitAllocator<byte> > Storage;
+    
     /**
      * @brief Default constructor
      */
@@ -31,7 +71,7 @@ public:
      * @param size Initial size of the buffer
      */
     ByteBuffer(size_t size) : m_rpos(0), m_wpos(0) {
-        m_buffer.resize(size);
+        m_buffer.resize(size, 0);
     }
     
     /**
@@ -40,10 +80,7 @@ public:
      * @param data Pointer to initial data
      * @param size Size of initial data
      */
-    ByteBuffer(const byte* data, size_t size) : m_rpos(0), m_wpos(size) {
-        m_buffer.resize(size);
-        memcpy(m_buffer.data(), data, size);
-    }
+    ByteBuffer(const byte* data, size_t size) : m_rpos(0), m_wpos(size), m_buffer(data, data + size) {}
     
     /**
      * @brief Copy constructor
@@ -62,6 +99,28 @@ public:
         return *this;
     }
     
+    /**
+     * @brief Move constructor
+     */
+    ByteBuffer(ByteBuffer&& other) : m_rpos(other.m_rpos), m_wpos(other.m_wpos), m_buffer(std::move(other.m_buffer)) {
+        other.m_rpos = 0;
+        other.m_wpos = 0;
+    }
+    
+    /**
+     * @brief Move assignment operator
+     */
+    ByteBuffer& operator=(ByteBuffer&& other) {
+        if (this != &other) {
+            m_rpos = other.m_rpos;
+            m_wpos = other.m_wpos;
+            m_buffer = std::move(other.m_buffer);
+            other.m_rpos = 0;
+            other.m_wpos = 0;
+        }
+        return *this;
+    }
+    
     /**
      * @brief Get pointer to the buffer data
      * 
@@ -71,6 +130,17 @@ public:
         return m_buffer.data();
     }
     
+    /**
+     * @brief Get a writable pointer to the buffer data
+     * 
+     * For codecs that write their output in place after extendUninitialized.
+     * 
+     * @return Pointer to the buffer data
+     */
+    byte* contents() {
+        return m_buffer.data();
+    }
+    
     /**
      * @brief Get the size of the buffer
      * 
@@ -80,6 +150,15 @@ public:
         return m_buffer.size();
     }
     
+    /**
+     * @brief Get the allocated capacity of the buffer
+     * 
+     * @return Capacity of the buffer in bytes
+     */
+    size_t capacity() const {
+        return m_buffer.capacity();
+    }
+    
     /**
      * @brief Clear the buffer
      */
@@ -92,10 +171,50 @@ public:
     /**
      * @brief Resize the buffer
      * 
+     * Bytes added by growing the buffer are zeroed.
+     * 
      * @param newSize New size for the buffer
      */
     void resize(size_t newSize) {
-        m_buffer.resize(newSize);
+        m_buffer.resize(newSize, 0);
+    }
+    
+    /**
+     * @brief Reserve capacity without changing the size
+     * 
+     * Serializers that know their output length should reserve it up
+     * front so that the following writes never reallocate.
+     * 
+     * @param capacity Minimum capacity in bytes
+     */
+    void reserve(size_t capacity) {
+        m_buffer.reserve(capacity);
+    }
+    
+    /**
+     * @brief Extend the buffer past the write position with UNINITIALISED bytes
+     * 
+     * The new bytes hold whatever was left on the heap. Only for codecs
+     * and assemblers that fill the range in place (through contents()
+     * or writeAt) and then set wpos; if they fill less than they asked
+     * for, they must call shrinkToWpos so size() stops covering the
+     * garbage. Sequential writers want reserve instead.
+     * 
+     * @param size Number of bytes past wpos
+     * @return Pointer to the first new byte
+     */
+    byte* extendUninitialized(size_t size) {
+        grow(size);
+        return m_buffer.data() + m_wpos;
+    }
+    
+    /**
+     * @brief Drop everything past the write position
+     * 
+     * Never reallocates.
+     */
+    void shrinkToWpos() {
+        m_buffer.resize(m_wpos);
     }
     
     /**
@@ -154,13 +273,7 @@ public:
     void append(const byte* data, size_t size) {
         if (size == 0) return;
         
-        size_t newSize = m_wpos + size;
-        if (newSize > m_buffer.size()) {
-            m_buffer.resize(newSize);
-        }
-        
-        memcpy(&m_buffer[m_wpos], data, size);
-        m_wpos += size;
+        write(data, size);
     }
     
     /**
@@ -191,8 +304,33 @@ public:
      */
     template<typename T>
     void put(size_t pos, T value) {
-        assert(pos + sizeof(T) <= m_buffer.size());
-        memcpy(&m_buffer[pos], &value, sizeof(T));
+        writeAt(pos, (const byte*)&value, sizeof(T));
+    }
+    
+    /**
+     * @brief Overwrite already written data
+     * 
+     * Fast path for patching lengths and counts: the range must lie
+     * within the buffer, so the buffer is never grown or reallocated.
+     * 
+     * @param pos Position to write at
+     * @param src Source data
+     * @param size Number of bytes to write
+     */
+    void writeAt(size_t pos, const byte* src, size_t size) {
+        assert(pos + size <= m_buffer.size());
+        memcpy(m_buffer.data() + pos, src, size);
+    }
+    
+    /**
+     * @brief Overwrite a value in already written data
+     * 
+     * @param pos Position to write at
+     * @param value Value to write
+     */
+    template<typename T>
+    void writeAt(size_t pos, T value) {
+        writeAt(pos, (const byte*)&value, sizeof(T));
     }
     
     /**
@@ -214,12 +352,9 @@ public:
      * @param size Number of bytes to write
      */
     void write(const byte* src, size_t size) {
-        size_t newSize = m_wpos + size;
-        if (newSize > m_buffer.size()) {
-            m_buffer.resize(newSize);
-        }
+        grow(size);
         
-        memcpy(&m_buffer[m_wpos], src, size);
+        memcpy(m_buffer.data() + m_wpos, src, size);
         m_wpos += size;
     }
     
@@ -295,10 +430,54 @@ public:
         write<T>(value);
     }
 
+    /**
+     * @brief Take over existing storage
+     * 
+     * The storage is cleared but keeps its capacity, so later writes
+     * do not allocate until it is exhausted.
+     * 
+     * @param storage Storage to adopt
+     */
+    void adoptStorage(Storage&& storage) {
+        m_buffer = std::move(storage);
+        clear();
+    }
+    
+    /**
+     * @brief Give up the underlying storage
+     * 
+     * The buffer is left empty.
+     * 
+     * @return The storage previously owned by the buffer
+     */
+    Storage releaseStorage() {
+        Storage storage(std::move(m_buffer));
+        m_buffer.clear();
+        m_rpos = 0;
+        m_wpos = 0;
+        return storage;
+    }
+
 private:
+    static const size_t MIN_GROWTH = 64; ///< Smallest capacity allocated on growth
+    
+    /**
+     * @brief Extend the size to wpos + size without initialising, growing capacity geometrically
+     */
+    void grow(size_t size) {
+        size_t newSize = m_wpos + size;
+        if (newSize <= m_buffer.size())
+            return;
+        
+        if (newSize > m_buffer.capacity()) {
+            m_buffer.reserve(std::max(newSize, std::max(m_buffer.capacity() * 2, size_t(MIN_GROWTH))));
+        }
+        m_buffer.resize(newSize);
+    }
+    
     size_t m_rpos;             ///< Current read position
     size_t m_wpos;             ///< Current write position
-    std::vector<byte> m_buffer; ///< Internal buffer
+    Storage m_buffer;          ///< Internal buffer
 };
 
 #endif // _BYTE_BUFFER_H_
\ No newline at end of file
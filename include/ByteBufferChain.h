@@ -0,0 +1,223 @@
+#ifndef _BYTE_BUFFER_CHAIN_H_
+#define _BYTE_BUFFER_CHAIN_H_
+
+#include "ByteBuffer.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+/**
+ * @brief Scatter/gather list of buffers forming one datagram
+ * 
+ * ByteBufferChain lets a packet be assembled from a header, message
+ * blocks and payloads without concatenating them. Segments are either
+ * owned by the chain (typically the per-connection header) or shared
+ * immutable buffers that several chains reference at once, which is how
+ * a broadcast payload is sent to every recipient without being copied.
+ * The chain is handed to the kernel as an iovec array through sendmsg.
+ */
+class ByteBufferChain {
+public:
+    /**
+     * @brief Shared immutable buffer
+     */
+    typedef std::shared_ptr<const ByteBuffer> SharedBuffer;
+
+    /**
+     * @brief Maximum number of segments in one chain
+     */
+    static const size_t MAX_SEGMENTS = 64;
+
+    /**
+     * @brief Default constructor
+     */
+    ByteBufferChain() : m_totalLength(0) {}
+
+    /**
+     * @brief Append a buffer owned by the chain
+     * 
+     * The written part of the buffer ([0, wpos)) becomes a segment.
+     * 
+     * @param buffer Buffer to take over
+     */
+    void AppendOwned(ByteBuffer&& buffer) {
+        AddOwned(std::move(buffer), false);
+    }
+
+    /**
+     * @brief Prepend a buffer owned by the chain
+     * 
+     * Used for headers that depend on the total length of the chain.
+     * 
+     * @param buffer Buffer to take over
+     */
+    void PrependOwned(ByteBuffer&& buffer) {
+        AddOwned(std::move(buffer), true);
+    }
+
+    /**
+     * @brief Append a shared buffer
+     * 
+     * @param buffer Shared buffer to reference
+     */
+    void AppendShared(const SharedBuffer& buffer) {
+        AppendShared(buffer, 0, buffer->wpos());
+    }
+
+    /**
+     * @brief Append part of a shared buffer
+     * 
+     * @param buffer Shared buffer to reference
+     * @param offset Offset of the segment in the buffer
+     * @param length Length of the segment
+     */
+    void AppendShared(const SharedBuffer& buffer, size_t offset, size_t length) {
+        if (length == 0) return;
+
+        Segment segment;
+        segment.shared = buffer;
+        segment.ownedIndex = 0;
+        segment.offset = offset;
+        segment.length = length;
+        m_segments.push_back(segment);
+        m_totalLength += length;
+    }
+
+    /**
+     * @brief Remove all segments
+     */
+    void Clear() {
+        m_segments.clear();
+        m_owned.clear();
+        m_totalLength = 0;
+    }
+
+    /**
+     * @brief Check if the chain is empty
+     * 
+     * @return true if the chain has no segments
+     */
+    bool IsEmpty() const {
+        return m_segments.empty();
+    }
+
+    /**
+     * @brief Get the number of segments
+     * 
+     * @return Number of segments
+     */
+    size_t GetSegmentCount() const {
+        return m_segments.size();
+    }
+
+    /**
+     * @brief Get the total length of all segments
+     * 
+     * @return Total length in bytes
+     */
+    size_t GetTotalLength() const {
+        return m_totalLength;
+    }
+
+    /**
+     * @brief Get the data of a segment
+     * 
+     * @param index Segment index
+     * @param length Receives the segment length
+     * @return Pointer to the segment data
+     */
+    const byte* GetSegment(size_t index, size_t& length) const {
+        const Segment& segment = m_segments[index];
+        const ByteBuffer& buffer = segment.shared ? *segment.shared : m_owned[segment.ownedIndex];
+        length = segment.length;
+        return buffer.contents() + segment.offset;
+    }
+
+    /**
+     * @brief Copy all segments into one contiguous buffer
+     * 
+     * Needed when the whole datagram has to be transformed, for example
+     * by encryption.
+     * 
+     * @param output Buffer to append to
+     */
+    void Flatten(ByteBuffer& output) const {
+        output.reserve(output.wpos() + m_totalLength);
+        for (size_t i = 0; i < m_segments.size(); ++i) {
+            size_t length;
+            const byte* data = GetSegment(i, length);
+            output.append(data, length);
+        }
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief Fill an iovec array with the segments
+     * 
+     * @param iov Array to fill
+     * @param maxCount Size of the array
+     * @return Number of entries filled
+     */
+    size_t BuildIoVec(struct iovec* iov, size_t maxCount) const {
+        size_t count = 0;
+        for (; count < m_segments.size() && count < maxCount; ++count) {
+            size_t length;
+            const byte* data = GetSegment(count, length);
+            iov[count].iov_base = const_cast<byte*>(data);
+            iov[count].iov_len = length;
+        }
+        return count;
+    }
+#endif
+
+    /**
+     * @brief Send the chain as a single datagram
+     * 
+     * @param fd Socket descriptor
+     * @param addr Destination address
+     * @param addrLen Destination address length
+     * @return Number of bytes sent, or -1 on error
+     */
+    int SendTo(int fd, const struct sockaddr* addr, socklen_t addrLen) const;
+
+private:
+    /**
+     * @brief Chain segment
+     */
+    struct Segment {
+        SharedBuffer shared;    ///< Shared buffer, or null for an owned segment
+        size_t ownedIndex;      ///< Index into m_owned for owned segments
+        size_t offset;          ///< Offset of the segment in its buffer
+        size_t length;          ///< Length of the segment
+    };
+
+    void AddOwned(ByteBuffer&& buffer, bool prepend) {
+        size_t length = buffer.wpos();
+        if (length == 0) return;
+
+        Segment segment;
+        segment.ownedIndex = m_owned.size();
+        segment.offset = 0;
+        segment.length = length;
+        m_owned.push_back(std::move(buffer));
+        if (prepend)
+            m_segments.insert(m_segments.begin(), segment);
+        else
+            m_segments.push_back(segment);
+        m_totalLength += length;
+    }
+
+    std::vector<Segment> m_segments;    ///< Segments in send order
+    std::vector<ByteBuffer> m_owned;    ///< Buffers owned by the chain
+    size_t m_totalLength;               ///< Sum of all segment lengths
+};
+
+#endif // _BYTE_BUFFER_CHAIN_H_
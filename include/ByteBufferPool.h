@@ -0,0 +1,288 @@
+#ifndef _BYTE_BUFFER_POOL_H_
+#define _BYTE_BUFFER_POOL_H_
+
+#include "ByteBuffer.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Thread-local pool of pre-sized ByteBuffer storage
+ * 
+ * Short-lived packet buffers on the send path are taken from and returned
+ * to a per-thread pool instead of going through the heap every time.
+ * Storage is kept in a few size classes; a request is served from the
+ * smallest class that fits it. Since every pool is only touched by its
+ * owning thread, acquire and release never take a lock.
+ */
+class ByteBufferPool {
+public:
+    /**
+     * @brief Size classes
+     */
+    enum SizeClass {
+        SIZE_CLASS_SMALL = 0,    ///< Headers and acks
+        SIZE_CLASS_MEDIUM = 1,   ///< Chat and small updates
+        SIZE_CLASS_MTU = 2,      ///< One full datagram
+        SIZE_CLASS_LARGE = 3,    ///< World state and lists
+        SIZE_CLASS_COUNT = 4
+    };
+
+    /**
+     * @brief Pool statistics
+     */
+    struct Stats {
+        uint64_t hits;           ///< Acquires served from the pool
+        uint64_t misses;         ///< Acquires that had to allocate
+        uint64_t released;       ///< Buffers returned to the pool
+        uint64_t discarded;      ///< Buffers freed instead of pooled
+    };
+
+    /**
+     * @brief Constructor
+     */
+    ByteBufferPool() {
+        for (int i = 0; i < SIZE_CLASS_COUNT; ++i) {
+            m_free[i].reserve(GetClassLimit(i));
+        }
+        m_hits = 0;
+        m_misses = 0;
+        m_released = 0;
+        m_discarded = 0;
+
+        std::lock_guard<std::mutex> lock(GetRegistryMutex());
+        GetRegistry().push_back(this);
+    }
+
+    /**
+     * @brief Destructor
+     * 
+     * Counters of the pool are folded into the retired totals so they
+     * are still reported after the owning thread exits.
+     */
+    ~ByteBufferPool() {
+        std::lock_guard<std::mutex> lock(GetRegistryMutex());
+        std::vector<ByteBufferPool*>& registry = GetRegistry();
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+
+        Stats& retired = GetRetiredStats();
+        retired.hits += m_hits.load(std::memory_order_relaxed);
+        retired.misses += m_misses.load(std::memory_order_relaxed);
+        retired.released += m_released.load(std::memory_order_relaxed);
+        retired.discarded += m_discarded.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the pool of the calling thread
+     * 
+     * @return Reference to the thread's pool
+     */
+    static ByteBufferPool& GetThreadPool() {
+        static thread_local ByteBufferPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Acquire an empty buffer
+     * 
+     * @param sizeHint Number of bytes the caller expects to write
+     * @return Empty buffer with at least sizeHint bytes of capacity
+     */
+    ByteBuffer Acquire(size_t sizeHint) {
+        ByteBuffer buffer;
+        int sizeClass = GetSizeClass(sizeHint);
+        if (sizeClass < 0) {
+            // Larger than any class, not worth pooling
+            ByteBuffer::Storage storage;
+            storage.reserve(sizeHint);
+            buffer.adoptStorage(std::move(storage));
+            Increment(m_misses);
+            return buffer;
+        }
+
+        std::vector<ByteBuffer::Storage>& freeList = m_free[sizeClass];
+        if (!freeList.empty()) {
+            buffer.adoptStorage(std::move(freeList.back()));
+            freeList.pop_back();
+            Increment(m_hits);
+        } else {
+            ByteBuffer::Storage storage;
+            storage.reserve(GetClassSize(sizeClass));
+            buffer.adoptStorage(std::move(storage));
+            Increment(m_misses);
+        }
+        return buffer;
+    }
+
+    /**
+     * @brief Return a buffer's storage to the pool
+     * 
+     * The buffer is left empty and may be reused or destroyed.
+     * 
+     * @param buffer Buffer to release
+     */
+    void Release(ByteBuffer& buffer) {
+        ByteBuffer::Storage storage = buffer.releaseStorage();
+
+        // File the storage under the largest class it can fully serve
+        int sizeClass = -1;
+        for (int i = SIZE_CLASS_COUNT - 1; i >= 0; --i) {
+            if (storage.capacity() >= GetClassSize(i)) {
+                sizeClass = i;
+                break;
+            }
+        }
+
+        if (sizeClass < 0 || storage.capacity() > GetClassSize(SIZE_CLASS_LARGE) * 2 ||
+            m_free[sizeClass].size() >= GetClassLimit(sizeClass)) {
+            Increment(m_discarded);
+            return;
+        }
+
+        storage.clear();
+        m_free[sizeClass].push_back(std::move(storage));
+        Increment(m_released);
+    }
+
+    /**
+     * @brief Get the statistics of this pool
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const {
+        stats.hits = m_hits.load(std::memory_order_relaxed);
+        stats.misses = m_misses.load(std::memory_order_relaxed);
+        stats.released = m_released.load(std::memory_order_relaxed);
+        stats.discarded = m_discarded.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the statistics summed over all threads
+     * 
+     * @param stats Structure to fill
+     */
+    static void GetGlobalStats(Stats& stats) {
+        std::lock_guard<std::mutex> lock(GetRegistryMutex());
+        stats = GetRetiredStats();
+
+        const std::vector<ByteBufferPool*>& registry = GetRegistry();
+        for (size_t i = 0; i < registry.size(); ++i) {
+            Stats poolStats;
+            registry[i]->GetStats(poolStats);
+            stats.hits += poolStats.hits;
+            stats.misses += poolStats.misses;
+            stats.released += poolStats.released;
+            stats.discarded += poolStats.discarded;
+        }
+    }
+
+    /**
+     * @brief Get the capacity of a size class
+     * 
+     * @param sizeClass Size class
+     * @return Capacity in bytes
+     */
+    static size_t GetClassSize(int sizeClass) {
+        static const size_t sizes[SIZE_CLASS_COUNT] = { 64, 256, 1500, 8192 };
+        return sizes[sizeClass];
+    }
+
+    /**
+     * @brief Get the smallest size class that can hold a request
+     * 
+     * @param size Requested size in bytes
+     * @return Size class, or -1 if the request is larger than every class
+     */
+    static int GetSizeClass(size_t size) {
+        for (int i = 0; i < SIZE_CLASS_COUNT; ++i) {
+            if (size <= GetClassSize(i))
+                return i;
+        }
+        return -1;
+    }
+
+private:
+    ByteBufferPool(const ByteBufferPool&) = delete;
+    ByteBufferPool& operator=(const ByteBufferPool&) = delete;
+
+    /**
+     * @brief Get the maximum number of free buffers kept per class
+     */
+    static size_t GetClassLimit(int sizeClass) {
+        static const size_t limits[SIZE_CLASS_COUNT] = { 512, 256, 256, 32 };
+        return limits[sizeClass];
+    }
+
+    /**
+     * @brief Bump a counter that only the owning thread writes
+     */
+    static void Increment(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static std::vector<ByteBufferPool*>& GetRegistry() {
+        static std::vector<ByteBufferPool*> registry;
+        return registry;
+    }
+
+    static std::mutex& GetRegistryMutex() {
+        static std::mutex registryMutex;
+        return registryMutex;
+    }
+
+    static Stats& GetRetiredStats() {
+        static Stats retired = { 0, 0, 0, 0 };
+        return retired;
+    }
+
+    std::vector<ByteBuffer::Storage> m_free[SIZE_CLASS_COUNT]; ///< Free storage per size class
+    std::atomic<uint64_t> m_hits;       ///< Acquires served from the pool
+    std::atomic<uint64_t> m_misses;     ///< Acquires that had to allocate
+    std::atomic<uint64_t> m_released;   ///< Buffers returned to the pool
+    std::atomic<uint64_t> m_discarded;  ///< Buffers freed instead of pooled
+};
+
+/**
+ * @brief Scoped ByteBuffer taken from the calling thread's pool
+ * 
+ * The storage is returned to the pool when the PooledBuffer goes out of
+ * scope, so it must be destroyed on the thread that created it.
+ */
+class PooledBuffer {
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param sizeHint Number of bytes the caller expects to write
+     */
+    explicit PooledBuffer(size_t sizeHint)
+        : m_buffer(ByteBufferPool::GetThreadPool().Acquire(sizeHint)) {}
+
+    /**
+     * @brief Move constructor
+     */
+    PooledBuffer(PooledBuffer&& other) : m_buffer(std::move(other.m_buffer)) {}
+
+    /**
+     * @brief Destructor
+     */
+    ~PooledBuffer() {
+        if (m_buffer.capacity() > 0)
+            ByteBufferPool::GetThreadPool().Release(m_buffer);
+    }
+
+    ByteBuffer& operator*() { return m_buffer; }
+    const ByteBuffer& operator*() const { return m_buffer; }
+    ByteBuffer* operator->() { return &m_buffer; }
+    const ByteBuffer* operator->() const { return &m_buffer; }
+
+private:
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    ByteBuffer m_buffer; ///< Pooled buffer
+};
+
+#endif // _BYTE_BUFFER_POOL_H_
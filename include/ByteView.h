@@ -0,0 +1,191 @@
+#ifndef _BYTE_VIEW_H_
+#define _BYTE_VIEW_H_
+
+#include "ByteBuffer.h"
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
+/**
+ * @brief Non-owning read-only view over binary data
+ *
+ * ByteView exposes the same read API as ByteBuffer (read<T>, readString,
+ * rpos, remaining) on top of memory it does not own. It is used on the
+ * decode path so that message blocks can be handed from the received
+ * datagram to the message handlers without being copied. The viewed
+ * memory must outlive the view.
+ */
+class ByteView {
+public:
+    /**
+     * @brief Default constructor (empty view)
+     */
+    ByteView() : m_data(nullptr), m_size(0), m_rpos(0) {}
+
+    /**
+     * @brief Constructor over raw data
+     *
+     * @param data Pointer to the data
+     * @param size Size of the data
+     */
+    ByteView(const byte* data, size_t size) : m_data(data), m_size(size), m_rpos(0) {}
+
+    /**
+     * @brief Constructor over the written part of a ByteBuffer
+     *
+     * The view starts at the buffer's current read position.
+     *
+     * @param buffer The buffer to view
+     */
+    explicit ByteView(const ByteBuffer& buffer)
+        : m_data(buffer.contents()), m_size(buffer.wpos()), m_rpos(buffer.rpos()) {}
+
+    /**
+     * @brief Get pointer to the viewed data
+     *
+     * @return Pointer to the viewed data
+     */
+    const byte* contents() const {
+        return m_data;
+    }
+
+    /**
+     * @brief Get the size of the view
+     *
+     * @return Size of the view in bytes
+     */
+    size_t size() const {
+        return m_size;
+    }
+
+    /**
+     * @brief Get the current read position
+     *
+     * @return Current read position
+     */
+    size_t rpos() const {
+        return m_rpos;
+    }
+
+    /**
+     * @brief Set the read position
+     *
+     * @param pos New read position
+     */
+    void rpos(size_t pos) {
+        assert(pos <= m_size);
+        m_rpos = pos;
+    }
+
+    /**
+     * @brief Get the number of unread bytes
+     *
+     * @return Number of unread bytes
+     */
+    size_t remaining() const {
+        return m_size > m_rpos ? m_size - m_rpos : 0;
+    }
+
+    /**
+     * @brief Skip bytes without reading them
+     *
+     * @param size Number of bytes to skip
+     */
+    void skip(size_t size) {
+        assert(m_rpos + size <= m_size);
+        m_rpos += size;
+    }
+
+    /**
+     * @brief Create a sub-view of this view
+     *
+     * @param offset Offset of the sub-view from the start of this view
+     * @param size Size of the sub-view
+     * @return View over the requested range
+     */
+    ByteView slice(size_t offset, size_t size) const {
+        assert(offset + size <= m_size);
+        return ByteView(m_data + offset, size);
+    }
+
+    /**
+     * @brief Consume bytes from the read position as a sub-view
+     *
+     * @param size Number of bytes to consume
+     * @return View over the consumed bytes
+     */
+    ByteView readSlice(size_t size) {
+        ByteView result = slice(m_rpos, size);
+        m_rpos += size;
+        return result;
+    }
+
+    /**
+     * @brief Read data from the view
+     *
+     * @param dest Destination buffer
+     * @param size Number of bytes to read
+     */
+    void read(byte* dest, size_t size) {
+        assert(m_rpos + size <= m_size);
+        memcpy(dest, m_data + m_rpos, size);
+        m_rpos += size;
+    }
+
+    /**
+     * @brief Read a string from the view
+     *
+     * @param str String to store the result
+     */
+    void readString(std::string& str) {
+        str.clear();
+        while (m_rpos < m_size) {
+            char c = read<char>();
+            if (c == 0)
+                break;
+            str.push_back(c);
+        }
+    }
+
+    /**
+     * @brief Read a value from the view
+     *
+     * @return The read value
+     */
+    template<typename T>
+    T read() {
+        T r;
+        read((byte*)&r, sizeof(T));
+        return r;
+    }
+
+    /**
+     * @brief Extract a value from the view
+     *
+     * @param value Reference to store the extracted value
+     */
+    template<typename T>
+    void operator>>(T& value) {
+        value = read<T>();
+    }
+
+    /**
+     * @brief Copy the unread part of the view into an owning buffer
+     *
+     * Only needed when a handler has to keep the data beyond the
+     * lifetime of the received datagram.
+     *
+     * @return ByteBuffer holding the unread bytes
+     */
+    ByteBuffer toBuffer() const {
+        return ByteBuffer(m_data + m_rpos, remaining());
+    }
+
+private:
+    const byte* m_data; ///< Viewed data (not owned)
+    size_t m_size;      ///< Size of the viewed data
+    size_t m_rpos;      ///< Current read position
+};
+
+#endif // _BYTE_VIEW_H_
@@ -0,0 +1,255 @@
+#ifndef _CONCURRENT_SLOT_TABLE_H_
+#define _CONCURRENT_SLOT_TABLE_H_
+
+#include "SlotHandleAllocator.h"
+#include "EpochManager.h"
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Table of values keyed by generational handles, with lock-free reads
+ * 
+ * Values are stored by the handle's slot index (see
+ * SlotHandleAllocator), and a stale handle finds nothing. Every slot
+ * holds an atomic pointer to an immutable record (handle and value).
+ * Readers load it inside an EpochGuard and copy the value out, so Get,
+ * Contains and ForEach never take a lock and never wait for a writer.
+ * Writers are serialized by an internal mutex and never wait for
+ * readers: Insert publishes a new record, Erase unlinks it and retires
+ * it to the EpochManager, which deletes it once no reader can hold it.
+ * 
+ * Slots live in chunks of CHUNK_SIZE that are allocated on first use
+ * and kept until the table is destroyed, so a reader never sees a chunk
+ * go away.
+ * 
+ * @tparam T Value type, default constructible and copyable (e.g. a shared_ptr)
+ */
+template<typename T>
+class ConcurrentSlotTable {
+public:
+    /**
+     * @brief log2 of the slots per chunk
+     */
+    static const uint32_t CHUNK_BITS = 12;
+
+    /**
+     * @brief Slots per chunk
+     */
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    /**
+     * @brief Chunks needed to cover every slot index
+     */
+    static const uint32_t MAX_CHUNKS = SlotHandleAllocator::MAX_SLOTS >> CHUNK_BITS;
+
+    ConcurrentSlotTable() : m_size(0), m_chunkCount(0) {
+        for (uint32_t i = 0; i < MAX_CHUNKS; ++i) {
+            m_chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Destructor
+     * 
+     * No reader may still be using the table.
+     */
+    ~ConcurrentSlotTable() {
+        for (uint32_t i = 0; i < MAX_CHUNKS; ++i) {
+            Chunk* chunk = m_chunks[i].load(std::memory_order_relaxed);
+            if (chunk) {
+                for (uint32_t j = 0; j < CHUNK_SIZE; ++j) {
+                    delete chunk->records[j].load(std::memory_order_relaxed);
+                }
+                delete chunk;
+            }
+        }
+    }
+
+    /**
+     * @brief Insert a value
+     * 
+     * @param handle Handle to store it under
+     * @param value Value
+     * @return true if inserted, false if handle is 0 or its slot is taken
+     */
+    bool Insert(uint32_t handle, const T& value) {
+        if (!handle) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        uint32_t index = SlotHandleAllocator::GetIndex(handle);
+        Chunk* chunk = m_chunks[index >> CHUNK_BITS].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new Chunk();
+            m_chunks[index >> CHUNK_BITS].store(chunk, std::memory_order_release);
+            if ((index >> CHUNK_BITS) >= m_chunkCount.load(std::memory_order_relaxed)) {
+                m_chunkCount.store((index >> CHUNK_BITS) + 1, std::memory_order_release);
+            }
+        }
+
+        std::atomic<const Record*>& slot = chunk->records[index & (CHUNK_SIZE - 1)];
+        if (slot.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        slot.store(new Record(handle, value), std::memory_order_release);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Remove a value
+     * 
+     * Readers that already copied the value keep their copy.
+     * 
+     * @param handle Handle
+     * @return true if removed, false if not present (or handle is stale)
+     */
+    bool Erase(uint32_t handle) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        std::atomic<const Record*>* slot = FindSlot(handle);
+        const Record* record = slot ? slot->load(std::memory_order_relaxed) : nullptr;
+        if (!record || record->handle != handle) {
+            return false;
+        }
+
+        slot->store(nullptr, std::memory_order_release);
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        sEpochManager.Retire(record);
+        return true;
+    }
+
+    /**
+     * @brief Remove every value
+     */
+    void Clear() {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        uint32_t chunkCount = m_chunkCount.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            Chunk* chunk = m_chunks[i].load(std::memory_order_relaxed);
+            for (uint32_t j = 0; chunk && j < CHUNK_SIZE; ++j) {
+                const Record* record = chunk->records[j].exchange(nullptr, std::memory_order_acq_rel);
+                if (record) {
+                    m_size.fetch_sub(1, std::memory_order_relaxed);
+                    sEpochManager.Retire(record);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Get a value
+     * 
+     * Lock-free and wait-free.
+     * 
+     * @param handle Handle
+     * @return Copy of the value, or T() if not present (or handle is stale)
+     */
+    T Get(uint32_t handle) const {
+        EpochGuard guard;
+        const Record* record = Load(handle);
+        return record ? record->value : T();
+    }
+
+    /**
+     * @brief Check if a value is present
+     * 
+     * @param handle Handle
+     * @return true if present
+     */
+    bool Contains(uint32_t handle) const {
+        EpochGuard guard;
+        return Load(handle) != nullptr;
+    }
+
+    /**
+     * @brief Get the number of values
+     * 
+     * @return Number of values
+     */
+    size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Visit every value
+     * 
+     * Lock-free; sees each value present for the whole visit, and may or
+     * may not see values inserted or erased meanwhile. Visits slots in
+     * index order, so the cost is the highest slot index used rather
+     * than the number of values.
+     * 
+     * @param visit Called as visit(handle, value); may insert or erase
+     */
+    template<typename Visitor>
+    void ForEach(Visitor visit) const {
+        EpochGuard guard;
+
+        uint32_t chunkCount = m_chunkCount.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            const Chunk* chunk = m_chunks[i].load(std::memory_order_acquire);
+            for (uint32_t j = 0; chunk && j < CHUNK_SIZE; ++j) {
+                const Record* record = chunk->records[j].load(std::memory_order_acquire);
+                if (record) {
+                    visit(record->handle, record->value);
+                }
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Published value, immutable once stored
+     */
+    struct Record {
+        uint32_t handle;  ///< Handle stored here
+        T value;          ///< Value
+
+        Record(uint32_t handle, const T& value) : handle(handle), value(value) {}
+    };
+
+    /**
+     * @brief Slots of one chunk
+     */
+    struct Chunk {
+        std::atomic<const Record*> records[CHUNK_SIZE];
+
+        Chunk() {
+            for (uint32_t i = 0; i < CHUNK_SIZE; ++i) {
+                records[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    ConcurrentSlotTable(const ConcurrentSlotTable&) = delete;
+    ConcurrentSlotTable& operator=(const ConcurrentSlotTable&) = delete;
+
+    /**
+     * @brief Get the slot of a handle, or nullptr if its chunk does not exist
+     */
+    std::atomic<const Record*>* FindSlot(uint32_t handle) const {
+        uint32_t index = SlotHandleAllocator::GetIndex(handle);
+        Chunk* chunk = m_chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+        return handle && chunk ? &chunk->records[index & (CHUNK_SIZE - 1)] : nullptr;
+    }
+
+    /**
+     * @brief Load the record of a handle; the caller holds an EpochGuard
+     */
+    const Record* Load(uint32_t handle) const {
+        std::atomic<const Record*>* slot = FindSlot(handle);
+        const Record* record = slot ? slot->load(std::memory_order_acquire) : nullptr;
+        return record && record->handle == handle ? record : nullptr;
+    }
+
+    std::atomic<Chunk*> m_chunks[MAX_CHUNKS];  ///< Chunks by index >> CHUNK_BITS
+    std::atomic<size_t> m_size;                ///< Number of values
+    std::atomic<uint32_t> m_chunkCount;        ///< One past the highest allocated chunk
+    std::mutex m_writeMutex;                   ///< Serializes writers
+};
+
+#endif // _CONCURRENT_SLOT_TABLE_H_
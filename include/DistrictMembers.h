@@ -0,0 +1,131 @@
+#ifndef _DISTRICT_MEMBERS_H_
+#define _DISTRICT_MEMBERS_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class GameObject;
+
+/**
+ * @brief Dense set of the objects in one district
+ * 
+ * Members are kept in one array and every object stores its own index
+ * in it (GameObject::GetDistrictIndex), so removal moves the last member
+ * into the hole and fixes that member's index: O(1) instead of a search
+ * and an erase that shifts the tail.
+ * 
+ * Iteration is stable: while a ForEach (or a BeginIteration /
+ * EndIteration pair) is in progress, removed members are only marked and
+ * the array is compacted when the outermost iteration ends, so visitors
+ * may remove any member, including the one being visited. Members added
+ * during an iteration are not visited by it.
+ * 
+ * Not thread-safe; WorldManager guards it with its object lock.
+ */
+class DistrictMembers {
+public:
+    /**
+     * @brief Back-index of an object that is in no district set
+     */
+    static const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+    /**
+     * @brief Member entry
+     */
+    struct Member {
+        uint32_t objectId;    ///< Object ID, 0 once removed during an iteration
+        GameObject* object;   ///< Object, nullptr once removed during an iteration
+    };
+
+    DistrictMembers();
+
+    /**
+     * @brief Add an object
+     * 
+     * @param object Object, not in any district set
+     * @return true if added, false if the object is already in a set
+     */
+    bool Add(GameObject& object);
+
+    /**
+     * @brief Remove an object
+     * 
+     * @param object Object in this set
+     * @return true if removed, false if the object is not in this set
+     */
+    bool Remove(GameObject& object);
+
+    /**
+     * @brief Check if an object is in this set
+     * 
+     * @param object Object
+     * @return true if present
+     */
+    bool Contains(const GameObject& object) const;
+
+    /**
+     * @brief Get the number of members
+     * 
+     * @return Number of members, excluding those removed during an iteration
+     */
+    size_t Size() const { return m_members.size() - m_removed.size(); }
+
+    /**
+     * @brief Start an iteration
+     * 
+     * Removals are deferred until the matching EndIteration. Iterations
+     * may nest.
+     */
+    void BeginIteration() { ++m_iterating; }
+
+    /**
+     * @brief End an iteration
+     * 
+     * The outermost one compacts the members removed meanwhile.
+     */
+    void EndIteration();
+
+    /**
+     * @brief Get the member array
+     * 
+     * Entries with a null object were removed during the current
+     * iteration and must be skipped.
+     * 
+     * @return Members
+     */
+    const std::vector<Member>& GetMembers() const { return m_members; }
+
+    /**
+     * @brief Visit every member
+     * 
+     * @param visit Called as visit(GameObject&); may add or remove members
+     */
+    template<typename Visitor>
+    void ForEach(Visitor visit) {
+        BeginIteration();
+        for (size_t i = 0, count = m_members.size(); i < count; ++i) {
+            if (m_members[i].object) {
+                visit(*m_members[i].object);
+            }
+        }
+        EndIteration();
+    }
+
+    /**
+     * @brief Remove every member
+     */
+    void Clear();
+
+private:
+    /**
+     * @brief Swap-and-pop the member at an index
+     */
+    void Erase(uint32_t index);
+
+    std::vector<Member> m_members;    ///< Members
+    std::vector<uint32_t> m_removed;  ///< Indices removed during the current iteration
+    uint32_t m_iterating;             ///< Iteration nesting depth
+};
+
+#endif // _DISTRICT_MEMBERS_H_
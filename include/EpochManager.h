@@ -0,0 +1,216 @@
+#ifndef _EPOCH_MANAGER_H_
+#define _EPOCH_MANAGER_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <type_traits>
+#include <cstdint>
+
+/**
+ * @brief Epoch-based memory reclamation
+ * 
+ * Lets readers on any thread use shared data without locks while a
+ * writer replaces it. A reader holds an EpochGuard while it touches the
+ * data; a writer unlinks old data, hands it to Retire, and the data is
+ * deleted once every reader that could still see it has left its guard.
+ * 
+ * Each reader thread claims a record holding the global epoch it
+ * entered in (0 when outside a guard). Collect advances the global
+ * epoch once every active reader has entered the current one, and
+ * deletes what was retired two epochs back: no guard still open can
+ * have been entered before it was unlinked. Entering and leaving a
+ * guard is a handful of atomic operations and never waits; threads
+ * beyond MAX_READERS share a counter that holds the epoch back while
+ * any of them is inside a guard.
+ */
+class EpochManager {
+public:
+    /**
+     * @brief Reader threads with their own record
+     */
+    static const uint32_t MAX_READERS = 64;
+
+    /**
+     * @brief Get the manager
+     * 
+     * Never destroyed, so thread exit and static destruction can still
+     * leave guards and retire data.
+     * 
+     * @return The manager
+     */
+    static EpochManager& getSingleton();
+
+    /**
+     * @brief Enter a read-side critical section (see EpochGuard)
+     */
+    void Enter();
+
+    /**
+     * @brief Leave a read-side critical section (see EpochGuard)
+     */
+    void Leave();
+
+    /**
+     * @brief Delete data once no reader can see it
+     * 
+     * The data must already be unreachable for new readers.
+     * 
+     * @param pointer Data to delete
+     * @param deleter Called with pointer to delete it
+     */
+    void Retire(void* pointer, void (*deleter)(void*));
+
+    /**
+     * @brief Delete an object once no reader can see it
+     * 
+     * @param object Object to delete
+     */
+    template<typename T>
+    void Retire(T* object) {
+        Retire(static_cast<void*>(const_cast<typename std::remove_const<T>::type*>(object)), &Delete<typename std::remove_const<T>::type>);
+    }
+
+    /**
+     * @brief Try to advance the epoch and delete what is safe to delete
+     * 
+     * Called by writers after retiring data and once per world update.
+     * 
+     * @return Number of retired items deleted
+     */
+    size_t Collect();
+
+    /**
+     * @brief Get the number of retired items not deleted yet
+     * 
+     * @return Number of items
+     */
+    size_t GetPendingCount() const;
+
+private:
+    /**
+     * @brief Per-thread reader record
+     * 
+     * Padded to two cache lines so no two records share one, whatever
+     * the array's alignment.
+     */
+    struct ReaderRecord {
+        std::atomic<uint64_t> epoch;      ///< Epoch entered in, 0 outside a guard
+        std::atomic<bool> claimed;        ///< Owned by a thread
+        char padding[128 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+
+    /**
+     * @brief Retired data
+     */
+    struct Retired {
+        void* pointer;                    ///< Data
+        void (*deleter)(void*);           ///< Deletes the data
+        uint64_t epoch;                   ///< Epoch it was retired in
+    };
+
+    /**
+     * @brief Thread state of the calling thread
+     */
+    struct ThreadState {
+        ReaderRecord* record;             ///< Claimed record, nullptr if none was free
+        uint32_t depth;                   ///< Guard nesting depth
+        bool registered;                  ///< A record was looked for
+
+        ThreadState() : record(nullptr), depth(0), registered(false) {}
+        ~ThreadState();
+    };
+
+    template<typename T>
+    static void Delete(void* pointer) { delete static_cast<T*>(pointer); }
+
+    EpochManager();
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    /**
+     * @brief Get the calling thread's state, claiming a record on first use
+     */
+    ThreadState& GetThreadState();
+
+    /**
+     * @brief Advance the epoch if every reader inside a guard entered the current one
+     * 
+     * Called with m_retiredMutex held.
+     * 
+     * @return true if advanced
+     */
+    bool TryAdvance();
+
+    ReaderRecord m_readers[MAX_READERS];      ///< Reader records
+    std::atomic<uint64_t> m_epoch;            ///< Global epoch, starts at 1
+    std::atomic<uint32_t> m_overflowReaders;  ///< Readers inside a guard without a record
+    std::vector<Retired> m_retired;           ///< Retired data, oldest first
+    mutable std::mutex m_retiredMutex;        ///< Guards m_retired and epoch advances
+};
+
+#define sEpochManager EpochManager::getSingleton()
+
+/**
+ * @brief Read-side critical section
+ * 
+ * Data published through RcuSnapshot or ConcurrentSlotTable and read
+ * while the guard is held stays valid until it is destroyed. Guards
+ * nest.
+ */
+class EpochGuard {
+public:
+    EpochGuard() { sEpochManager.Enter(); }
+    ~EpochGuard() { sEpochManager.Leave(); }
+
+private:
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+/**
+ * @brief Read-copy-update snapshot of a value
+ * 
+ * Readers get the current version with Read() inside an EpochGuard;
+ * the writer builds a new version and Publish()es it, and the old one
+ * is deleted through the EpochManager once no reader holds it. Readers
+ * never wait and always see a complete version.
+ * 
+ * @tparam T Value type
+ */
+template<typename T>
+class RcuSnapshot {
+public:
+    RcuSnapshot() : m_current(nullptr) {}
+
+    ~RcuSnapshot() { delete m_current.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the current version
+     * 
+     * @return Current version, or nullptr if nothing was published; valid while the caller's EpochGuard is held
+     */
+    const T* Read() const { return m_current.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Publish a new version
+     * 
+     * Writers must be serialized by the caller.
+     * 
+     * @param next New version, owned by the snapshot from now on
+     */
+    void Publish(const T* next) {
+        const T* previous = m_current.exchange(next, std::memory_order_acq_rel);
+        if (previous) {
+            sEpochManager.Retire(previous);
+        }
+    }
+
+private:
+    RcuSnapshot(const RcuSnapshot&) = delete;
+    RcuSnapshot& operator=(const RcuSnapshot&) = delete;
+
+    std::atomic<const T*> m_current;  ///< Current version
+};
+
+#endif // _EPOCH_MANAGER_H_
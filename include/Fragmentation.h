@@ -0,0 +1,187 @@
+#ifndef _FRAGMENTATION_H_
+#define _FRAGMENTATION_H_
+
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include "ByteView.h"
+#include <map>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief Fragment header, follows the game header when PACKET_FLAG_FRAGMENT is set
+ * 
+ * Every fragment but the last carries ceil(totalLength / fragmentCount)
+ * bytes, so the receiver knows where each one goes before it has seen
+ * the others.
+ */
+struct FragmentHeader {
+    uint16_t messageId;       ///< Fragmented message ID (per connection, wraps)
+    uint16_t fragmentIndex;   ///< Index of this fragment
+    uint16_t fragmentCount;   ///< Number of fragments
+    uint32_t totalLength;     ///< Length of the reassembled message
+
+    /**
+     * @brief Size of the header on the wire
+     */
+    static const size_t SIZE = 10;
+
+    /**
+     * @brief Length of every fragment but the last
+     * 
+     * @return Fragment payload length
+     */
+    uint32_t GetStride() const {
+        return (totalLength + fragmentCount - 1) / fragmentCount;
+    }
+};
+
+/**
+ * @brief Splits a message into fragments
+ * 
+ * The fragments reference slices of the shared message instead of
+ * copying it; only the small fragment headers are allocated.
+ */
+class FragmentSplitter {
+public:
+    /**
+     * @brief Fragment callback
+     * 
+     * Called with each fragment (fragment header followed by the payload
+     * slice). The chain may be moved from.
+     */
+    typedef std::function<void(ByteBufferChain&)> FragmentCallback;
+
+    /**
+     * @brief Largest number of fragments per message
+     */
+    static const uint16_t MAX_FRAGMENTS = 1024;
+
+    /**
+     * @brief Split a message
+     * 
+     * @param message Message to split
+     * @param maxPayload Largest fragment payload (MTU minus all headers)
+     * @param messageId Message ID shared by the fragments
+     * @param emit Called for every fragment, in order
+     * @return Number of fragments, or 0 if the message needs more than MAX_FRAGMENTS
+     */
+    static size_t Split(const ByteBufferChain::SharedBuffer& message, size_t maxPayload, uint16_t messageId, const FragmentCallback& emit);
+};
+
+/**
+ * @brief Reassembles fragmented messages for one connection
+ * 
+ * Each message in progress is written straight into one ByteBuffer of
+ * its final size, so the fragments are copied exactly once and the
+ * complete message is handed out without another copy. The number of
+ * messages in progress, the bytes they reserve and the time they may
+ * wait for missing fragments are all bounded.
+ */
+class FragmentAssembler {
+public:
+    /**
+     * @brief Result of adding a fragment
+     */
+    enum Result {
+        FRAGMENT_PENDING,     ///< Fragment stored, message incomplete
+        FRAGMENT_COMPLETE,    ///< Message complete and returned
+        FRAGMENT_DUPLICATE,   ///< Fragment already received
+        FRAGMENT_REJECTED     ///< Malformed or over the memory limits
+    };
+
+    /**
+     * @brief Reassembly statistics
+     */
+    struct Stats {
+        uint64_t completed;   ///< Messages reassembled
+        uint64_t expired;     ///< Messages dropped on timeout
+        uint64_t rejected;    ///< Fragments rejected
+    };
+
+    /**
+     * @brief Constructor
+     * 
+     * @param maxMessages Messages in progress at once
+     * @param maxBytes Bytes all messages in progress may reserve
+     * @param timeout Time a message may wait for missing fragments in milliseconds
+     */
+    FragmentAssembler(size_t maxMessages = 8, size_t maxBytes = 1024 * 1024, uint32_t timeout = 5000);
+
+    /**
+     * @brief Add a received fragment
+     * 
+     * @param data Packet data positioned at the fragment header; consumed
+     * @param now Current time in milliseconds
+     * @param message Receives the reassembled message on FRAGMENT_COMPLETE
+     * @return Result
+     */
+    Result AddFragment(ByteView& data, uint32_t now, ByteBuffer& message);
+
+    /**
+     * @brief Drop messages that waited longer than the timeout
+     * 
+     * @param now Current time in milliseconds
+     * @return Number of messages dropped
+     */
+    size_t Expire(uint32_t now);
+
+    /**
+     * @brief Drop all messages in progress
+     */
+    void Clear();
+
+    /**
+     * @brief Get the bytes reserved by messages in progress
+     * 
+     * @return Reserved bytes
+     */
+    size_t GetReservedBytes() const { return m_reservedBytes; }
+
+    /**
+     * @brief Get reassembly statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const { stats = m_stats; }
+
+private:
+    /**
+     * @brief Message in progress
+     */
+    struct Pending {
+        ByteBuffer buffer;              ///< Message, written at each fragment's offset
+        std::vector<uint8_t> received;  ///< Received flag per fragment
+        uint16_t fragmentCount;         ///< Number of fragments
+        uint16_t receivedCount;         ///< Fragments received so far
+        uint32_t totalLength;           ///< Message length
+        uint32_t firstSeen;             ///< Time of the first fragment
+    };
+
+    /**
+     * @brief Release a message in progress
+     */
+    void Release(std::map<uint16_t, Pending>::iterator itr);
+
+    /**
+     * @brief Check if a message ID was completed recently
+     */
+    bool IsRecentlyCompleted(uint16_t messageId) const;
+
+    /**
+     * @brief Completed message IDs remembered to drop late duplicates
+     */
+    static const size_t RECENT_COMPLETED = 16;
+
+    std::map<uint16_t, Pending> m_pending;  ///< Messages in progress by message ID
+    size_t m_maxMessages;                   ///< Messages in progress at once
+    size_t m_maxBytes;                      ///< Reservation limit
+    size_t m_reservedBytes;                 ///< Bytes reserved
+    uint32_t m_timeout;                     ///< Reassembly timeout
+    uint32_t m_recent[RECENT_COMPLETED];    ///< Recently completed message IDs (ring)
+    size_t m_recentNext;                    ///< Next slot in m_recent
+    Stats m_stats;                          ///< Statistics
+};
+
+#endif // _FRAGMENTATION_H_
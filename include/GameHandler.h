@@ -1,14 +1,37 @@
 #ifndef _GAME_HANDLER_H_
 #define _GAME_HANDLER_H_
 
-#include <Sockets/SocketHandler.h>
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include "BatchedUdpIO.h"
+#include "PolledSocketHandler.h"
+#include <string>
+#include <vector>
+#include <memory>
+
+class GameShard;
+
+/**
+ * @brief Per-session round-trip and loss statistics
+ */
+struct GameSessionStats {
+    uint32_t playerId;        ///< Player ID (0 before login)
+    uint32_t srtt;            ///< Smoothed round-trip time in milliseconds
+    uint32_t rttVar;          ///< Round-trip time variance in milliseconds
+    uint32_t rto;             ///< Current retransmission timeout in milliseconds
+    uint64_t reliableSent;    ///< Reliable packets sent
+    uint64_t retransmits;     ///< Reliable packets retransmitted
+    uint32_t inFlight;        ///< Reliable packets awaiting acknowledgment
+    uint32_t held;            ///< Reliable packets waiting for room in the send window
+    uint64_t dropped;         ///< Unreliable packets dropped while the send window was full
+};
 
 /**
  * @brief Game socket handler
  * 
  * GameHandler manages game socket connections and events.
  */
-class GameHandler : public SocketHandler {
+class GameHandler : public PolledSocketHandler {
 public:
     /**
      * @brief Default constructor
@@ -109,12 +132,115 @@ public:
      * @param exceptId Player ID to exclude (0 = none)
      */
     void BroadcastToAll(const ByteBuffer& buffer, uint32_t exceptId = 0);
+    
+    /**
+     * @brief Collect all in-world sockets in a district
+     * 
+     * @param district District ID
+     * @param sockets Vector to append the sockets to
+     * @param exceptId Player ID to exclude (0 = none)
+     */
+    void GetSocketsInDistrict(uint8_t district, std::vector<class GameSocket*>& sockets, uint32_t exceptId = 0);
+    
+    /**
+     * @brief Collect all in-world sockets
+     * 
+     * @param sockets Vector to append the sockets to
+     * @param exceptId Player ID to exclude (0 = none)
+     */
+    void GetAllSockets(std::vector<class GameSocket*>& sockets, uint32_t exceptId = 0);
+    
+    /**
+     * @brief Send every socket's pending output for this tick
+     * 
+     * Runs FlushSendQueue, FlushPackets and FlushAcknowledgment on each
+     * socket. Called once per GameServer::Loop, and by a shard thread on
+     * every iteration after Update; datagrams they batch go out with the
+     * FlushBatchedIO that follows.
+     * 
+     * @param currentTime Current time in milliseconds
+     */
+    void FlushOutbound(uint32_t currentTime);
+    
+    /**
+     * @brief Collect round-trip and loss statistics of all sessions
+     * 
+     * The loss rate of a session is retransmits / reliableSent.
+     * 
+     * @param stats Vector to append one entry per session to
+     */
+    void GetSessionStats(std::vector<GameSessionStats>& stats);
+
+    /**
+     * @brief Enable batched UDP I/O
+     * 
+     * Once enabled, sockets queue their outbound datagrams and
+     * FlushBatchedIO sends them with sendmmsg once per tick.
+     * 
+     * @param batchSize Maximum datagrams per system call
+     */
+    void EnableBatchedIO(size_t batchSize) { m_batchedIO.reset(new BatchedUdpIO(batchSize)); }
+    
+    /**
+     * @brief Get the batched UDP I/O backend
+     * 
+     * @return Pointer to the backend, or nullptr if batching is disabled
+     */
+    BatchedUdpIO* GetBatchedIO() { return m_batchedIO.get(); }
+    
+    /**
+     * @brief Send all datagrams queued during this tick
+     * 
+     * @param fd Game socket descriptor
+     * @return Number of datagrams sent
+     */
+    size_t FlushBatchedIO(int fd) { return m_batchedIO ? m_batchedIO->Flush(fd) : 0; }
+    
+    /**
+     * @brief Feed a datagram received on a shard socket to its session
+     * 
+     * Looks up the session for the sender address, creating it for a new
+     * client, and runs the packet through its decode and reliability layer.
+     * 
+     * @param data Datagram data
+     * @param length Datagram length
+     * @param addr Sender address
+     * @param addrLen Sender address length
+     */
+    void ProcessDatagram(const char* data, size_t length, const struct sockaddr* addr, socklen_t addrLen);
+    
+    /**
+     * @brief Attach the handler to a receive shard
+     * 
+     * Sockets of a sharded handler hand their decoded commands to the
+     * shard instead of touching the world directly.
+     * 
+     * @param shard Owning shard, or nullptr when not sharded
+     */
+    void SetShard(GameShard* shard) { m_shard = shard; }
+    
+    /**
+     * @brief Get the owning receive shard
+     * 
+     * @return Owning shard, or nullptr when not sharded
+     */
+    GameShard* GetShard() const { return m_shard; }
 
 private:
     /**
      * @brief Maximum allowed connections
      */
     size_t m_maxConnections;
+    
+    /**
+     * @brief Batched UDP I/O backend (null when disabled)
+     */
+    std::unique_ptr<BatchedUdpIO> m_batchedIO;
+    
+    /**
+     * @brief Owning receive shard (null when not sharded)
+     */
+    GameShard* m_shard = nullptr;
 };
 
 #endif // _GAME_HANDLER_H_
\ No newline at end of file
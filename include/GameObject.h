@@ -4,6 +4,9 @@
 #include "LocationVector.h"
 #include "ByteBuffer.h"
 #include "MessageTypes.h"
+#include "ObjectDelta.h"
+#include "ObjectStore.h"
+#include "DistrictMembers.h"
 #include <string>
 #include <map>
 #include <mutex>
@@ -14,12 +17,19 @@
  * 
  * GameObject is the base class for all interactive objects in the game world,
  * including players, NPCs, items, and environmental objects.
+ * 
+ * The hot fields (position, orientation, district, state flags, type and
+ * visibility) live in the object's ObjectStore slot; the accessors below
+ * read and write through it.
  */
 class GameObject {
 public:
     /**
      * @brief Constructor
      * 
+     * Allocates the object's ObjectStore slot in the initializer list,
+     * as m_slot(objectId, objectType).
+     * 
      * @param objectId Unique object ID
      * @param objectType Type of object (see ObjectTypes enum)
      */
@@ -49,28 +59,28 @@ public:
      * 
      * @return Current position
      */
-    const LocationVector& GetPosition() const { return m_position; }
+    LocationVector GetPosition() const { return sObjectStore.GetLocation(m_slot.Get()); }
     
     /**
      * @brief Set object position
      * 
      * @param position New position
      */
-    void SetPosition(const LocationVector& position) { m_position = position; }
+    void SetPosition(const LocationVector& position) { sObjectStore.SetLocation(m_slot.Get(), position); }
     
     /**
      * @brief Get object district
      * 
      * @return District ID
      */
-    uint8_t GetDistrict() const { return m_district; }
+    uint8_t GetDistrict() const { return Hot().district[Index()]; }
     
     /**
      * @brief Set object district
      * 
      * @param district New district ID
      */
-    void SetDistrict(uint8_t district) { m_district = district; }
+    void SetDistrict(uint8_t district) { sObjectStore.SetDistrict(m_slot.Get(), district); }
     
     /**
      * @brief Get object name
@@ -91,42 +101,42 @@ public:
      * 
      * @return true if visible, false otherwise
      */
-    bool IsVisible() const { return m_isVisible; }
+    bool IsVisible() const { return Hot().visible[Index()] != 0; }
     
     /**
      * @brief Set object visibility
      * 
      * @param visible Visibility flag
      */
-    void SetVisible(bool visible) { m_isVisible = visible; }
+    void SetVisible(bool visible) { Hot().visible[Index()] = visible ? 1 : 0; }
     
     /**
      * @brief Get object state flags
      * 
      * @return State flags
      */
-    uint32_t GetStateFlags() const { return m_stateFlags; }
+    uint32_t GetStateFlags() const { return Hot().stateFlags[Index()]; }
     
     /**
      * @brief Set object state flags
      * 
      * @param flags New state flags
      */
-    void SetStateFlags(uint32_t flags) { m_stateFlags = flags; }
+    void SetStateFlags(uint32_t flags) { Hot().stateFlags[Index()] = flags; }
     
     /**
      * @brief Add state flag
      * 
      * @param flag Flag to add
      */
-    void AddStateFlag(uint32_t flag) { m_stateFlags |= flag; }
+    void AddStateFlag(uint32_t flag) { Hot().stateFlags[Index()] |= flag; }
     
     /**
      * @brief Remove state flag
      * 
      * @param flag Flag to remove
      */
-    void RemoveStateFlag(uint32_t flag) { m_stateFlags &= ~flag; }
+    void RemoveStateFlag(uint32_t flag) { Hot().stateFlags[Index()] &= ~flag; }
     
     /**
      * @brief Check if state flag is set
@@ -134,7 +144,7 @@ public:
      * @param flag Flag to check
      * @return true if set, false otherwise
      */
-    bool HasStateFlag(uint32_t flag) const { return (m_stateFlags & flag) != 0; }
+    bool HasStateFlag(uint32_t flag) const { return (Hot().stateFlags[Index()] & flag) != 0; }
     
     /**
      * @brief Get object scale
@@ -171,6 +181,24 @@ public:
      */
     virtual std::shared_ptr<MessageBase> CreateObjectUpdateMessage() const = 0;
     
+    /**
+     * @brief Capture the replicated state for delta-encoded updates
+     * 
+     * Fills the common fields; object types with more replicated state
+     * override this and write it to state.data as well.
+     * 
+     * @param state State to fill
+     * @param codec Location codec of the object's district
+     */
+    virtual void CaptureState(ObjectState& state, const LocationCodec& codec) const {
+        state.location = codec.Quantize(GetPosition());
+        state.district = GetDistrict();
+        state.stateFlags = GetStateFlags();
+        state.scale = m_scale;
+        state.visible = IsVisible();
+        state.data.clear();
+    }
+    
     /**
      * @brief Create an object destroy message
      * 
@@ -243,14 +271,45 @@ public:
      */
     const std::map<std::string, std::string>& GetAllProperties() const;
 
+    /**
+     * @brief Get the object's ObjectStore slot
+     * 
+     * @return Slot
+     */
+    uint32_t GetSlot() const { return m_slot.Get(); }
+    
+    /**
+     * @brief Get the object's index in its DistrictMembers set
+     * 
+     * @return Index, or DistrictMembers::NO_INDEX
+     */
+    uint32_t GetDistrictIndex() const { return m_districtIndex; }
+    
+    /**
+     * @brief Set the object's index in its DistrictMembers set
+     * 
+     * Maintained by DistrictMembers only.
+     * 
+     * @param index Index, or DistrictMembers::NO_INDEX
+     */
+    void SetDistrictIndex(uint32_t index) { m_districtIndex = index; }
+
 protected:
+    /**
+     * @brief Get the ObjectStore chunk holding the hot fields
+     */
+    ObjectStore::Chunk& Hot() const { return sObjectStore.GetChunk(m_slot.Get()); }
+
+    /**
+     * @brief Get the index of the hot fields in Hot()
+     */
+    uint32_t Index() const { return ObjectStore::GetIndex(m_slot.Get()); }
+
     uint32_t m_objectId;                     ///< Unique object ID
     uint16_t m_objectType;                   ///< Object type
-    LocationVector m_position;               ///< Current position
-    uint8_t m_district;                      ///< Current district
+    ObjectSlot m_slot;                       ///< Hot fields in the ObjectStore, allocated from the constructor's parameters
+    uint32_t m_districtIndex = DistrictMembers::NO_INDEX; ///< Index in the district's member set
     std::string m_name;                      ///< Object name
-    bool m_isVisible;                        ///< Visibility flag
-    uint32_t m_stateFlags;                   ///< State flags
     float m_scale;                           ///< Scale factor
     
     std::map<std::string, std::string> m_properties; ///< Custom properties
@@ -8,6 +8,11 @@
 #include "PlayerObject.h"
 #include "WorldManager.h"
 #include "MessageTypes.h"
+#include "BroadcastEngine.h"
+#include "GameShard.h"
+#include "InterestManager.h"
+#include "SlotHandleAllocator.h"
+#include "ConcurrentSlotTable.h"
 
 #include <Sockets/ListenSocket.h>
 #include <string>
@@ -39,6 +44,8 @@ public:
      * @brief Start the game server
      * 
      * Initializes and starts the server, binding to the configured port.
+     * With Performance.GameThreads above one, the port is served by that
+     * many SO_REUSEPORT receive shards instead of the single listen socket.
      */
     void Start();
     
@@ -53,6 +60,12 @@ public:
      * @brief Process a server loop iteration
      * 
      * Handles pending socket events, updates game state, and processes game logic.
+     * When sharded, the commands decoded by the shards are applied here,
+     * on the simulation thread. The tick ends with one
+     * GameHandler::FlushOutbound, so each client gets its blocks packed
+     * into as few packets as possible. When sharded, the sessions belong
+     * to the shard threads, and each shard flushes its own sessions
+     * every iteration instead.
      * 
      * @param diff Time difference since last update in milliseconds
      */
@@ -77,6 +90,10 @@ public:
     /**
      * @brief Get a player by ID
      * 
+     * An array lookup by the ID's slot index; stale IDs of removed
+     * players find nothing. Lock-free and wait-free, so socket threads
+     * never queue behind the update loop.
+     * 
      * @param playerId Player ID to find
      * @return Shared pointer to player object, or nullptr if not found
      */
@@ -101,9 +118,11 @@ public:
     /**
      * @brief Get all players in the server
      * 
-     * @return Map of player ID to player object
+     * Iterate with ForEach from any thread without a lock.
+     * 
+     * @return Players by player ID
      */
-    const std::map<uint32_t, std::shared_ptr<PlayerObject>>& GetAllPlayers() const;
+    const ConcurrentSlotTable<std::shared_ptr<PlayerObject>>& GetAllPlayers() const;
     
     /**
      * @brief Get the world manager
@@ -124,6 +143,9 @@ public:
     /**
      * @brief Send a message to all players in a district
      * 
+     * The message is serialized once and the resulting block is shared
+     * by every recipient's packet.
+     * 
      * @param districtId District ID to send to
      * @param message Message to send
      * @param exceptPlayerId Player ID to exclude (optional)
@@ -133,11 +155,42 @@ public:
     /**
      * @brief Send a message to all players in the server
      * 
+     * The message is serialized once and the resulting block is shared
+     * by every recipient's packet.
+     * 
      * @param message Message to send
      * @param exceptPlayerId Player ID to exclude (optional)
      */
     void BroadcastToAll(const MessageBase& message, uint32_t exceptPlayerId = 0);
     
+    /**
+     * @brief Send a message about an object to the players that see it
+     * 
+     * Replaces BroadcastToDistrict for object and player updates, so
+     * each update reaches the observers in range instead of the whole
+     * district. When sharded, the block is queued to the shards that own
+     * the observers' sessions.
+     * 
+     * @param objectId Object the message is about
+     * @param message Message to send
+     * @param reliable Is the message reliable
+     * @param encrypted Encrypt the message
+     */
+    void BroadcastToObservers(uint32_t objectId, const MessageBase& message, bool reliable = true, bool encrypted = false) {
+        if (m_shards.IsRunning()) {
+            m_broadcastEngine.BroadcastToObservers(m_shards, m_interestManager, objectId, message, reliable, encrypted);
+            return;
+        }
+        m_broadcastEngine.BroadcastToObservers(gameSocketHandler, m_interestManager, objectId, message, reliable, encrypted);
+    }
+    
+    /**
+     * @brief Get the area-of-interest manager
+     * 
+     * @return Interest manager
+     */
+    InterestManager& GetInterestManager() { return m_interestManager; }
+    
     /**
      * @brief Create a game object in the world
      * 
@@ -160,6 +213,9 @@ public:
     /**
      * @brief Destroy a game object
      * 
+     * Releases the object ID, after which lookups with it fail even
+     * once its slot is reused.
+     * 
      * @param objectId Object ID to destroy
      * @return true if successful, false otherwise
      */
@@ -176,11 +232,51 @@ public:
     void GetStats(uint32_t& totalPlayers, uint32_t& activePlayers, uint32_t& objectCount, uint32_t& uptime);
     
     /**
-     * @brief Get the next available game object ID
+     * @brief Get broadcast statistics
      * 
-     * @return Next available object ID
+     * Compares bytes serialized with bytes sent to show the fan-out
+     * saved by serializing broadcasts once.
+     * 
+     * @param stats Structure to fill
+     */
+    void GetBroadcastStats(BroadcastEngine::Stats& stats) const { m_broadcastEngine.GetStats(stats); }
+    
+    /**
+     * @brief Get the number of game receive shards
+     * 
+     * @return Number of shards, 0 when running unsharded
+     */
+    size_t GetShardCount() const { return m_shards.GetShardCount(); }
+    
+    /**
+     * @brief Allocate a game object ID
+     * 
+     * IDs of objects and players are generational handles (slot index
+     * and generation, see SlotHandleAllocator), so they index the
+     * player and object tables directly and are reused without
+     * running out.
+     * 
+     * @return Object ID, or 0 if every slot is in use
      */
-    uint32_t GetNextObjectId();
+    uint32_t AllocateObjectId() { return m_objectIds.Allocate(); }
+    
+    /**
+     * @brief Release a game object ID
+     * 
+     * Called by DestroyObject and RemovePlayer.
+     * 
+     * @param objectId Object ID
+     * @return true if released, false if the ID was stale or invalid
+     */
+    bool ReleaseObjectId(uint32_t objectId) { return m_objectIds.Release(objectId); }
+    
+    /**
+     * @brief Check if a game object ID is live
+     * 
+     * @param objectId Object ID
+     * @return true if allocated and not yet released
+     */
+    bool IsObjectIdLive(uint32_t objectId) const { return m_objectIds.IsLive(objectId); }
 
 private:
     /**
@@ -213,6 +309,24 @@ private:
      * @brief Check for player timeout
      */
     void CheckPlayerTimeout();
+    
+    /**
+     * @brief Recompute the players' visible sets
+     * 
+     * Runs InterestManager::Update every m_interestUpdateInterval; objects
+     * entering a view are sent with SendObjectCreate, objects leaving it
+     * with SendObjectDestroy (and their delta baseline is dropped). When
+     * sharded, these are serialized here and queued with
+     * GameShardSet::SendToPlayer rather than written to the sessions.
+     */
+    void UpdateInterest();
+    
+    /**
+     * @brief Apply a command decoded by a receive shard
+     * 
+     * @param command Command to apply
+     */
+    void ApplyCommand(GameCommand& command);
 
     /**
      * @brief Game socket handler
@@ -230,12 +344,37 @@ private:
     GameListenSocket *listenSocketInst;
     
     /**
-     * @brief Player map (ID to object)
+     * @brief SO_REUSEPORT receive shards (empty when unsharded)
+     */
+    GameShardSet m_shards;
+    
+    /**
+     * @brief Broadcast engine (serialize-once fan-out)
+     */
+    BroadcastEngine m_broadcastEngine;
+    
+    /**
+     * @brief Area-of-interest manager (who sees which object)
+     */
+    InterestManager m_interestManager;
+    
+    /**
+     * @brief Interest update interval in milliseconds
+     */
+    uint32_t m_interestUpdateInterval = 250;
+    
+    /**
+     * @brief Last interest update time
+     */
+    uint32_t m_lastInterestUpdate = 0;
+    
+    /**
+     * @brief Players by player ID, read lock-free
      */
-    std::map<uint32_t, std::shared_ptr<PlayerObject>> m_players;
+    ConcurrentSlotTable<std::shared_ptr<PlayerObject>> m_players;
     
     /**
-     * @brief Player map mutex
+     * @brief Serializes player adds and removals and guards m_playerHandles; GetPlayer does not take it
      */
     std::mutex m_playersMutex;
     
@@ -250,9 +389,9 @@ private:
     WorldManager m_worldManager;
     
     /**
-     * @brief Next available object ID
+     * @brief Object and player ID allocator
      */
-    uint32_t m_nextObjectId;
+    SlotHandleAllocator m_objectIds;
     
     /**
      * @brief Server start time
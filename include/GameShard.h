@@ -0,0 +1,270 @@
+#ifndef _GAME_SHARD_H_
+#define _GAME_SHARD_H_
+
+#include "GameHandler.h"
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include "SpscQueue.h"
+#include "PollBackend.h"
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Decoded game command handed from a shard to the simulation thread
+ */
+struct GameCommand {
+    uint32_t shard;      ///< Index of the shard that owns the session
+    uint32_t playerId;   ///< Player that issued the command
+    uint16_t type;       ///< Message type
+    ByteBuffer data;     ///< Message data (without headers)
+};
+
+/**
+ * @brief Message block handed from the simulation thread to a shard
+ */
+struct GameOutbound {
+    uint32_t playerId;                    ///< Recipient player (0 = all sessions of the shard)
+    uint16_t type;                        ///< Message type
+    ByteBufferChain::SharedBuffer block;  ///< Shared message block
+    bool reliable;                        ///< Is the message reliable
+    bool encrypted;                       ///< Is the message encrypted
+};
+
+/**
+ * @brief Game socket receive shard
+ * 
+ * A GameShard owns one SO_REUSEPORT socket bound to the game port, its
+ * own GameHandler and the sessions the kernel routes to it. The kernel
+ * hashes the client address, so a client always lands on the same shard.
+ * Decoding, reliability, resends, timeouts and the per-iteration
+ * GameHandler::FlushOutbound of its sessions run on the shard thread;
+ * only decoded commands cross to the simulation thread, and only shared
+ * message blocks come back, both through single-producer single-consumer
+ * queues.
+ */
+class GameShard {
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param index Shard index
+     * @param queueSize Capacity of each command queue
+     */
+    GameShard(uint32_t index, size_t queueSize);
+
+    /**
+     * @brief Destructor
+     */
+    ~GameShard();
+
+    /**
+     * @brief Bind the shard socket and start the shard thread
+     * 
+     * @param port Game port
+     * @param batchSize Datagrams per receive/send system call
+     * @param pollBackend Readiness backend name ("epoll", "io_uring" or "select")
+     * @return true if successful, false otherwise
+     */
+    bool Start(uint16_t port, size_t batchSize, const std::string& pollBackend);
+
+    /**
+     * @brief Stop the shard thread and close the socket
+     */
+    void Stop();
+
+    /**
+     * @brief Queue a decoded command for the simulation thread (shard thread only)
+     * 
+     * Commands that do not fit are kept on the shard and retried on the
+     * next iteration, so nothing a client sent reliably is lost.
+     * 
+     * @param playerId Player that issued the command
+     * @param type Message type
+     * @param data Message data
+     */
+    void PushCommand(uint32_t playerId, uint16_t type, ByteBuffer&& data);
+
+    /**
+     * @brief Pop a decoded command (simulation thread only)
+     * 
+     * @param command Receives the command
+     * @return true if a command was popped, false if none are pending
+     */
+    bool PopCommand(GameCommand& command) { return m_commands.TryPop(command); }
+
+    /**
+     * @brief Queue a message block for the shard's sessions (simulation thread only)
+     * 
+     * @param outbound Message to send
+     * @return true if queued, false if the queue is full
+     */
+    bool PushOutbound(GameOutbound& outbound) { return m_outbound.TryPush(outbound); }
+
+    /**
+     * @brief Get the shard index
+     * 
+     * @return Shard index
+     */
+    uint32_t GetIndex() const { return m_index; }
+
+    /**
+     * @brief Get the number of sessions owned by the shard
+     * 
+     * @return Number of sessions
+     */
+    size_t GetConnectionCount() const { return m_connections.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the shard's socket handler (shard thread only)
+     * 
+     * @return Reference to the handler
+     */
+    GameHandler& GetHandler() { return m_handler; }
+
+private:
+    /**
+     * @brief Shard thread body
+     */
+    void Run();
+
+    /**
+     * @brief Send the message blocks queued by the simulation thread
+     * 
+     * The blocks are queued on the sessions; Run flushes them.
+     */
+    void DrainOutbound();
+
+    /**
+     * @brief Retry commands that did not fit in the queue
+     */
+    void FlushPendingCommands();
+
+    uint32_t m_index;                            ///< Shard index
+    int m_fd;                                    ///< SO_REUSEPORT socket
+    GameHandler m_handler;                       ///< Sessions owned by this shard
+    std::unique_ptr<PollBackend> m_poll;         ///< Readiness backend for m_fd
+    SpscQueue<GameCommand> m_commands;           ///< Shard -> simulation
+    SpscQueue<GameOutbound> m_outbound;          ///< Simulation -> shard
+    std::deque<GameCommand> m_pending;           ///< Commands waiting for queue space
+    std::vector<GameSocket*> m_recipients;       ///< Scratch list for shard-wide sends
+    std::atomic<bool> m_running;                 ///< Shard thread keep-running flag
+    std::atomic<size_t> m_connections;           ///< Session count for statistics
+    std::thread m_thread;                        ///< Shard thread
+};
+
+/**
+ * @brief Set of game receive shards
+ * 
+ * Owned by the game server and used from the simulation thread only.
+ */
+class GameShardSet {
+public:
+    /**
+     * @brief Command callback
+     */
+    typedef std::function<void(GameCommand&)> CommandCallback;
+
+    /**
+     * @brief Default constructor
+     */
+    GameShardSet();
+
+    /**
+     * @brief Destructor
+     */
+    ~GameShardSet();
+
+    /**
+     * @brief Start the shards
+     * 
+     * Falls back to a single shard where SO_REUSEPORT is not available.
+     * Game.IOBatchSize sets the datagrams per receive/send system call;
+     * with Game.BatchedIO off each call moves a single datagram. Each
+     * shard waits through the Network.PollBackend readiness backend.
+     * 
+     * @param port Game port
+     * @param count Number of shards
+     * @param queueSize Capacity of each command queue
+     * @return Number of shards started
+     */
+    size_t Start(uint16_t port, size_t count, size_t queueSize);
+
+    /**
+     * @brief Stop all shards
+     */
+    void Stop();
+
+    /**
+     * @brief Check if the shards are running
+     * 
+     * @return true if running, false otherwise
+     */
+    bool IsRunning() const { return !m_shards.empty(); }
+
+    /**
+     * @brief Get the number of shards
+     * 
+     * @return Number of shards
+     */
+    size_t GetShardCount() const { return m_shards.size(); }
+
+    /**
+     * @brief Get the total number of sessions over all shards
+     * 
+     * @return Number of sessions
+     */
+    size_t GetConnectionCount() const;
+
+    /**
+     * @brief Process commands decoded by the shards
+     * 
+     * Also records which shard owns each player so replies can be routed.
+     * 
+     * @param callback Called for every command
+     * @param maxCommands Maximum commands to process per shard
+     * @return Number of commands processed
+     */
+    size_t DrainCommands(const CommandCallback& callback, size_t maxCommands = 1024);
+
+    /**
+     * @brief Send a message block to a player
+     * 
+     * @param playerId Recipient player
+     * @param type Message type
+     * @param block Shared message block
+     * @param reliable Is the message reliable
+     * @param encrypted Is the message encrypted
+     * @return true if queued, false if the player is unknown or the queue is full
+     */
+    bool SendToPlayer(uint32_t playerId, uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable = true, bool encrypted = false);
+
+    /**
+     * @brief Send a message block to every session on every shard
+     * 
+     * @param type Message type
+     * @param block Shared message block
+     * @param reliable Is the message reliable
+     * @param encrypted Is the message encrypted
+     */
+    void SendToAll(uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable = true, bool encrypted = false);
+
+    /**
+     * @brief Forget the shard of a player that left
+     * 
+     * @param playerId Player ID
+     */
+    void RemovePlayer(uint32_t playerId) { m_playerShards.erase(playerId); }
+
+private:
+    std::vector<std::unique_ptr<GameShard>> m_shards;  ///< Shards
+    std::map<uint32_t, uint32_t> m_playerShards;       ///< Player ID to shard index
+};
+
+#endif // _GAME_SHARD_H_
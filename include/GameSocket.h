@@ -2,6 +2,18 @@
 #define _GAME_SOCKET_H_
 
 #include "ByteBuffer.h"
+#include "ByteBufferPool.h"
+#include "ByteBufferChain.h"
+#include "ByteView.h"
+#include "ReliabilityWindow.h"
+#include "RttEstimator.h"
+#include "SendScheduler.h"
+#include "PacketAggregator.h"
+#include "Fragmentation.h"
+#include "PacketCompressor.h"
+#include "ObjectDelta.h"
+#include "LocationCodec.h"
+#include "GameHandler.h"
 #include "MessageTypes.h"
 #include "LocationVector.h"
 #include <Sockets/Socket.h>
@@ -58,6 +70,9 @@ public:
     
     /**
      * @brief Called when data is received
+     * 
+     * Message blocks are handed to ProcessMessage as views into the
+     * received datagram; handlers must not keep them after returning.
      */
     void OnRawData(const char* buffer, size_t len, struct sockaddr* sa, socklen_t sa_len);
     
@@ -67,14 +82,14 @@ public:
      * @param type Message type
      * @param data Message data
      */
-    void ProcessMessage(uint16_t type, ByteBuffer& data);
+    void ProcessMessage(uint16_t type, ByteView& data);
     
     /**
      * @brief Process a game handshake
      * 
      * @param data Handshake data
      */
-    void ProcessGameHandshake(ByteBuffer& data);
+    void ProcessGameHandshake(ByteView& data);
     
     /**
      * @brief Send a game session response
@@ -86,37 +101,57 @@ public:
     /**
      * @brief Process a player movement message
      * 
+     * The location is read with the connection's LocationCodec and kept
+     * as quantized, so the server holds exactly what the client sent.
+     * 
      * @param data Movement data
      */
-    void ProcessPlayerMovement(ByteBuffer& data);
+    void ProcessPlayerMovement(ByteView& data);
+    
+    /**
+     * @brief Set the location codec for the player's district
+     * 
+     * Called on world entry and district change with the district's
+     * bounds and the configured precision.
+     * 
+     * @param codec Location codec
+     */
+    void SetLocationCodec(const LocationCodec& codec) { m_locationCodec = codec; }
+    
+    /**
+     * @brief Get the location codec for the player's district
+     * 
+     * @return Location codec
+     */
+    const LocationCodec& GetLocationCodec() const { return m_locationCodec; }
     
     /**
      * @brief Process a player state message
      * 
      * @param data State data
      */
-    void ProcessPlayerState(ByteBuffer& data);
+    void ProcessPlayerState(ByteView& data);
     
     /**
      * @brief Process a player command
      * 
      * @param data Command data
      */
-    void ProcessPlayerCommand(ByteBuffer& data);
+    void ProcessPlayerCommand(ByteView& data);
     
     /**
      * @brief Process a region load notification
      * 
      * @param data Notification data
      */
-    void ProcessRegionLoad(ByteBuffer& data);
+    void ProcessRegionLoad(ByteView& data);
     
     /**
      * @brief Process a jackout request
      * 
      * @param data Request data
      */
-    void ProcessJackoutRequest(ByteBuffer& data);
+    void ProcessJackoutRequest(ByteView& data);
     
     /**
      * @brief Send a jackout response
@@ -128,6 +163,8 @@ public:
     /**
      * @brief Send a world state update
      * 
+     * States larger than one packet are sent with SendLargeMessage.
+     * 
      * @param state World state data
      */
     void SendWorldState(const ByteBuffer& state);
@@ -135,6 +172,9 @@ public:
     /**
      * @brief Send an object create message
      * 
+     * Like the other Send* messages, the block is queued on the packet
+     * aggregator and goes out with the next FlushPackets.
+     * 
      * @param objectId Object ID
      * @param objectType Object type
      * @param position Object position
@@ -150,6 +190,218 @@ public:
      */
     void SendObjectUpdate(uint32_t objectId, const ByteBuffer& data);
     
+    /**
+     * @brief Send an object update message with a shared payload
+     * 
+     * The payload is referenced by the outgoing packet rather than
+     * copied, so one serialized update can be sent to many clients.
+     * 
+     * @param objectId Object ID
+     * @param data Shared update data
+     */
+    void SendObjectUpdate(uint32_t objectId, const ByteBufferChain::SharedBuffer& data);
+    
+    /**
+     * @brief Send a delta-encoded object update
+     * 
+     * Encodes the fields this client may not have yet against its
+     * baseline for the object (see DeltaTracker) and queues the
+     * MSG_OBJECT_UPDATE block unreliably. Objects without a baseline get
+     * the full state. Must be called when the update is actually sent,
+     * not queued on the send scheduler.
+     * 
+     * @param objectId Object ID
+     * @param state Current object state (GameObject::CaptureState with GetLocationCodec())
+     * @param encrypted Encrypt the update
+     * @return true if an update was queued, false if the client already has this state or it exceeds MAX_BLOCK_DATA_SIZE
+     */
+    bool SendObjectDelta(uint32_t objectId, const ObjectState& state, bool encrypted = false) {
+        ByteBuffer block;
+        block.reserve(BLOCK_HEADER_SIZE + 4 + 64 + state.data.wpos());
+        block << uint16_t(MSG_OBJECT_UPDATE);
+        block << uint16_t(0);
+        block << objectId;
+        if (!m_deltaTracker.Encode(objectId, state, m_locationCodec, block)) {
+            return false;
+        }
+        
+        if (!PatchBlockLength(block)) {
+            // Encode recorded the update as pending; it was never sent
+            m_deltaTracker.Forget(objectId);
+            return false;
+        }
+        
+        QueueBlock(MSG_OBJECT_UPDATE, std::move(block), false, encrypted);
+        return true;
+    }
+    
+    /**
+     * @brief Drop the delta baseline of an object
+     * 
+     * Called when the object leaves the client's view or is destroyed,
+     * so its next update (after a new create) carries the full state.
+     * 
+     * @param objectId Object ID
+     */
+    void ForgetObjectBaseline(uint32_t objectId) { m_deltaTracker.Forget(objectId); }
+    
+    /**
+     * @brief Get delta encoding statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetDeltaStats(DeltaTracker::Stats& stats) const { m_deltaTracker.GetStats(stats); }
+    
+    /**
+     * @brief Send an already serialized message block
+     * 
+     * The block is shared with every other recipient of the broadcast
+     * and packed into this connection's next packet; the game header is
+     * built once per packet by FlushPackets. Encrypted and plaintext
+     * blocks never share a packet.
+     * 
+     * @param type Message type
+     * @param block Shared message block (type, length, data)
+     * @param reliable Is the message reliable
+     * @param encrypted Encrypt the message
+     * @return Number of block bytes queued
+     */
+    size_t SendSharedMessage(uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, bool encrypted = false) {
+        m_aggregator.Add(type, block, reliable, encrypted, GetPacketEmitter());
+        return block->wpos();
+    }
+    
+    /**
+     * @brief Send a message block of any size
+     * 
+     * Blocks that fit in one packet are aggregated as usual. Larger ones
+     * are split into reliable PACKET_FLAG_FRAGMENT packets that reference
+     * slices of the block, after flushing the blocks queued before it so
+     * ordering is kept.
+     * 
+     * @param type Message type
+     * @param block Shared message block (type, length, data)
+     * @param encrypted Encrypt the message
+     * @return Number of packets sent (0 if the block was aggregated or too large)
+     */
+    size_t SendLargeMessage(uint16_t type, const ByteBufferChain::SharedBuffer& block, bool encrypted = false) {
+        if (block->wpos() <= m_aggregator.GetMaxPayload()) {
+            SendSharedMessage(type, block, true, encrypted);
+            return 0;
+        }
+        
+        m_aggregator.Flush(GetPacketEmitter());
+        return FragmentSplitter::Split(block, m_aggregator.GetMaxPayload() - FragmentHeader::SIZE, m_nextFragmentId++,
+            [this, type, encrypted](ByteBufferChain& fragment) {
+                SendGamePacket(type, fragment, true, encrypted, 1, true);
+            });
+    }
+    
+    /**
+     * @brief Queue an owned message block for the next packet
+     * 
+     * @param type Message type
+     * @param block Message block (type, length, data)
+     * @param reliable Is the message reliable
+     * @param encrypted Encrypt the message
+     */
+    void QueueBlock(uint16_t type, ByteBuffer&& block, bool reliable, bool encrypted = false) {
+        m_aggregator.Add(type, std::move(block), reliable, encrypted, GetPacketEmitter());
+    }
+    
+    /**
+     * @brief Send the packets holding this tick's message blocks
+     * 
+     * Called once per GameServer::Loop, after FlushSendQueue. Also closes
+     * the delta tracker's frame for this tick.
+     * 
+     * @return Number of packets sent
+     */
+    size_t FlushPackets() {
+        size_t packets = m_aggregator.Flush(GetPacketEmitter());
+        m_deltaTracker.EndFrame();
+        return packets;
+    }
+    
+    /**
+     * @brief Set the largest datagram the aggregator produces
+     * 
+     * @param mtu Datagram size including headers
+     */
+    void SetMaxPacketSize(size_t mtu) { m_aggregator.SetMtu(mtu); }
+    
+    /**
+     * @brief Queue a message block on the connection's send scheduler
+     * 
+     * The block is released by FlushSendQueue when the connection's
+     * bandwidth budget allows, highest priority class first.
+     * 
+     * @param priority Priority class
+     * @param type Message type
+     * @param block Shared message block
+     * @param reliable Is the message reliable
+     * @param coalesceKey Key of the state carried, e.g. the object ID (0 = never coalesce)
+     * @param currentTime Current time in milliseconds
+     * @param encrypted Encrypt the message
+     */
+    void QueueMessage(SendPriority priority, uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, uint32_t coalesceKey, uint32_t currentTime, bool encrypted = false) {
+        m_sendScheduler.Enqueue(priority, type, block, reliable, coalesceKey, currentTime, encrypted);
+    }
+    
+    /**
+     * @brief Send the queued messages the bandwidth budget allows
+     * 
+     * Called from GameHandler::FlushOutbound: once per GameServer::Loop,
+     * or on every shard iteration when sharded.
+     * 
+     * @param currentTime Current time in milliseconds
+     * @return Number of messages sent
+     */
+    size_t FlushSendQueue(uint32_t currentTime) {
+        return m_sendScheduler.Flush(currentTime, [this](const SendScheduler::Message& message) {
+            SendSharedMessage(message.type, message.block, message.reliable, message.encrypted);
+        });
+    }
+    
+    /**
+     * @brief Set the connection's bandwidth budget
+     * 
+     * @param maxRate Budget ceiling in bytes per second
+     * @param minRate Budget floor in bytes per second
+     * @param burst Bucket size in bytes
+     */
+    void SetBandwidthBudget(uint32_t maxRate, uint32_t minRate, uint32_t burst) {
+        m_sendScheduler.SetBudget(maxRate, minRate, burst);
+    }
+    
+    /**
+     * @brief Get send scheduler statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetSchedulerStats(SendScheduler::Stats& stats) const { m_sendScheduler.GetStats(stats); }
+    
+    /**
+     * @brief Enable PACKET_FLAG_COMPRESSED for this connection
+     * 
+     * Only for clients that announced support; the stock client does not
+     * understand compressed packets.
+     * 
+     * @param dictionary Dictionary shared by all connections (may be null)
+     * @param threshold Smallest payload worth compressing in bytes
+     */
+    void EnableCompression(const CompressionDictionary::Ptr& dictionary, size_t threshold) {
+        m_compressor.SetThreshold(threshold);
+        m_compressor.Enable(dictionary);
+    }
+    
+    /**
+     * @brief Get compression statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetCompressionStats(PacketCompressor::Stats& stats) const { m_compressor.GetStats(stats); }
+    
     /**
      * @brief Send an object destroy message
      * 
@@ -270,6 +522,23 @@ public:
      * @param diff Time difference since last update in milliseconds
      */
     void Update(uint32_t diff);
+    
+    /**
+     * @brief Get round-trip and loss statistics for this session
+     * 
+     * @param stats Structure to fill
+     */
+    void GetSessionStats(GameSessionStats& stats) const {
+        stats.playerId = m_playerId;
+        stats.srtt = m_rtt.GetSrtt();
+        stats.rttVar = m_rtt.GetRttVar();
+        stats.rto = m_rtt.GetRto();
+        stats.reliableSent = m_reliableSent;
+        stats.retransmits = m_retransmits;
+        stats.inFlight = (uint32_t)m_sendWindow.GetInFlight();
+        stats.held = (uint32_t)m_heldPackets.GetHeld();
+        stats.dropped = m_heldPackets.GetDropped();
+    }
 
 private:
     /**
@@ -284,13 +553,154 @@ private:
     /**
      * @brief Build a game packet header
      * 
+     * Every header carries the newest received sequence as its ack number
+     * followed by the selective ack bitfield (PACKET_FLAG_ACK_BITS), which
+     * clears any pending acknowledgment.
+     * 
      * @param type Message type
      * @param length Message length
      * @param buffer Buffer to write to
      * @param reliable Is packet reliable
      * @param encrypted Is packet encrypted
+     * @param blockCount Number of message blocks in the packet
+     * @param fragment Set PACKET_FLAG_FRAGMENT (a fragment header follows the game header)
+     * @param compressed Set PACKET_FLAG_COMPRESSED (the payload is compressed)
+     */
+    void BuildGameHeader(uint16_t type, uint32_t length, ByteBuffer& buffer, bool reliable, bool encrypted, uint8_t blockCount = 1, bool fragment = false, bool compressed = false);
+    
+    /**
+     * @brief Send a game packet assembled from a buffer chain
+     * 
+     * Builds the game header for the chain's total length, prepends it
+     * as its own segment and sends the chain without concatenating it.
+     * First offers the packet to HoldPacket, before it takes a sequence
+     * number, and returns if the packet was held or dropped.
+     * Payloads over the compression threshold are compressed first (see
+     * CompressPayload), so the send window keeps and resends the
+     * compressed form. Encrypted packets are flattened after that. The
+     * sequence is recorded on the delta tracker (OnPacketSent) so the
+     * frame's object states become baselines once it is acknowledged.
+     * 
+     * @param type Message type
+     * @param chain Message blocks and payloads
+     * @param reliable Is packet reliable
+     * @param encrypted Is packet encrypted
+     * @param blockCount Number of message blocks in the chain
+     * @param fragment Chain is a fragment (fragment header and payload slice)
      */
-    void BuildGameHeader(uint16_t type, uint32_t length, ByteBuffer& buffer, bool reliable, bool encrypted);
+    void SendGamePacket(uint16_t type, ByteBufferChain& chain, bool reliable, bool encrypted, uint8_t blockCount = 1, bool fragment = false);
+    
+    /**
+     * @brief Hold a packet back until the send window has room
+     * 
+     * Every packet takes a sequence number, and the client's acks only
+     * reach ACK_SEQUENCE_COVERAGE sequences back from its newest, so no
+     * new sequence may be assigned while the send window cannot take it
+     * (see SendWindow and HeldPacketQueue). Reliable packets are held,
+     * in order, and ReleaseHeldPackets sends them as acks free the
+     * window; unreliable ones are dropped. A client that lets more than
+     * MAX_HELD_PACKETS back up is disconnected.
+     * 
+     * @param type Message type
+     * @param chain Message blocks and payloads (moved from if held)
+     * @param reliable Is packet reliable
+     * @param encrypted Is packet encrypted
+     * @param blockCount Number of message blocks in the chain
+     * @param fragment Chain is a fragment
+     * @return true if the packet was held or dropped and must not be sent now
+     */
+    bool HoldPacket(uint16_t type, ByteBufferChain& chain, bool reliable, bool encrypted, uint8_t blockCount, bool fragment) {
+        HeldPackets::Result result = m_heldPackets.Offer(m_sendWindow, m_nextSequence, reliable, [&]() {
+            HeldPacket held;
+            held.type = type;
+            held.chain = std::move(chain);
+            held.reliable = reliable;
+            held.encrypted = encrypted;
+            held.blockCount = blockCount;
+            held.fragment = fragment;
+            return held;
+        });
+        
+        if (result == HeldPackets::HOLD_OVERFLOW) {
+            m_state = STATE_DISCONNECTING;
+        }
+        return result != HeldPackets::HOLD_SEND;
+    }
+    
+    /**
+     * @brief Send held packets while the send window has room
+     * 
+     * Called after every acknowledgment.
+     */
+    void ReleaseHeldPackets() {
+        m_heldPackets.Release(m_sendWindow, m_nextSequence, [this](HeldPacket& held) {
+            SendGamePacket(held.type, held.chain, held.reliable, held.encrypted, held.blockCount, held.fragment);
+        });
+    }
+    
+    /**
+     * @brief Process a received PACKET_FLAG_FRAGMENT packet
+     * 
+     * @param data Packet data positioned at the fragment header
+     * @param currentTime Current time in milliseconds
+     * @param message Receives the reassembled message block
+     * @return true if the message is complete and should be processed
+     */
+    bool ProcessFragment(ByteView& data, uint32_t currentTime, ByteBuffer& message) {
+        return m_fragmentAssembler.AddFragment(data, currentTime, message) == FragmentAssembler::FRAGMENT_COMPLETE;
+    }
+    
+    /**
+     * @brief Compress a packet payload in place
+     * 
+     * @param chain Payload following the game header; replaced by the compressed payload
+     * @return true if PACKET_FLAG_COMPRESSED must be set
+     */
+    bool CompressPayload(ByteBufferChain& chain) {
+        ByteBuffer compressed;
+        if (!m_compressor.Compress(chain, compressed)) {
+            return false;
+        }
+        
+        chain.Clear();
+        chain.AppendOwned(std::move(compressed));
+        return true;
+    }
+    
+    /**
+     * @brief Decompress a received PACKET_FLAG_COMPRESSED payload
+     * 
+     * Runs before fragment and block processing; packets that fail are dropped.
+     * 
+     * @param data Packet data positioned after the game header; consumed
+     * @param payload Receives the payload
+     * @return true on success
+     */
+    bool DecompressPayload(ByteView& data, ByteBuffer& payload) {
+        size_t length = data.remaining();
+        bool result = m_compressor.Decompress(data.contents() + data.rpos(), length, payload);
+        data.skip(length);
+        return result;
+    }
+    
+    /**
+     * @brief Get the callback that turns aggregated blocks into a packet
+     * 
+     * @return Packet callback for the aggregator
+     */
+    PacketAggregator::PacketCallback GetPacketEmitter() {
+        return [this](uint16_t type, ByteBufferChain& blocks, uint8_t blockCount, bool reliable, bool encrypted) {
+            SendGamePacket(type, blocks, reliable, encrypted, blockCount);
+        };
+    }
+    
+    /**
+     * @brief Acquire a pooled send buffer
+     * 
+     * @param length Message length that will follow the header
+     * @return Empty buffer from the thread's ByteBufferPool
+     */
+    PooledBuffer AcquireSendBuffer(size_t length) { return PooledBuffer(GAME_HEADER_SIZE + length); }
     
     /**
      * @brief Send raw data
@@ -299,26 +709,82 @@ private:
      */
     void SendRawData(const ByteBuffer& buffer);
     
+    /**
+     * @brief Send raw data from a buffer chain
+     * 
+     * The segments are passed to sendmsg as an iovec array, or queued
+     * on the handler's BatchedUdpIO when batched I/O is enabled.
+     * 
+     * @param chain Data segments
+     */
+    void SendRawData(const ByteBufferChain& chain);
+    
     /**
      * @brief Process acknowledgment
      * 
-     * @param ackNum Acknowledgment number
+     * Releases every packet covered by the ack number and bitfield from
+     * the send window; stale and duplicate acknowledgments are ignored.
+     * 
+     * Packets that were sent exactly once feed the RTT estimator;
+     * retransmitted ones are ambiguous and skipped (Karn's rule). The
+     * acknowledgment also advances the delta tracker's baselines and
+     * releases packets held for room in the send window.
+     * 
+     * @param ackNum Newest sequence received by the client
+     * @param ackBits Selective ack bitfield (0 for clients without PACKET_FLAG_ACK_BITS)
+     * @param currentTime Current time in milliseconds
      */
-    void ProcessAcknowledgment(uint16_t ackNum);
+    void ProcessAcknowledgment(uint16_t ackNum, uint32_t ackBits, uint32_t currentTime) {
+        m_sendWindow.AcknowledgeBits(ackNum, ackBits,
+            [this, currentTime](const SendWindow<SEND_WINDOW_SIZE>::Entry& entry) {
+                if (entry.sendCount == 1) {
+                    m_rtt.AddSample(currentTime - entry.sentTime);
+                }
+            });
+        m_deltaTracker.OnAcknowledged(ackNum, ackBits);
+        if (SequenceGreaterThan(ackNum, m_lastAcknowledged)) {
+            m_lastAcknowledged = ackNum;
+        }
+        ReleaseHeldPackets();
+    }
     
     /**
      * @brief Process reliable packet
      * 
+     * Records the sequence in the receive window. The acknowledgment is
+     * not sent right away; it rides on the next outbound packet, or on an
+     * ack-only packet once ACK_DELAY passes without one.
+     * 
      * @param seqNum Sequence number
+     * @param currentTime Current time in milliseconds
+     * @return true if the packet is new, false if it is a duplicate
      */
-    void ProcessReliablePacket(uint16_t seqNum);
+    bool ProcessReliablePacket(uint16_t seqNum, uint32_t currentTime) {
+        if (!m_ackPending) {
+            m_ackPending = true;
+            m_ackPendingSince = currentTime;
+        }
+        return m_receiveWindow.Record(seqNum);
+    }
     
     /**
-     * @brief Send acknowledgment
+     * @brief Send an ack-only packet
      * 
-     * @param seqNum Sequence number to acknowledge
+     * A game header without message blocks, carrying the current ack
+     * number and bitfield.
      */
-    void SendAcknowledgment(uint16_t seqNum);
+    void SendAcknowledgment();
+    
+    /**
+     * @brief Send an ack-only packet if an acknowledgment has waited too long
+     * 
+     * @param currentTime Current time in milliseconds
+     */
+    void FlushAcknowledgment(uint32_t currentTime) {
+        if (m_ackPending && currentTime - m_ackPendingSince >= ACK_DELAY) {
+            SendAcknowledgment();
+        }
+    }
     
     /**
      * @brief Encrypt data
@@ -337,9 +803,47 @@ private:
     ByteBuffer DecryptData(const ByteBuffer& data);
     
     /**
-     * @brief Resend unacknowledged packets
+     * @brief Track a reliable packet that was just sent
+     * 
+     * @param seqNum Sequence number of the packet
+     * @param packet Complete packet (moved into the send window)
+     * @param currentTime Current time in milliseconds
+     * @return true if tracked, false if the send window is full
+     */
+    bool TrackReliablePacket(uint16_t seqNum, ByteBufferChain&& packet, uint32_t currentTime) {
+        if (!m_sendWindow.Insert(seqNum, std::move(packet), currentTime)) {
+            return false;
+        }
+        ++m_reliableSent;
+        return true;
+    }
+    
+    /**
+     * @brief Resend lost packets
+     * 
+     * Walks the send window oldest first and retransmits only the packets
+     * that are missing: those whose last transmission is older than this
+     * connection's RTO, and those the client's selective acks have
+     * already skipped over. A timeout backs the RTO off and halves the
+     * bandwidth budget, once per pass.
+     * 
+     * @param currentTime Current time in milliseconds
      */
-    void ResendUnacknowledgedPackets();
+    void ResendUnacknowledgedPackets(uint32_t currentTime) {
+        bool timedOut = false;
+        m_sendWindow.ForEachLost(currentTime, m_rtt.GetRto(),
+            [this, currentTime, &timedOut](SendWindow<SEND_WINDOW_SIZE>::Entry& entry, bool expired) {
+                SendRawData(entry.packet);
+                entry.sentTime = currentTime;
+                ++entry.sendCount;
+                ++m_retransmits;
+                timedOut = timedOut || expired;
+            });
+        if (timedOut) {
+            m_rtt.OnTimeout();
+            m_sendScheduler.OnCongestion();
+        }
+    }
     
     /**
      * @brief Check for timeout
@@ -405,14 +909,66 @@ private:
     uint16_t m_lastAcknowledged;
     
     /**
-     * @brief Unacknowledged packets map (sequence number to packet data)
+     * @brief Receive history length
      */
-    std::map<uint16_t, ByteBuffer> m_unacknowledgedPackets;
+    static const size_t RELIABILITY_WINDOW_SIZE = 256;
     
     /**
-     * @brief Received packet history (sequence numbers)
+     * @brief Send window ring size; the span in flight is capped at ACK_SEQUENCE_COVERAGE
      */
-    std::deque<uint16_t> m_receivedPackets;
+    static const size_t SEND_WINDOW_SIZE = 64;
+    
+    /**
+     * @brief Unacknowledged reliable packets, indexed by sequence number
+     */
+    SendWindow<SEND_WINDOW_SIZE> m_sendWindow;
+    
+    /**
+     * @brief Packet waiting for room in the send window
+     */
+    struct HeldPacket {
+        uint16_t type;            ///< Message type
+        ByteBufferChain chain;    ///< Message blocks and payloads, without the game header
+        bool reliable;            ///< Is packet reliable
+        bool encrypted;           ///< Is packet encrypted
+        uint8_t blockCount;       ///< Number of message blocks
+        bool fragment;            ///< Chain is a fragment
+    };
+    
+    /**
+     * @brief Most reliable packets held before the client is disconnected
+     */
+    static const size_t MAX_HELD_PACKETS = 256;
+    
+    /**
+     * @brief Queue of packets waiting for room in the send window
+     */
+    typedef HeldPacketQueue<HeldPacket, MAX_HELD_PACKETS> HeldPackets;
+    
+    /**
+     * @brief Packets held by HoldPacket, oldest first
+     */
+    HeldPackets m_heldPackets;
+    
+    /**
+     * @brief Recently received reliable sequence numbers
+     */
+    ReceiveWindow<RELIABILITY_WINDOW_SIZE> m_receiveWindow;
+    
+    /**
+     * @brief Longest an acknowledgment waits for a packet to ride on (ms)
+     */
+    static const uint32_t ACK_DELAY = 33;
+    
+    /**
+     * @brief A received reliable packet has not been acknowledged yet
+     */
+    bool m_ackPending = false;
+    
+    /**
+     * @brief Time the pending acknowledgment became due
+     */
+    uint32_t m_ackPendingSince = 0;
     
     /**
      * @brief Protocol version
@@ -440,10 +996,62 @@ private:
     uint32_t m_pingInterval;
     
     /**
-     * @brief Resend interval in milliseconds
+     * @brief Initial resend interval in milliseconds (RTO before the first RTT sample)
      */
     uint32_t m_resendInterval;
     
+    /**
+     * @brief Round-trip estimator and retransmission timer
+     */
+    RttEstimator m_rtt;
+    
+    /**
+     * @brief Bandwidth budget and priority send queues
+     */
+    SendScheduler m_sendScheduler{65536, 8192, 16384, GAME_HEADER_SIZE + ACK_BITS_SIZE};
+    
+    /**
+     * @brief Packs this tick's message blocks into MTU-sized packets
+     */
+    PacketAggregator m_aggregator;
+    
+    /**
+     * @brief Reassembly of incoming fragmented messages
+     * 
+     * Update calls Expire on it to drop messages with missing fragments.
+     */
+    FragmentAssembler m_fragmentAssembler;
+    
+    /**
+     * @brief Message ID of the next outgoing fragmented message
+     */
+    uint16_t m_nextFragmentId = 0;
+    
+    /**
+     * @brief Payload compression (disabled unless the client supports it)
+     */
+    PacketCompressor m_compressor;
+    
+    /**
+     * @brief Per-object baselines for delta-encoded updates
+     */
+    DeltaTracker m_deltaTracker;
+    
+    /**
+     * @brief Quantized location encoding for the player's district
+     */
+    LocationCodec m_locationCodec;
+    
+    /**
+     * @brief Reliable packets sent (first transmissions)
+     */
+    uint64_t m_reliableSent = 0;
+    
+    /**
+     * @brief Reliable packets retransmitted
+     */
+    uint64_t m_retransmits = 0;
+    
     /**
      * @brief Last resend time
      */
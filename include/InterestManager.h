@@ -0,0 +1,180 @@
+#ifndef _INTEREST_MANAGER_H_
+#define _INTEREST_MANAGER_H_
+
+#include "LocationVector.h"
+#include "SpatialHashGrid.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+class WorldManager;
+
+/**
+ * @brief Area-of-interest management
+ * 
+ * Keeps, for every player (observer), the set of objects and other
+ * players it can see, and for every object the observers that see it.
+ * An object enters a player's view within the enter range and only
+ * leaves it beyond the larger leave range, so objects moving along the
+ * edge do not flap between create and destroy.
+ * 
+ * World objects are found through ObjectStore::CollectInRange, which
+ * scans only the observer's district, and WorldManager::GetObject;
+ * players are indexed here in a SpatialHashGrid of leave-range sized
+ * cells per district, since they are not world objects. Visible sets are
+ * recomputed by Update, and the transitions are reported through
+ * callbacks that send the object create and destroy messages. Updates
+ * for an object then go only to GetObservers(objectId) instead of the
+ * whole district.
+ * 
+ * Used from the simulation thread only.
+ */
+class InterestManager {
+public:
+    /**
+     * @brief View transition callback
+     * 
+     * Called with the observer's player ID and the object ID that
+     * entered or left its view. Must not call back into the manager.
+     */
+    typedef std::function<void(uint32_t, uint32_t)> TransitionCallback;
+
+    /**
+     * @brief Interest statistics
+     */
+    struct Stats {
+        uint64_t enters;          ///< Objects that entered a view
+        uint64_t leaves;          ///< Objects that left a view
+        uint64_t candidates;      ///< Objects tested by the last Update
+        uint32_t observers;       ///< Observers tracked
+        uint32_t visiblePairs;    ///< Observer/object pairs currently visible
+    };
+
+    /**
+     * @brief Constructor
+     * 
+     * @param enterRange Distance at which objects enter view
+     * @param leaveRange Distance beyond which objects leave view (at least enterRange)
+     */
+    InterestManager(float enterRange = 100.0f, float leaveRange = 120.0f);
+
+    /**
+     * @brief Change the view ranges
+     * 
+     * Takes effect on the next Update.
+     * 
+     * @param enterRange Distance at which objects enter view
+     * @param leaveRange Distance beyond which objects leave view (at least enterRange)
+     */
+    void SetRanges(float enterRange, float leaveRange);
+
+    /**
+     * @brief Start tracking a player
+     * 
+     * @param playerId Player ID (observer)
+     * @param objectId The player's own object ID, visible to other players
+     * @param position Position
+     * @param district District
+     */
+    void AddObserver(uint32_t playerId, uint32_t objectId, const LocationVector& position, uint8_t district);
+
+    /**
+     * @brief Move a player
+     * 
+     * Visible sets change on the next Update.
+     * 
+     * @param playerId Player ID
+     * @param position New position
+     * @param district New district
+     */
+    void MoveObserver(uint32_t playerId, const LocationVector& position, uint8_t district);
+
+    /**
+     * @brief Stop tracking a player
+     * 
+     * The player's own object leaves the view of everyone who saw it.
+     * 
+     * @param playerId Player ID
+     * @param onLeave Called for every observer that saw the player
+     */
+    void RemoveObserver(uint32_t playerId, const TransitionCallback& onLeave);
+
+    /**
+     * @brief Remove a destroyed world object from every view
+     * 
+     * @param objectId Object ID
+     * @param onLeave Called for every observer that saw the object
+     */
+    void RemoveObject(uint32_t objectId, const TransitionCallback& onLeave);
+
+    /**
+     * @brief Recompute every observer's visible set
+     * 
+     * @param world World manager to query for objects in range
+     * @param onEnter Called for every object that entered a view
+     * @param onLeave Called for every object that left a view
+     */
+    void Update(WorldManager& world, const TransitionCallback& onEnter, const TransitionCallback& onLeave);
+
+    /**
+     * @brief Collect the observers of an object
+     * 
+     * @param objectId Object ID
+     * @param observers Vector to append the observers' player IDs to
+     */
+    void GetObservers(uint32_t objectId, std::vector<uint32_t>& observers) const;
+
+    /**
+     * @brief Check if an observer sees an object
+     * 
+     * @param playerId Observer's player ID
+     * @param objectId Object ID
+     * @return true if the object is in the observer's view
+     */
+    bool IsVisible(uint32_t playerId, uint32_t objectId) const;
+
+    /**
+     * @brief Get the objects an observer sees
+     * 
+     * @param playerId Observer's player ID
+     * @return Visible object IDs, or nullptr if the player is not tracked
+     */
+    const std::unordered_set<uint32_t>* GetVisibleSet(uint32_t playerId) const;
+
+    /**
+     * @brief Get interest statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const;
+
+private:
+    /**
+     * @brief Tracked player
+     */
+    struct Observer {
+        uint32_t objectId;                    ///< The player's own object ID
+        LocationVector position;              ///< Position
+        uint8_t district;                     ///< District
+        std::unordered_set<uint32_t> visible; ///< Objects in view
+    };
+
+    /**
+     * @brief Get the player grid of a district, creating it if needed
+     */
+    SpatialHashGrid& GetGrid(uint8_t district);
+
+    std::unordered_map<uint32_t, Observer> m_observers;                          ///< Players by player ID
+    std::unordered_map<uint8_t, SpatialHashGrid> m_grids;                        ///< Players by district
+    std::unordered_map<uint32_t, std::unordered_set<uint32_t>> m_observedBy;     ///< Object ID to observers
+    std::vector<uint32_t> m_candidates;                                          ///< Scratch list for Update
+    std::vector<uint32_t> m_entered;                                             ///< Scratch list for Update
+    std::vector<uint32_t> m_left;                                                ///< Scratch list for Update
+    float m_enterRange;                                                          ///< Enter distance
+    float m_leaveRange;                                                          ///< Leave distance and grid cell size
+    Stats m_stats;                                                               ///< Statistics
+};
+
+#endif // _INTEREST_MANAGER_H_
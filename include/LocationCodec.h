@@ -0,0 +1,221 @@
+#ifndef _LOCATION_CODEC_H_
+#define _LOCATION_CODEC_H_
+
+#include "LocationVector.h"
+#include "ByteBuffer.h"
+#include "ByteView.h"
+#include <cstdint>
+
+/**
+ * @brief Quantized location on the wire
+ */
+struct QuantizedLocation {
+    uint32_t x, y, z;     ///< Fixed-point position relative to the district minimum
+    uint32_t o;           ///< Orientation in 1/2^bits of a full turn
+
+    bool operator==(const QuantizedLocation& other) const {
+        return x == other.x && y == other.y && z == other.z && o == other.o;
+    }
+
+    bool operator!=(const QuantizedLocation& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Quantized wire encoding of LocationVector
+ * 
+ * Positions are stored as fixed point relative to the district's
+ * bounding box, with the same number of bits on every axis, and the
+ * orientation as a fraction of a full turn. Positions outside the box
+ * are clamped. A location is packed into ceil((3 * positionBits +
+ * orientationBits) / 8) bytes, e.g. 9 bytes for 20 and 10 bits,
+ * instead of four doubles.
+ * 
+ * Quantization is exact on round trip: decoding a packed location and
+ * encoding it again gives the same bits, and Round() returns the
+ * location the peer will see, which is what the server should keep for
+ * anything it compares against the client.
+ */
+class LocationCodec {
+public:
+    /**
+     * @brief Most bits per position axis
+     */
+    static const uint8_t MAX_POSITION_BITS = 24;
+
+    /**
+     * @brief Most bits for the orientation
+     */
+    static const uint8_t MAX_ORIENTATION_BITS = 16;
+
+    /**
+     * @brief Constructor
+     * 
+     * @param boundsMin District minimum corner
+     * @param boundsMax District maximum corner
+     * @param positionBits Bits per position axis (1 to MAX_POSITION_BITS)
+     * @param orientationBits Orientation bits (1 to MAX_ORIENTATION_BITS)
+     */
+    LocationCodec(const LocationVector& boundsMin = LocationVector(-32768.0, -32768.0, -32768.0),
+                  const LocationVector& boundsMax = LocationVector(32768.0, 32768.0, 32768.0),
+                  uint8_t positionBits = 20, uint8_t orientationBits = 10);
+
+    /**
+     * @brief Quantize a location
+     * 
+     * @param location Location to quantize
+     * @return Quantized location
+     */
+    QuantizedLocation Quantize(const LocationVector& location) const;
+
+    /**
+     * @brief Convert a quantized location back
+     * 
+     * @param quantized Quantized location
+     * @return Location the quantized values stand for
+     */
+    LocationVector Dequantize(const QuantizedLocation& quantized) const;
+
+    /**
+     * @brief Get the location the peer sees for a location
+     * 
+     * @param location Location to round
+     * @return Location after a round trip through the codec
+     */
+    LocationVector Round(const LocationVector& location) const { return Dequantize(Quantize(location)); }
+
+    /**
+     * @brief Write a quantized location
+     * 
+     * @param quantized Quantized location
+     * @param buffer Buffer to write to (GetEncodedSize() bytes)
+     */
+    void Write(const QuantizedLocation& quantized, ByteBuffer& buffer) const;
+
+    /**
+     * @brief Write a location
+     * 
+     * @param location Location to write
+     * @param buffer Buffer to write to (GetEncodedSize() bytes)
+     */
+    void Write(const LocationVector& location, ByteBuffer& buffer) const { Write(Quantize(location), buffer); }
+
+    /**
+     * @brief Write only the position of a quantized location
+     * 
+     * @param quantized Quantized location
+     * @param buffer Buffer to write to (GetPositionSize() bytes)
+     */
+    void WritePosition(const QuantizedLocation& quantized, ByteBuffer& buffer) const;
+
+    /**
+     * @brief Write only the orientation of a quantized location
+     * 
+     * @param quantized Quantized location
+     * @param buffer Buffer to write to (GetOrientationSize() bytes)
+     */
+    void WriteOrientation(const QuantizedLocation& quantized, ByteBuffer& buffer) const;
+
+    /**
+     * @brief Read a quantized location
+     * 
+     * @param data Data positioned at the location; consumed
+     * @param quantized Receives the quantized location
+     * @return true on success, false if truncated
+     */
+    bool Read(ByteView& data, QuantizedLocation& quantized) const;
+
+    /**
+     * @brief Read a location
+     * 
+     * @param data Data positioned at the location; consumed
+     * @param location Receives the location
+     * @return true on success, false if truncated
+     */
+    bool Read(ByteView& data, LocationVector& location) const;
+
+    /**
+     * @brief Read a position written by WritePosition
+     * 
+     * @param data Data positioned at the position; consumed
+     * @param quantized Receives x, y and z
+     * @return true on success, false if truncated
+     */
+    bool ReadPosition(ByteView& data, QuantizedLocation& quantized) const;
+
+    /**
+     * @brief Read an orientation written by WriteOrientation
+     * 
+     * @param data Data positioned at the orientation; consumed
+     * @param quantized Receives o
+     * @return true on success, false if truncated or out of range
+     */
+    bool ReadOrientation(ByteView& data, QuantizedLocation& quantized) const;
+
+    /**
+     * @brief Get the packed size of a location
+     * 
+     * @return Size in bytes
+     */
+    size_t GetEncodedSize() const { return (3 * m_positionBits + m_orientationBits + 7) / 8; }
+
+    /**
+     * @brief Get the packed size of a position
+     * 
+     * @return Size in bytes
+     */
+    size_t GetPositionSize() const { return (3 * m_positionBits + 7) / 8; }
+
+    /**
+     * @brief Get the packed size of an orientation
+     * 
+     * @return Size in bytes
+     */
+    size_t GetOrientationSize() const { return (m_orientationBits + 7) / 8; }
+
+    /**
+     * @brief Get the position step
+     * 
+     * @return Largest per-axis step in world units (the error is at most half of it)
+     */
+    double GetPositionStep() const;
+
+    /**
+     * @brief Get the bits per position axis
+     * 
+     * @return Bits per axis
+     */
+    uint8_t GetPositionBits() const { return m_positionBits; }
+
+    /**
+     * @brief Get the orientation bits
+     * 
+     * @return Orientation bits
+     */
+    uint8_t GetOrientationBits() const { return m_orientationBits; }
+
+private:
+    /**
+     * @brief Quantize one value to [0, maxValue]
+     */
+    static uint32_t QuantizeAxis(double value, double min, double scale, uint32_t maxValue);
+
+    /**
+     * @brief Pack values of the given widths into a little-endian bit stream
+     */
+    static void PackBits(const uint32_t* values, const uint8_t* widths, size_t count, ByteBuffer& buffer);
+
+    /**
+     * @brief Unpack values written by PackBits
+     */
+    static bool UnpackBits(ByteView& data, uint32_t* const* values, const uint8_t* widths, size_t count);
+
+    double m_min[3];              ///< Minimum corner
+    double m_step[3];             ///< World units per step
+    double m_scale[3];            ///< Steps per world unit
+    uint32_t m_maxPosition;       ///< Largest position value
+    uint32_t m_orientationSteps;  ///< Orientation steps per turn
+    uint8_t m_positionBits;       ///< Bits per position axis
+    uint8_t m_orientationBits;    ///< Orientation bits
+};
+
+#endif // _LOCATION_CODEC_H_
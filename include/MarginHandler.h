@@ -1,14 +1,15 @@
 #ifndef _MARGIN_HANDLER_H_
 #define _MARGIN_HANDLER_H_
 
-#include <Sockets/SocketHandler.h>
+#include "PolledSocketHandler.h"
+#include <string>
 
 /**
  * @brief Margin socket handler
  * 
  * MarginHandler manages margin socket connections and events.
  */
-class MarginHandler : public SocketHandler {
+class MarginHandler : public PolledSocketHandler {
 public:
     /**
      * @brief Default constructor
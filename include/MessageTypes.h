@@ -35,8 +35,32 @@ public:
      * @return Message type identifier
      */
     virtual uint16_t GetType() const = 0;
+    
+    /**
+     * @brief Get the serialized size of the message
+     * 
+     * Used to reserve the output buffer before Serialize is called.
+     * 
+     * @return Size in bytes, or 0 if unknown
+     */
+    virtual size_t GetSerializedSize() const { return 0; }
 };
 
+/**
+ * @brief Serialize a message into a buffer sized up front
+ * 
+ * Only reserves capacity for the size hint: growing the size would leave
+ * uninitialised bytes past the write position whenever the hint is an
+ * over-estimate, and append(const ByteBuffer&) copies size() bytes.
+ * 
+ * @param message Message to serialize
+ * @param buffer ByteBuffer to serialize to
+ */
+inline void SerializeMessage(const MessageBase& message, ByteBuffer& buffer) {
+    buffer.reserve(buffer.wpos() + message.GetSerializedSize());
+    message.Serialize(buffer);
+}
+
 /**
  * @brief Shared pointer type for message objects
  */
@@ -293,7 +317,39 @@ enum PacketFlags {
     PACKET_FLAG_RELIABLE          = 0x01,
     PACKET_FLAG_ENCRYPTED         = 0x02,
     PACKET_FLAG_COMPRESSED        = 0x04,
-    PACKET_FLAG_FRAGMENT          = 0x08
+    PACKET_FLAG_FRAGMENT          = 0x08,
+    PACKET_FLAG_ACK_BITS          = 0x10   ///< Selective ack bitfield follows the block count
 };
 
+/**
+ * @brief Packet header sizes in bytes
+ */
+enum PacketHeaderSizes {
+    COMMON_HEADER_SIZE            = 8,   ///< Magic, version, type, length
+    GAME_HEADER_SIZE              = 14,  ///< Common header + sequence, ack, flags, block count
+    BLOCK_HEADER_SIZE             = 4,   ///< Block type and block length
+    ACK_BITS_SIZE                 = 4    ///< Selective ack bitfield (PACKET_FLAG_ACK_BITS)
+};
+
+/**
+ * @brief Largest message block data, bounded by the 16-bit block length
+ */
+const size_t MAX_BLOCK_DATA_SIZE = 0xFFFF;
+
+/**
+ * @brief Write the length of a message block serialized with a zero length
+ * 
+ * @param block Block starting with its header (type, length), data written up to wpos
+ * @return true if written, false if the data is longer than MAX_BLOCK_DATA_SIZE and the block must not be sent
+ */
+inline bool PatchBlockLength(ByteBuffer& block) {
+    size_t length = block.wpos() - BLOCK_HEADER_SIZE;
+    if (length > MAX_BLOCK_DATA_SIZE) {
+        return false;
+    }
+    
+    block.writeAt<uint16_t>(2, uint16_t(length));
+    return true;
+}
+
 #endif // _MESSAGE_TYPES_H_
\ No newline at end of file
@@ -0,0 +1,247 @@
+#ifndef _OBJECT_DELTA_H_
+#define _OBJECT_DELTA_H_
+
+#include "ByteBuffer.h"
+#include "ByteView.h"
+#include "LocationCodec.h"
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Object fields carried by an object update
+ */
+enum ObjectDeltaFields {
+    DELTA_FIELD_POSITION          = 0x01,  ///< x, y, z (LocationCodec position)
+    DELTA_FIELD_ORIENTATION       = 0x02,  ///< o (LocationCodec orientation)
+    DELTA_FIELD_DISTRICT          = 0x04,  ///< District (uint8)
+    DELTA_FIELD_STATE_FLAGS       = 0x08,  ///< State flags (uint32)
+    DELTA_FIELD_SCALE             = 0x10,  ///< Scale (float)
+    DELTA_FIELD_VISIBLE           = 0x20,  ///< Visibility (uint8)
+    DELTA_FIELD_DATA              = 0x40,  ///< Type-specific data (uint16 length, bytes)
+    DELTA_FIELD_ALL               = 0x7F,
+    DELTA_FULL_STATE              = 0x80   ///< Every field present, no baseline needed
+};
+
+/**
+ * @brief Replicated state of a game object as a client sees it
+ * 
+ * The location is kept quantized as it goes on the wire, so comparing
+ * two states tells whether the client would see a difference; movement
+ * below the codec's precision produces no update.
+ */
+struct ObjectState {
+    QuantizedLocation location;   ///< Position and orientation
+    uint8_t district;       ///< District
+    uint32_t stateFlags;    ///< State flags
+    float scale;            ///< Scale
+    bool visible;           ///< Visibility
+    ByteBuffer data;        ///< Type-specific data, compared byte for byte
+
+    ObjectState() : district(0), stateFlags(0), scale(1.0f), visible(true) {
+        location.x = location.y = location.z = location.o = 0;
+    }
+
+    /**
+     * @brief Get the fields that differ from another state
+     * 
+     * @param other State to compare with
+     * @return Mask of ObjectDeltaFields
+     */
+    uint8_t Diff(const ObjectState& other) const;
+
+    /**
+     * @brief Write the masked fields
+     * 
+     * @param mask Fields to write (ObjectDeltaFields, DELTA_FULL_STATE allowed)
+     * @param codec Location codec of the object's district
+     * @param buffer Buffer to write to
+     */
+    void Write(uint8_t mask, const LocationCodec& codec, ByteBuffer& buffer) const;
+
+    /**
+     * @brief Apply a delta written by Write
+     * 
+     * Used by test clients; the fields not in the delta are left alone.
+     * 
+     * @param data Delta positioned at the mask; consumed
+     * @param codec Location codec of the object's district
+     * @return true on success, false if truncated
+     */
+    bool Apply(ByteView& data, const LocationCodec& codec);
+};
+
+/**
+ * @brief Per-client baselines for delta-encoded object updates
+ * 
+ * For every object in view the tracker keeps the last state the client
+ * is known to have (the baseline) and the states sent since then. An
+ * update carries every field that differs from the baseline or was in
+ * any update sent since, so it is correct whichever of those updates
+ * the client received; fields outside that set are the same in all of
+ * them. Updates are therefore plain field values, never arithmetic
+ * differences, and the client applies them unless they come from a
+ * packet older than the last one it applied for the object.
+ * 
+ * Updates are grouped in frames (one per GameServer tick). A frame is
+ * delivered once every packet sent during it is acknowledged; its
+ * states then become the baselines and the older pending states are
+ * dropped. Until an object has a baseline (it just entered view, or was
+ * forgotten) every update carries the full state, and after sustained
+ * loss the pending masks cover every field, which falls back to full
+ * state as well.
+ */
+class DeltaTracker {
+public:
+    /**
+     * @brief Delta statistics
+     */
+    struct Stats {
+        uint64_t full;        ///< Full-state updates
+        uint64_t delta;       ///< Delta updates
+        uint64_t unchanged;   ///< Updates skipped because nothing changed
+        uint64_t promoted;    ///< Baselines advanced by acknowledged frames
+    };
+
+    /**
+     * @brief Unacknowledged updates kept per object
+     */
+    static const size_t PENDING_PER_OBJECT = 8;
+
+    /**
+     * @brief Frames tracked for acknowledgment
+     */
+    static const size_t FRAME_HISTORY = 32;
+
+    /**
+     * @brief Packet sequences tracked for acknowledgment
+     */
+    static const size_t SEQUENCE_HISTORY = 256;
+
+    DeltaTracker();
+
+    /**
+     * @brief Encode an update for an object
+     * 
+     * Must be called when the update is handed to the packet aggregator,
+     * not when it is queued on the send scheduler, so that it is sent in
+     * the frame it is recorded for.
+     * 
+     * @param objectId Object ID
+     * @param state Current state
+     * @param codec Location codec of the object's district
+     * @param buffer Receives the mask and fields
+     * @return true if an update must be sent, false if the client already has this state
+     */
+    bool Encode(uint32_t objectId, const ObjectState& state, const LocationCodec& codec, ByteBuffer& buffer);
+
+    /**
+     * @brief Forget an object (it left view or was destroyed)
+     * 
+     * The next update for it carries the full state.
+     * 
+     * @param objectId Object ID
+     */
+    void Forget(uint32_t objectId);
+
+    /**
+     * @brief Record a packet sent during the current frame
+     * 
+     * @param sequence Packet sequence number
+     */
+    void OnPacketSent(uint16_t sequence);
+
+    /**
+     * @brief Process an acknowledgment from the client
+     * 
+     * @param ackNum Newest sequence received by the client
+     * @param ackBits Selective ack bitfield
+     */
+    void OnAcknowledged(uint16_t ackNum, uint32_t ackBits);
+
+    /**
+     * @brief Close the current frame
+     * 
+     * Called once per tick after the connection's packets are flushed.
+     */
+    void EndFrame();
+
+    /**
+     * @brief Forget every object
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of objects tracked
+     * 
+     * @return Number of objects
+     */
+    size_t GetObjectCount() const { return m_objects.size(); }
+
+    /**
+     * @brief Get delta statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const { stats = m_stats; }
+
+private:
+    /**
+     * @brief Update sent but not yet known to be delivered
+     */
+    struct PendingState {
+        uint32_t frame;       ///< Frame it was sent in
+        uint8_t mask;         ///< Fields it carried
+        ObjectState state;    ///< State it carried
+    };
+
+    /**
+     * @brief Baseline and pending updates of one object
+     */
+    struct ObjectBaseline {
+        ObjectState baseline;                         ///< State the client is known to have
+        bool hasBaseline;                             ///< Baseline is valid
+        PendingState pending[PENDING_PER_OBJECT];     ///< Pending updates, oldest first
+        size_t pendingCount;                          ///< Number of pending updates
+        uint8_t droppedMask;                          ///< Fields of pending updates dropped on overflow
+
+        ObjectBaseline() : hasBaseline(false), pendingCount(0), droppedMask(0) {}
+    };
+
+    /**
+     * @brief Acknowledgment tracking of one frame
+     */
+    struct Frame {
+        uint32_t id;                      ///< Frame number
+        uint32_t packets;                 ///< Packets sent during the frame
+        uint32_t acked;                   ///< Packets acknowledged
+        std::vector<uint32_t> objects;    ///< Objects updated during the frame
+    };
+
+    /**
+     * @brief Packet sent during a frame
+     */
+    struct SentPacket {
+        uint16_t sequence;    ///< Sequence number
+        uint32_t frame;       ///< Frame it was sent in
+        bool valid;           ///< Waiting for acknowledgment
+    };
+
+    /**
+     * @brief Acknowledge one packet sequence
+     */
+    void Acknowledge(uint16_t sequence);
+
+    /**
+     * @brief Make a delivered frame's states the baselines
+     */
+    void Promote(Frame& frame);
+
+    std::unordered_map<uint32_t, ObjectBaseline> m_objects;   ///< Baselines by object ID
+    Frame m_frames[FRAME_HISTORY];                            ///< Frames by id % FRAME_HISTORY
+    SentPacket m_packets[SEQUENCE_HISTORY];                   ///< Packets by sequence % SEQUENCE_HISTORY
+    uint32_t m_frame;                                         ///< Current frame number
+    Stats m_stats;                                            ///< Statistics
+};
+
+#endif // _OBJECT_DELTA_H_
@@ -0,0 +1,454 @@
+#ifndef _OBJECT_STORE_H_
+#define _OBJECT_STORE_H_
+
+#include "LocationVector.h"
+#include "SpatialKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Structure-of-arrays store for the hot fields of game objects
+ * 
+ * Every GameObject owns a slot here holding its position, orientation,
+ * district, state flags, type and visibility; the GameObject accessors
+ * read and write through the slot. The fields live in parallel arrays,
+ * so scans over positions or districts walk contiguous memory instead
+ * of chasing object pointers through names, property maps and mutexes.
+ * 
+ * Slots are grouped in chunks of CHUNK_SIZE that are never moved or
+ * freed, so a slot's fields stay where they are for the life of the
+ * server and can be read without a lock, exactly like the members they
+ * replace. Allocating and freeing slots is locked; freed slots are
+ * reused.
+ * 
+ * Each district also keeps a uniform grid over the horizontal plane:
+ * square cells of GetCellSize() world units, hashed by cell coordinates
+ * into CELL_BUCKETS buckets. Every bucket is a dense list of its slots,
+ * with every slot storing its bucket and its own index in it (as
+ * DistrictMembers does for the world), and a copy of every slot's
+ * position and type next to it. Collect and FindNearest therefore only
+ * visit the buckets of the cells around the query and run the kernels
+ * straight over the lists. The grid is derived from the store's own
+ * positions: SetLocation writes both copies and moves the slot to
+ * another bucket when it crosses into a cell that hashes elsewhere, so
+ * GameObject::SetPosition and SetDistrict keep it current by themselves.
+ * 
+ * Lists are updated under the same lock when a slot is allocated,
+ * freed, changes district or changes bucket, and are read without one:
+ * their segments are never moved or freed either, and a hit is checked
+ * against the slot's own fields, so a scan racing a move at worst
+ * misses the object being moved, like a scan racing a position update.
+ * A slot's position is written by one thread at a time.
+ * 
+ * Positions are stored as floats, which is well below the quantized
+ * wire precision (LocationCodec) across a district.
+ */
+class ObjectStore {
+public:
+    /**
+     * @brief log2 of the slots per chunk
+     */
+    static const uint32_t CHUNK_BITS = 12;
+
+    /**
+     * @brief Slots per chunk
+     */
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    /**
+     * @brief Most chunks (CHUNK_SIZE * MAX_CHUNKS objects)
+     */
+    static const uint32_t MAX_CHUNKS = 1024;
+
+    /**
+     * @brief Grid buckets per district
+     */
+    static const uint32_t CELL_BUCKETS = 4096;
+
+    /**
+     * @brief Hot fields of CHUNK_SIZE slots, one array per field
+     */
+    struct Chunk {
+        float x[CHUNK_SIZE];              ///< Position X
+        float y[CHUNK_SIZE];              ///< Position Y
+        float z[CHUNK_SIZE];              ///< Position Z
+        float o[CHUNK_SIZE];              ///< Orientation in radians
+        uint32_t objectId[CHUNK_SIZE];    ///< Object ID
+        uint32_t stateFlags[CHUNK_SIZE];  ///< State flags
+        uint16_t objectType[CHUNK_SIZE];  ///< Object type (see ObjectTypes enum)
+        uint8_t district[CHUNK_SIZE];     ///< District ID, changed through SetDistrict
+        uint8_t visible[CHUNK_SIZE];      ///< Visibility flag
+        uint8_t inUse[CHUNK_SIZE];        ///< Slot belongs to a live object
+        uint16_t bucket[CHUNK_SIZE];      ///< Grid bucket of the slot's cell, changed under the store lock
+        uint32_t bucketIndex[CHUNK_SIZE]; ///< Index in the bucket's slot list, changed under the store lock
+    };
+
+    /**
+     * @brief Get the store
+     * 
+     * The store is never destroyed, so objects released during static
+     * destruction can still free their slots.
+     * 
+     * @return The store
+     */
+    static ObjectStore& getSingleton();
+
+    /**
+     * @brief Allocate a slot
+     * 
+     * The slot starts at the origin, in district 0, visible, with no
+     * state flags. Running out of slots is treated like running out of
+     * memory and throws std::bad_alloc.
+     * 
+     * @param objectId Object ID
+     * @param objectType Object type
+     * @return Slot
+     */
+    uint32_t Allocate(uint32_t objectId, uint16_t objectType);
+
+    /**
+     * @brief Free a slot
+     * 
+     * @param slot Slot returned by Allocate
+     */
+    void Free(uint32_t slot);
+
+    /**
+     * @brief Get the chunk holding a slot
+     * 
+     * @param slot Slot
+     * @return Chunk
+     */
+    Chunk& GetChunk(uint32_t slot) { return *m_chunks[slot >> CHUNK_BITS]; }
+    const Chunk& GetChunk(uint32_t slot) const { return *m_chunks[slot >> CHUNK_BITS]; }
+
+    /**
+     * @brief Get the index of a slot within its chunk
+     * 
+     * @param slot Slot
+     * @return Index
+     */
+    static uint32_t GetIndex(uint32_t slot) { return slot & (CHUNK_SIZE - 1); }
+
+    /**
+     * @brief Get the position and orientation of a slot
+     * 
+     * @param slot Slot
+     * @return Location
+     */
+    LocationVector GetLocation(uint32_t slot) const {
+        const Chunk& chunk = GetChunk(slot);
+        uint32_t i = GetIndex(slot);
+        return LocationVector(chunk.x[i], chunk.y[i], chunk.z[i], chunk.o[i]);
+    }
+
+    /**
+     * @brief Set the position and orientation of a slot
+     * 
+     * Also updates the position copy in the grid. Only takes the lock
+     * when the slot changes bucket, or was moved within its bucket's
+     * list meanwhile.
+     * 
+     * @param slot Slot
+     * @param location Location
+     */
+    void SetLocation(uint32_t slot, const LocationVector& location);
+
+    /**
+     * @brief Move a slot to another district
+     * 
+     * @param slot Slot
+     * @param districtId District ID
+     */
+    void SetDistrict(uint32_t slot, uint8_t districtId);
+
+    /**
+     * @brief Set the grid cell size
+     * 
+     * Only possible while the store holds no objects, i.e. at startup
+     * (WorldManager::Initialize, World.GridCellSize). About the most
+     * common query range works best; the default is 100 world units.
+     * 
+     * @param cellSize Cell edge length in world units
+     * @return true if set, false if the size is invalid or objects exist
+     */
+    bool SetCellSize(float cellSize);
+
+    /**
+     * @brief Get the grid cell size
+     * 
+     * @return Cell edge length in world units
+     */
+    float GetCellSize() const { return float(m_cellSize); }
+
+    /**
+     * @brief Get the number of slots in a district
+     * 
+     * @param districtId District ID
+     * @return Number of slots in the district's grid
+     */
+    uint32_t GetDistrictSlotCount(uint8_t districtId) const;
+
+    /**
+     * @brief Get the number of slots ever used
+     * 
+     * Scans cover slots [0, GetSlotCount()); slots that are not in use
+     * have inUse cleared.
+     * 
+     * @return Number of slots
+     */
+    uint32_t GetSlotCount() const { return m_slotCount.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the number of live objects
+     * 
+     * @return Number of objects
+     */
+    uint32_t GetObjectCount() const;
+
+    /**
+     * @brief Collect the objects inside a query shape
+     * 
+     * Runs SpatialKernels over the bucket lists of the district's cells
+     * that the query's bounding square overlaps, in runs of 64, then
+     * checks the hits against their slots and filters them by
+     * visibility. A query covering more cells than there are buckets
+     * scans every bucket of the district. Objects of other districts are
+     * never visited.
+     * 
+     * @param query Query
+     * @param districtId District ID
+     * @param visibleOnly Skip objects that are not visible
+     * @param objectIds Vector to append the object IDs to
+     * @return Number of object IDs appended
+     */
+    size_t Collect(const SpatialQuery& query, uint8_t districtId, bool visibleOnly, std::vector<uint32_t>& objectIds) const;
+
+    /**
+     * @brief Collect the objects in range of a position
+     * 
+     * Returns exactly the objects a LocationVector::DistanceSq test of
+     * their positions accepts: the float kernels run with the range
+     * widened by a few float steps of the coordinates, so they cannot
+     * drop such an object, and the hits are then tested in double.
+     * 
+     * @param center Center position
+     * @param range Range in world units
+     * @param districtId District ID
+     * @param visibleOnly Skip objects that are not visible
+     * @param objectIds Vector to append the object IDs to
+     * @return Number of object IDs appended
+     */
+    size_t CollectInRange(const LocationVector& center, float range, uint8_t districtId, bool visibleOnly, std::vector<uint32_t>& objectIds) const;
+
+    /**
+     * @brief Find the nearest objects of a type
+     * 
+     * Visits the district's buckets in rings of cells outwards from the
+     * center, testing only the entries of the requested type, and stops
+     * as soon as no unvisited cell can hold anything closer. Once count
+     * objects are found the search radius shrinks to the farthest.
+     * 
+     * @param center Center position
+     * @param maxRange Maximum distance
+     * @param districtId District ID
+     * @param objectType Object type to find
+     * @param visibleOnly Skip objects that are not visible
+     * @param count Most objects to find
+     * @param objectIds Vector to append the object IDs to, nearest first
+     * @return Number of object IDs appended
+     */
+    size_t FindNearest(const LocationVector& center, float maxRange, uint8_t districtId, uint16_t objectType, bool visibleOnly, size_t count, std::vector<uint32_t>& objectIds) const;
+
+private:
+    /**
+     * @brief Most districts (district IDs are 8 bits)
+     */
+    static const uint32_t MAX_DISTRICTS = 256;
+
+    /**
+     * @brief Entries in the first segment of a bucket list
+     */
+    static const uint32_t SEGMENT_BASE = 64;
+
+    /**
+     * @brief Segments per bucket list, enough for every slot
+     */
+    static const uint32_t MAX_SEGMENTS = 17;
+
+    /**
+     * @brief Entries of one segment of a bucket list, one array per field
+     */
+    struct Segment {
+        std::unique_ptr<uint32_t[]> slot;        ///< Slot
+        std::unique_ptr<float[]> x;              ///< Copy of the slot's position X
+        std::unique_ptr<float[]> y;              ///< Copy of the slot's position Y
+        std::unique_ptr<float[]> z;              ///< Copy of the slot's position Z
+        std::unique_ptr<uint16_t[]> objectType;  ///< Copy of the slot's type
+
+        explicit Segment(uint32_t size)
+            : slot(new uint32_t[size]), x(new float[size]), y(new float[size]), z(new float[size]), objectType(new uint16_t[size]) {}
+    };
+
+    /**
+     * @brief Dense list of the slots of one grid bucket
+     * 
+     * Segment k holds SEGMENT_BASE << k entries, so a run of
+     * SEGMENT_BASE entries starting at a multiple of SEGMENT_BASE never
+     * straddles two. Segments are allocated on demand and kept, so
+     * readers can walk [0, count) without a lock.
+     */
+    struct BucketList {
+        std::unique_ptr<Segment> segments[MAX_SEGMENTS];  ///< Entries, allocated on demand
+        std::atomic<uint32_t> count;                      ///< Number of slots in the list
+
+        BucketList() : count(0) {}
+    };
+
+    /**
+     * @brief Grid of one district
+     */
+    struct DistrictGrid {
+        std::atomic<BucketList*> buckets[CELL_BUCKETS];   ///< Bucket lists, allocated on demand and never freed
+        std::atomic<uint32_t> count;                      ///< Number of slots in the district
+
+        DistrictGrid() : count(0) {
+            for (uint32_t i = 0; i < CELL_BUCKETS; ++i) {
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief Find an entry of a bucket list
+     * 
+     * @param index Index in the list
+     * @param segment Receives the segment
+     * @param offset Receives the index within the segment
+     */
+    static void Locate(uint32_t index, uint32_t& segment, uint32_t& offset) {
+        uint32_t blocks = index / SEGMENT_BASE + 1;
+        segment = 0;
+        while (blocks >> (segment + 1)) {
+            ++segment;
+        }
+        offset = index - ((1u << segment) - 1) * SEGMENT_BASE;
+    }
+
+    /**
+     * @brief Get the cell coordinate of a world coordinate
+     */
+    int32_t GetCellCoord(double value) const {
+        double cell = std::floor(value * m_inverseCellSize);
+        return int32_t(std::max(-2147483647.0, std::min(2147483647.0, cell)));
+    }
+
+    /**
+     * @brief Get the bucket of a cell
+     */
+    static uint32_t GetBucket(int64_t cellX, int64_t cellY) {
+        return ((uint32_t(cellX) * 73856093u) ^ (uint32_t(cellY) * 19349663u)) & (CELL_BUCKETS - 1);
+    }
+
+    /**
+     * @brief Get the bucket a slot belongs in by its position
+     */
+    uint32_t GetBucket(const Chunk& chunk, uint32_t i) const {
+        return GetBucket(GetCellCoord(chunk.x[i]), GetCellCoord(chunk.y[i]));
+    }
+
+    /**
+     * @brief Range a hit is tested against in double instead of with the query
+     */
+    struct ExactRange {
+        LocationVector center;  ///< Center position
+        double rangeSq;         ///< Squared range
+    };
+
+    /**
+     * @brief Collect the objects inside a query shape
+     * 
+     * @param exact If set, hits are tested against it instead of the query
+     */
+    size_t Collect(const SpatialQuery& query, uint8_t districtId, bool visibleOnly, const ExactRange* exact, std::vector<uint32_t>& objectIds) const;
+
+    /**
+     * @brief Run a query over one bucket list
+     */
+    void CollectBucket(const SpatialQuery& query, uint8_t districtId, uint32_t bucket, const BucketList& list, bool visibleOnly, const ExactRange* exact, std::vector<uint32_t>& objectIds) const;
+
+    ObjectStore();
+    ObjectStore(const ObjectStore&) = delete;
+    ObjectStore& operator=(const ObjectStore&) = delete;
+
+    /**
+     * @brief Append a slot to the bucket of its district and position
+     * 
+     * Called with m_mutex held.
+     */
+    void Link(uint32_t slot);
+
+    /**
+     * @brief Copy a slot's position into its entry of the bucket list
+     */
+    void CopyToList(uint32_t slot);
+
+    /**
+     * @brief Remove a slot from its bucket list
+     * 
+     * Moves the last slot into the hole. Called with m_mutex held.
+     */
+    void Unlink(uint32_t slot);
+
+    std::unique_ptr<Chunk> m_chunks[MAX_CHUNKS];  ///< Chunks, allocated on demand
+    std::atomic<DistrictGrid*> m_districts[MAX_DISTRICTS]; ///< Grids, allocated on demand and never freed
+    std::vector<uint32_t> m_freeSlots;            ///< Freed slots, reused last in first out
+    std::atomic<uint32_t> m_slotCount;            ///< Slots ever used
+    double m_cellSize;                            ///< Grid cell edge length
+    double m_inverseCellSize;                     ///< 1 / grid cell edge length
+    mutable std::mutex m_mutex;                   ///< Guards allocation and the grids
+};
+
+/**
+ * @brief A GameObject's slot in the ObjectStore
+ * 
+ * Allocates the slot on construction and frees it on destruction.
+ */
+class ObjectSlot {
+public:
+    /**
+     * @brief Allocate a slot
+     * 
+     * @param objectId Object ID
+     * @param objectType Object type
+     */
+    ObjectSlot(uint32_t objectId, uint16_t objectType)
+        : m_slot(ObjectStore::getSingleton().Allocate(objectId, objectType)) {}
+
+    /**
+     * @brief Free the slot
+     */
+    ~ObjectSlot() { ObjectStore::getSingleton().Free(m_slot); }
+
+    /**
+     * @brief Get the slot
+     * 
+     * @return Slot
+     */
+    uint32_t Get() const { return m_slot; }
+
+private:
+    ObjectSlot(const ObjectSlot&) = delete;
+    ObjectSlot& operator=(const ObjectSlot&) = delete;
+
+    uint32_t m_slot;  ///< Slot
+};
+
+#define sObjectStore ObjectStore::getSingleton()
+
+#endif // _OBJECT_STORE_H_
@@ -0,0 +1,137 @@
+#ifndef _PACKET_AGGREGATOR_H_
+#define _PACKET_AGGREGATOR_H_
+
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include "MessageTypes.h"
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief Packs a connection's message blocks into MTU-sized game packets
+ * 
+ * Blocks queued during a tick are appended to an open packet until the
+ * next block would exceed the payload limit or the 255 block count, at
+ * which point the packet is emitted and a new one started. Reliable and
+ * unreliable blocks go into separate packets so a lost unreliable
+ * datagram never forces a resend, and reliable ones are acknowledged as
+ * a unit. Within each, a block whose encryption differs from the open
+ * packet's closes it, so every packet is either wholly encrypted or
+ * wholly plaintext. Blocks are referenced, not copied.
+ */
+class PacketAggregator {
+public:
+    /**
+     * @brief Packet callback
+     * 
+     * Called with the type of the first block, the packet's blocks, the
+     * block count and whether the packet is reliable and encrypted. The
+     * chain may be moved from.
+     */
+    typedef std::function<void(uint16_t, ByteBufferChain&, uint8_t, bool, bool)> PacketCallback;
+
+    /**
+     * @brief Aggregation statistics
+     */
+    struct Stats {
+        uint64_t blocks;      ///< Blocks queued
+        uint64_t packets;     ///< Packets emitted
+    };
+
+    /**
+     * @brief Default datagram size the packets are packed to
+     */
+    static const size_t DEFAULT_MTU = 1400;
+
+    /**
+     * @brief Constructor
+     * 
+     * @param mtu Largest datagram to produce, headers included
+     */
+    explicit PacketAggregator(size_t mtu = DEFAULT_MTU);
+
+    /**
+     * @brief Set the datagram size
+     * 
+     * @param mtu Largest datagram to produce, headers included
+     */
+    void SetMtu(size_t mtu);
+
+    /**
+     * @brief Get the block bytes that fit in one packet
+     * 
+     * @return Payload limit in bytes
+     */
+    size_t GetMaxPayload() const { return m_maxPayload; }
+
+    /**
+     * @brief Queue a shared message block
+     * 
+     * @param type Message type
+     * @param block Message block (type, length, data)
+     * @param reliable Is the block reliable
+     * @param encrypted Is the block encrypted
+     * @param emit Called for a packet that became full
+     */
+    void Add(uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, bool encrypted, const PacketCallback& emit);
+
+    /**
+     * @brief Queue an owned message block
+     * 
+     * @param type Message type
+     * @param block Message block (type, length, data)
+     * @param reliable Is the block reliable
+     * @param encrypted Is the block encrypted
+     * @param emit Called for a packet that became full
+     */
+    void Add(uint16_t type, ByteBuffer&& block, bool reliable, bool encrypted, const PacketCallback& emit);
+
+    /**
+     * @brief Emit all open packets
+     * 
+     * @param emit Called for every packet
+     * @return Number of packets emitted
+     */
+    size_t Flush(const PacketCallback& emit);
+
+    /**
+     * @brief Check if blocks are waiting for the next flush
+     * 
+     * @return true if a packet is open
+     */
+    bool HasPending() const { return m_open[0].blockCount || m_open[1].blockCount; }
+
+    /**
+     * @brief Get aggregation statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const { stats = m_stats; }
+
+private:
+    /**
+     * @brief Packet being filled
+     */
+    struct OpenPacket {
+        ByteBufferChain blocks;   ///< Blocks in the packet
+        uint16_t type;            ///< Type of the first block
+        uint8_t blockCount;       ///< Number of blocks
+        bool encrypted;           ///< Blocks are encrypted
+    };
+
+    /**
+     * @brief Make room for a block, emitting the open packet if needed
+     */
+    OpenPacket& Reserve(uint16_t type, size_t length, bool reliable, bool encrypted, const PacketCallback& emit);
+
+    /**
+     * @brief Emit an open packet
+     */
+    void Emit(OpenPacket& packet, bool reliable, const PacketCallback& emit);
+
+    OpenPacket m_open[2];     ///< Open packets (unreliable, reliable)
+    size_t m_maxPayload;      ///< Block bytes per packet
+    Stats m_stats;            ///< Statistics
+};
+
+#endif // _PACKET_AGGREGATOR_H_
@@ -0,0 +1,178 @@
+#ifndef _PACKET_COMPRESSOR_H_
+#define _PACKET_COMPRESSOR_H_
+
+#include "ByteBuffer.h"
+#include "ByteBufferChain.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifdef HAVE_ZSTD
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+#endif
+
+/**
+ * @brief Compression dictionary shared by all connections
+ * 
+ * Holds a zstd dictionary trained on captured MSG_OBJECT_CREATE and
+ * MSG_WORLD_STATE traffic. The digested forms for both directions are
+ * built once at load time and are read-only afterwards, so one instance
+ * is shared between all connections and threads.
+ */
+class CompressionDictionary {
+public:
+    typedef std::shared_ptr<const CompressionDictionary> Ptr;
+
+    ~CompressionDictionary();
+
+    /**
+     * @brief Load a dictionary file
+     * 
+     * @param path Dictionary file
+     * @param level Compression level the dictionary is digested for
+     * @return Dictionary, or null if the file is unreadable or compression is not built in
+     */
+    static Ptr Load(const std::string& path, int level);
+
+    /**
+     * @brief Train a dictionary from sample payloads
+     * 
+     * Samples should be packet payloads (message blocks after the game
+     * header) as they are sent, e.g. exported from a packet capture.
+     * 
+     * @param samples Sample payloads
+     * @param capacity Largest dictionary size in bytes (a few KB is typical)
+     * @param dictionary Receives the dictionary
+     * @return true on success
+     */
+    static bool Train(const std::vector<ByteBuffer>& samples, size_t capacity, ByteBuffer& dictionary);
+
+    /**
+     * @brief Get the dictionary size
+     * 
+     * @return Size in bytes
+     */
+    size_t GetSize() const { return m_data.size(); }
+
+private:
+    friend class PacketCompressor;
+
+    CompressionDictionary() {}
+    CompressionDictionary(const CompressionDictionary&);
+    CompressionDictionary& operator=(const CompressionDictionary&);
+
+    std::vector<uint8_t> m_data;            ///< Raw dictionary
+#ifdef HAVE_ZSTD
+    ZSTD_CDict_s* m_compress = nullptr;     ///< Digested for compression
+    ZSTD_DDict_s* m_decompress = nullptr;   ///< Digested for decompression
+#endif
+};
+
+/**
+ * @brief Compresses game packet payloads (PACKET_FLAG_COMPRESSED)
+ * 
+ * Every packet is compressed on its own, because a datagram may be lost
+ * or reordered and the peer must be able to decompress each one as it
+ * arrives. What makes small packets shrink is the shared dictionary;
+ * the zstd contexts are per thread and reused, so a connection only
+ * keeps its settings and statistics. Payloads below the threshold, and
+ * payloads that would not get smaller, are sent as they are.
+ * 
+ * Without HAVE_ZSTD the compressor is never enabled.
+ */
+class PacketCompressor {
+public:
+    /**
+     * @brief Compression statistics
+     */
+    struct Stats {
+        uint64_t packets;         ///< Packets compressed
+        uint64_t skipped;         ///< Packets over the threshold that did not shrink
+        uint64_t bytesIn;         ///< Payload bytes before compression
+        uint64_t bytesOut;        ///< Payload bytes after compression
+        uint64_t failed;          ///< Received packets that failed to decompress
+    };
+
+    /**
+     * @brief Largest payload accepted from a compressed packet
+     */
+    static const size_t MAX_DECOMPRESSED_SIZE = 64 * 1024;
+
+    /**
+     * @brief Constructor
+     * 
+     * @param threshold Smallest payload worth compressing in bytes
+     * @param level zstd compression level
+     */
+    explicit PacketCompressor(size_t threshold = 128, int level = 1);
+
+    /**
+     * @brief Check if compression is built in
+     * 
+     * @return true if built with HAVE_ZSTD
+     */
+    static bool IsAvailable();
+
+    /**
+     * @brief Enable compression with a dictionary
+     * 
+     * @param dictionary Shared dictionary (null compresses without one)
+     */
+    void Enable(const CompressionDictionary::Ptr& dictionary);
+
+    /**
+     * @brief Disable compression
+     */
+    void Disable() { m_enabled = false; m_dictionary.reset(); }
+
+    /**
+     * @brief Check if compression is enabled
+     * 
+     * @return true if outgoing payloads are compressed
+     */
+    bool IsEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Set the compression threshold
+     * 
+     * @param threshold Smallest payload worth compressing in bytes
+     */
+    void SetThreshold(size_t threshold) { m_threshold = threshold; }
+
+    /**
+     * @brief Compress a packet payload
+     * 
+     * @param payload Message blocks (or fragment) following the game header
+     * @param output Receives the compressed payload
+     * @return true if the packet should be sent compressed
+     */
+    bool Compress(const ByteBufferChain& payload, ByteBuffer& output);
+
+    /**
+     * @brief Decompress a received packet payload
+     * 
+     * @param data Compressed payload
+     * @param length Compressed length
+     * @param output Receives the payload
+     * @return true on success, false if corrupt, too large or compression is not enabled
+     */
+    bool Decompress(const byte* data, size_t length, ByteBuffer& output);
+
+    /**
+     * @brief Get compression statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const { stats = m_stats; }
+
+private:
+    CompressionDictionary::Ptr m_dictionary;  ///< Shared dictionary
+    size_t m_threshold;                       ///< Smallest payload worth compressing
+    int m_level;                              ///< Level used without a dictionary
+    bool m_enabled;                           ///< Compress outgoing payloads
+    Stats m_stats;                            ///< Statistics
+};
+
+#endif // _PACKET_COMPRESSOR_H_
@@ -3,6 +3,7 @@
 
 #include "LocationVector.h"
 #include "MessageTypes.h"
+#include "ByteView.h"
 #include <string>
 #include <queue>
 #include <list>
@@ -47,6 +48,10 @@ public:
     
     /**
      * @brief Populate the world around the character
+     * 
+     * Registers the character with the GameServer's InterestManager;
+     * the objects in view are then created by its enter transitions
+     * rather than sending the whole district.
      */
     void PopulateWorld();
 
@@ -62,14 +67,14 @@ public:
      * 
      * @param srcData The state update data
      */
-    void HandleStateUpdate(ByteBuffer &srcData);
+    void HandleStateUpdate(ByteView &srcData);
     
     /**
      * @brief Handle a command message
      * 
      * @param srcCmd The command data
      */
-    void HandleCommand(ByteBuffer &srcCmd);
+    void HandleCommand(ByteView &srcCmd);
 
     /**
      * @brief Get the character's handle (name)
@@ -251,31 +256,31 @@ public:
 
 private:
     // RPC handler type
-    typedef void (PlayerObject::*RPCHandler)(ByteBuffer &srcCmd);
+    typedef void (PlayerObject::*RPCHandler)(ByteView &srcCmd);
 
     // RPC handlers
-    void RPC_NullHandle(ByteBuffer &srcCmd);
-    void RPC_HandleReadyForSpawn(ByteBuffer &srcCmd);
-    void RPC_HandleChat(ByteBuffer &srcCmd);
-    void RPC_HandleWhisper(ByteBuffer &srcCmd);
-    void RPC_HandleStopAnimation(ByteBuffer &srcCmd);
-    void RPC_HandleStartAnimtion(ByteBuffer &srcCmd);
-    void RPC_HandleChangeMood(ByteBuffer &srcCmd);
-    void RPC_HandlePerformEmote(ByteBuffer &srcCmd);
-    void RPC_HandleDynamicObjInteraction(ByteBuffer &srcCmd);
-    void RPC_HandleStaticObjInteraction(ByteBuffer &srcCmd);
-    void RPC_HandleJump(ByteBuffer &srcCmd);
-    void RPC_HandleRegionLoadedNotification(ByteBuffer &srcCmd);
-    void RPC_HandleReadyForWorldChange(ByteBuffer &srcCmd);
-    void RPC_HandleWho(ByteBuffer &srcCmd);
-    void RPC_HandleWhereAmI(ByteBuffer &srcCmd);
-    void RPC_HandleGetPlayerDetails(ByteBuffer &srcCmd);
-    void RPC_HandleGetBackground(ByteBuffer &srcCmd);
-    void RPC_HandleSetBackground(ByteBuffer &srcCmd);
-    void RPC_HandleHardlineTeleport(ByteBuffer &srcCmd);
-    void RPC_HandleObjectSelected(ByteBuffer &srcCmd);
-    void RPC_HandleJackoutRequest(ByteBuffer &srcCmd);
-    void RPC_HandleJackoutFinished(ByteBuffer &srcCmd);
+    void RPC_NullHandle(ByteView &srcCmd);
+    void RPC_HandleReadyForSpawn(ByteView &srcCmd);
+    void RPC_HandleChat(ByteView &srcCmd);
+    void RPC_HandleWhisper(ByteView &srcCmd);
+    void RPC_HandleStopAnimation(ByteView &srcCmd);
+    void RPC_HandleStartAnimtion(ByteView &srcCmd);
+    void RPC_HandleChangeMood(ByteView &srcCmd);
+    void RPC_HandlePerformEmote(ByteView &srcCmd);
+    void RPC_HandleDynamicObjInteraction(ByteView &srcCmd);
+    void RPC_HandleStaticObjInteraction(ByteView &srcCmd);
+    void RPC_HandleJump(ByteView &srcCmd);
+    void RPC_HandleRegionLoadedNotification(ByteView &srcCmd);
+    void RPC_HandleReadyForWorldChange(ByteView &srcCmd);
+    void RPC_HandleWho(ByteView &srcCmd);
+    void RPC_HandleWhereAmI(ByteView &srcCmd);
+    void RPC_HandleGetPlayerDetails(ByteView &srcCmd);
+    void RPC_HandleGetBackground(ByteView &srcCmd);
+    void RPC_HandleSetBackground(ByteView &srcCmd);
+    void RPC_HandleHardlineTeleport(ByteView &srcCmd);
+    void RPC_HandleObjectSelected(ByteView &srcCmd);
+    void RPC_HandleJackoutRequest(ByteView &srcCmd);
+    void RPC_HandleJackoutFinished(ByteView &srcCmd);
 
     // RPC Handler maps
     std::map<uint8_t, RPCHandler> m_RPCbyte;
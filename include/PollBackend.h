@@ -0,0 +1,98 @@
+#ifndef _POLL_BACKEND_H_
+#define _POLL_BACKEND_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Socket readiness backend
+ * 
+ * PollBackend abstracts how the socket handlers wait for readiness, so
+ * the per-tick cost depends on the number of ready sockets instead of
+ * the number of open ones. Available backends are "epoll" (Linux),
+ * "io_uring" (Linux, when built with HAVE_LIBURING) and "select"
+ * (portable fallback).
+ * 
+ * All backends are level-triggered: a socket that still has unread data
+ * is reported again by the next Wait, so one read per event is enough.
+ */
+class PollBackend {
+public:
+    /**
+     * @brief Event flags
+     */
+    enum EventFlags {
+        POLL_READ = 0x01,
+        POLL_WRITE = 0x02,
+        POLL_ERROR = 0x04
+    };
+
+    /**
+     * @brief Readiness event
+     */
+    struct Event {
+        int fd;             ///< Socket descriptor
+        uint32_t events;    ///< Ready events (EventFlags)
+    };
+
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~PollBackend() {}
+
+    /**
+     * @brief Start watching a socket
+     * 
+     * @param fd Socket descriptor
+     * @param events Events to watch (EventFlags)
+     * @return true if successful, false otherwise
+     */
+    virtual bool Add(int fd, uint32_t events) = 0;
+
+    /**
+     * @brief Change the watched events of a socket
+     * 
+     * @param fd Socket descriptor
+     * @param events Events to watch (EventFlags)
+     * @return true if successful, false otherwise
+     */
+    virtual bool Modify(int fd, uint32_t events) = 0;
+
+    /**
+     * @brief Stop watching a socket
+     * 
+     * @param fd Socket descriptor
+     * @return true if successful, false otherwise
+     */
+    virtual bool Remove(int fd) = 0;
+
+    /**
+     * @brief Wait for readiness
+     * 
+     * @param events Vector to fill with ready events (cleared first)
+     * @param timeoutMs Maximum wait in milliseconds, 0 to poll
+     * @return Number of events, or -1 on error
+     */
+    virtual int Wait(std::vector<Event>& events, uint32_t timeoutMs) = 0;
+
+    /**
+     * @brief Get the backend name
+     * 
+     * @return Backend name
+     */
+    virtual const char* GetName() const = 0;
+
+    /**
+     * @brief Create a backend by name
+     * 
+     * Falls back to the best available backend when the requested one
+     * is not supported on this platform or build.
+     * 
+     * @param name Backend name ("epoll", "io_uring" or "select")
+     * @return New backend, owned by the caller
+     */
+    static PollBackend* Create(const std::string& name);
+};
+
+#endif // _POLL_BACKEND_H_
@@ -0,0 +1,120 @@
+#ifndef _POLLED_SOCKET_HANDLER_H_
+#define _POLLED_SOCKET_HANDLER_H_
+
+#include "SocketDispatcher.h"
+#include <Sockets/SocketHandler.h>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Socket handler that waits through a readiness backend
+ * 
+ * PolledSocketHandler is the common base of the auth, game and margin
+ * handlers. Sockets added to the handler, including the ones a listen
+ * socket accepts, are registered with its SocketDispatcher, and removed
+ * again when the socket library removes them.
+ * 
+ * The socket library still owns the socket lifecycle: queued sockets are
+ * adopted, and closed sockets deleted, inside SocketHandler::Select. Poll
+ * therefore runs a zero-timeout Select after sockets were added, and at
+ * least every HOUSEKEEPING_INTERVAL milliseconds for closes and timeouts.
+ */
+class PolledSocketHandler : public SocketHandler {
+public:
+    /**
+     * @brief Longest time between two housekeeping Selects in milliseconds
+     */
+    static const uint32_t HOUSEKEEPING_INTERVAL = 50;
+    
+    /**
+     * @brief Default constructor
+     */
+    PolledSocketHandler();
+    
+    /**
+     * @brief Destructor
+     */
+    virtual ~PolledSocketHandler();
+    
+    /**
+     * @brief Add a socket to the handler
+     * 
+     * Called by the socket library for every new socket, including the
+     * ones accepted by a listen socket. The socket is registered with the
+     * readiness backend as well.
+     * 
+     * @param socket Socket to add
+     */
+    void Add(Socket* socket);
+    
+    /**
+     * @brief Remove a socket from the handler
+     * 
+     * Called by the socket library before the socket is deleted. The
+     * socket is unregistered from the readiness backend as well.
+     * 
+     * @param socket Socket to remove
+     */
+    void Remove(Socket* socket);
+    
+    /**
+     * @brief Select the socket readiness backend
+     * 
+     * @param name Backend name ("epoll", "io_uring" or "select")
+     * @return true if the requested backend is active, false if a fallback was used
+     */
+    bool SetPollBackend(const std::string& name) { return m_dispatcher.SetBackend(name); }
+    
+    /**
+     * @brief Register a socket with the readiness backend
+     * 
+     * Only needed for sockets that are not added to the handler.
+     * 
+     * @param socket Socket to register
+     */
+    void RegisterSocket(Socket* socket) { m_dispatcher.Register(socket); }
+    
+    /**
+     * @brief Unregister a socket from the readiness backend
+     * 
+     * @param socket Socket to unregister
+     */
+    void UnregisterSocket(Socket* socket) { m_dispatcher.Unregister(socket); }
+    
+    /**
+     * @brief Schedule a wake-up of the next Poll
+     * 
+     * @param delayMs Delay from now in milliseconds
+     */
+    void ScheduleDeadline(uint32_t delayMs) { m_dispatcher.ScheduleDeadline(delayMs); }
+    
+    /**
+     * @brief Wait for socket events and dispatch them
+     * 
+     * Waits until the next scheduled deadline, but no longer than
+     * maxWaitMs, then runs the socket library housekeeping when it is
+     * due. Without a readiness backend this falls back to Select.
+     * 
+     * @param maxWaitMs Upper bound for the wait in milliseconds
+     * @return Number of events dispatched, or -1 on error
+     */
+    int Poll(uint32_t maxWaitMs);
+    
+private:
+    /**
+     * @brief Socket readiness dispatcher
+     */
+    SocketDispatcher m_dispatcher;
+    
+    /**
+     * @brief Sockets were added since the last housekeeping Select
+     */
+    bool m_added;
+    
+    /**
+     * @brief Time of the last housekeeping Select in milliseconds
+     */
+    uint64_t m_lastHousekeeping;
+};
+
+#endif // _POLLED_SOCKET_HANDLER_H_
@@ -0,0 +1,588 @@
+#ifndef _RELIABILITY_WINDOW_H_
+#define _RELIABILITY_WINDOW_H_
+
+#include "ByteBufferChain.h"
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+
+/**
+ * @brief Wrap-safe sequence comparison
+ * 
+ * Sequence numbers are 16 bit and wrap at 65535. A sequence is newer
+ * than another when it is ahead by less than half the sequence space.
+ * 
+ * @param a First sequence number
+ * @param b Second sequence number
+ * @return true if a is newer than b
+ */
+inline bool SequenceGreaterThan(uint16_t a, uint16_t b) {
+    return ((a > b) && (a - b <= 32768)) || ((a < b) && (b - a > 32768));
+}
+
+/**
+ * @brief Forward distance between two sequence numbers
+ * 
+ * @param from Older sequence number
+ * @param to Newer sequence number
+ * @return Number of steps from 'from' to 'to', modulo 65536
+ */
+inline uint16_t SequenceDistance(uint16_t from, uint16_t to) {
+    return (uint16_t)(to - from);
+}
+
+/**
+ * @brief Sequences reported by one acknowledgment
+ * 
+ * The ack number and the 32 sequences before it in the ack bitfield.
+ */
+const uint16_t ACK_SEQUENCE_COVERAGE = 33;
+
+/**
+ * @brief Fixed-size window of sent, unacknowledged reliable packets
+ * 
+ * Packets are stored in a power-of-two ring indexed by sequence & mask,
+ * so inserting and acknowledging are O(1) and allocation free once the
+ * slots' chains have warmed up. The packet is kept as a buffer chain,
+ * which references shared payloads instead of copying them.
+ * 
+ * The window spans at most ACK_SEQUENCE_COVERAGE sequences. The peer
+ * acknowledges its newest sequence and the 32 before it, so a packet
+ * further behind than that could never be acknowledged once newer ones
+ * reach the peer; it would be resent forever and hold the window shut.
+ * Reliable and unreliable packets share the sequence space, so the
+ * sender must not assign any new sequence for which CanInsert fails.
+ */
+template <size_t Size>
+class SendWindow {
+    static_assert(Size >= 2 && Size <= 32768 && (Size & (Size - 1)) == 0,
+                  "SendWindow size must be a power of two up to 32768");
+
+public:
+    /**
+     * @brief In-flight packet
+     */
+    struct Entry {
+        ByteBufferChain packet;   ///< Complete packet as sent
+        uint32_t sentTime;        ///< Time of the last transmission in milliseconds
+        uint16_t sequence;        ///< Sequence number
+        uint8_t sendCount;        ///< Number of transmissions
+        bool inUse;               ///< Slot holds an unacknowledged packet
+    };
+
+    /**
+     * @brief Widest span of sequences in flight, oldest to newest
+     */
+    static const uint16_t MAX_SPAN = Size < ACK_SEQUENCE_COVERAGE ? (uint16_t)Size : ACK_SEQUENCE_COVERAGE;
+
+    /**
+     * @brief Later acknowledged packets needed to declare a packet lost
+     */
+    static const uint16_t FAST_RETRANSMIT_THRESHOLD = 3;
+
+    /**
+     * @brief Default constructor
+     */
+    SendWindow() : m_oldest(0), m_newest(0), m_count(0), m_highestAcked(0), m_hasAcked(false) {
+        for (size_t i = 0; i < Size; ++i) {
+            m_entries[i].sentTime = 0;
+            m_entries[i].sequence = 0;
+            m_entries[i].sendCount = 0;
+            m_entries[i].inUse = false;
+        }
+    }
+
+    /**
+     * @brief Check if a sequence number can be inserted
+     * 
+     * Fails when the window is full, i.e. the sequence is MAX_SPAN or
+     * more ahead of the oldest unacknowledged packet.
+     * 
+     * @param sequence Sequence number
+     * @return true if there is room, false otherwise
+     */
+    bool CanInsert(uint16_t sequence) const {
+        return m_count == 0 || SequenceDistance(m_oldest, sequence) < MAX_SPAN;
+    }
+
+    /**
+     * @brief Track a sent reliable packet
+     * 
+     * @param sequence Sequence number of the packet
+     * @param packet Packet segments (moved into the window)
+     * @param now Current time in milliseconds
+     * @return Window entry, or nullptr if the window is full
+     */
+    Entry* Insert(uint16_t sequence, ByteBufferChain&& packet, uint32_t now) {
+        if (!CanInsert(sequence)) {
+            return nullptr;
+        }
+
+        Entry& entry = m_entries[sequence & MASK];
+        if (entry.inUse) {
+            return nullptr;
+        }
+
+        entry.packet = std::move(packet);
+        entry.sentTime = now;
+        entry.sequence = sequence;
+        entry.sendCount = 1;
+        entry.inUse = true;
+
+        if (m_count == 0) {
+            m_oldest = sequence;
+            m_newest = sequence;
+        } else if (SequenceGreaterThan(sequence, m_newest)) {
+            m_newest = sequence;
+        }
+        ++m_count;
+        return &entry;
+    }
+
+    /**
+     * @brief Acknowledge a packet
+     * 
+     * @param sequence Acknowledged sequence number
+     * @return true if the packet was in flight, false for stale or duplicate acks
+     */
+    bool Acknowledge(uint16_t sequence) {
+        return Acknowledge(sequence, NoAction());
+    }
+
+    /**
+     * @brief Acknowledge a packet
+     * 
+     * @param sequence Acknowledged sequence number
+     * @param onAcked Called with the const Entry& before it is released
+     * @return true if the packet was in flight, false for stale or duplicate acks
+     */
+    template <typename OnAcked>
+    bool Acknowledge(uint16_t sequence, OnAcked onAcked) {
+        Entry& entry = m_entries[sequence & MASK];
+        if (!entry.inUse || entry.sequence != sequence) {
+            return false;
+        }
+
+        onAcked(static_cast<const Entry&>(entry));
+        entry.packet.Clear();
+        entry.inUse = false;
+        --m_count;
+
+        if (!m_hasAcked || SequenceGreaterThan(sequence, m_highestAcked)) {
+            m_highestAcked = sequence;
+            m_hasAcked = true;
+        }
+
+        // Slide the window start past acknowledged slots
+        if (m_count == 0) {
+            m_oldest = (uint16_t)(m_newest + 1);
+        } else {
+            while (!m_entries[m_oldest & MASK].inUse) {
+                ++m_oldest;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Process a selective acknowledgment
+     * 
+     * Bit n of the bitfield acknowledges sequence (ack - 1 - n).
+     * 
+     * @param ack Newest sequence received by the peer
+     * @param ackBits Received history before ack
+     * @return Number of packets that were newly acknowledged
+     */
+    size_t AcknowledgeBits(uint16_t ack, uint32_t ackBits) {
+        return AcknowledgeBits(ack, ackBits, NoAction());
+    }
+
+    /**
+     * @brief Process a selective acknowledgment
+     * 
+     * @param ack Newest sequence received by the peer
+     * @param ackBits Received history before ack
+     * @param onAcked Called with the const Entry& of every newly acknowledged packet
+     * @return Number of packets that were newly acknowledged
+     */
+    template <typename OnAcked>
+    size_t AcknowledgeBits(uint16_t ack, uint32_t ackBits, OnAcked onAcked) {
+        size_t acked = Acknowledge(ack, onAcked) ? 1 : 0;
+        while (ackBits && m_count) {
+            uint32_t bit = CountTrailingZeros(ackBits);
+            ackBits &= ackBits - 1;
+            if (Acknowledge((uint16_t)(ack - 1 - bit), onAcked)) {
+                ++acked;
+            }
+        }
+        return acked;
+    }
+
+    /**
+     * @brief Visit the in-flight packets that need a retransmission
+     * 
+     * A packet needs one when its last transmission timed out, or, on its
+     * first transmission, when FAST_RETRANSMIT_THRESHOLD later packets
+     * were already acknowledged. Packets that are merely in flight are
+     * left alone.
+     * 
+     * @param now Current time in milliseconds
+     * @param timeout Retransmission timeout in milliseconds
+     * @param visitor Called with (Entry&, bool timedOut) for every lost packet
+     * @return Number of packets visited
+     */
+    template <typename Visitor>
+    size_t ForEachLost(uint32_t now, uint32_t timeout, Visitor visitor) {
+        size_t lost = 0;
+        ForEachInFlight([&](Entry& entry) {
+            bool timedOut = now - entry.sentTime >= timeout;
+            bool overtaken = m_hasAcked && entry.sendCount == 1 &&
+                             SequenceGreaterThan(m_highestAcked, entry.sequence) &&
+                             SequenceDistance(entry.sequence, m_highestAcked) >= FAST_RETRANSMIT_THRESHOLD;
+            if (timedOut || overtaken) {
+                visitor(entry, timedOut);
+                ++lost;
+            }
+        });
+        return lost;
+    }
+
+    /**
+     * @brief Look up an in-flight packet
+     * 
+     * @param sequence Sequence number
+     * @return Window entry, or nullptr if not in flight
+     */
+    Entry* Find(uint16_t sequence) {
+        Entry& entry = m_entries[sequence & MASK];
+        return entry.inUse && entry.sequence == sequence ? &entry : nullptr;
+    }
+
+    /**
+     * @brief Visit all in-flight packets, oldest first
+     * 
+     * @param visitor Called with an Entry& for every in-flight packet
+     */
+    template <typename Visitor>
+    void ForEachInFlight(Visitor visitor) {
+        if (m_count == 0) {
+            return;
+        }
+
+        uint16_t span = SequenceDistance(m_oldest, m_newest);
+        for (uint32_t i = 0; i <= span; ++i) {
+            Entry& entry = m_entries[(uint16_t)(m_oldest + i) & MASK];
+            if (entry.inUse) {
+                visitor(entry);
+            }
+        }
+    }
+
+    /**
+     * @brief Drop all in-flight packets
+     * 
+     * Also forgets the newest acknowledgment, so packets inserted
+     * afterwards are not taken as overtaken by it.
+     */
+    void Clear() {
+        for (size_t i = 0; i < Size; ++i) {
+            m_entries[i].packet.Clear();
+            m_entries[i].inUse = false;
+        }
+        m_oldest = 0;
+        m_newest = 0;
+        m_count = 0;
+        m_highestAcked = 0;
+        m_hasAcked = false;
+    }
+
+    /**
+     * @brief Get the number of in-flight packets
+     * 
+     * @return Number of unacknowledged packets
+     */
+    size_t GetInFlight() const { return m_count; }
+
+    /**
+     * @brief Get the oldest unacknowledged sequence number
+     * 
+     * @return Sequence number (only meaningful while packets are in flight)
+     */
+    uint16_t GetOldest() const { return m_oldest; }
+
+    /**
+     * @brief Get the window capacity
+     * 
+     * @return Maximum in-flight packets
+     */
+    static size_t GetCapacity() { return MAX_SPAN; }
+
+private:
+    static const uint16_t MASK = (uint16_t)(Size - 1);
+
+    struct NoAction {
+        void operator()(const Entry&) const {}
+    };
+
+    static uint32_t CountTrailingZeros(uint32_t value) {
+#if defined(__GNUC__)
+        return (uint32_t)__builtin_ctz(value);
+#else
+        uint32_t count = 0;
+        while (!(value & 1)) {
+            value >>= 1;
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    Entry m_entries[Size];    ///< Ring of in-flight packets
+    uint16_t m_oldest;        ///< Oldest unacknowledged sequence
+    uint16_t m_newest;        ///< Newest inserted sequence
+    size_t m_count;           ///< Number of in-flight packets
+    uint16_t m_highestAcked;  ///< Newest acknowledged sequence
+    bool m_hasAcked;          ///< Anything acknowledged yet
+};
+
+/**
+ * @brief Packets waiting for room in a SendWindow
+ * 
+ * Every packet takes a sequence number, so while the send window cannot
+ * take the next one nothing may be sent. Reliable packets are queued and
+ * sent in order as acknowledgments free the window. Unreliable packets
+ * are dropped instead: they carry state that the next update replaces,
+ * and queueing them would delay the reliable packets behind them. The
+ * queue holds at most MaxHeld packets; a peer that falls further behind
+ * than that is not keeping up and Offer reports HOLD_OVERFLOW.
+ */
+template <typename Packet, size_t MaxHeld>
+class HeldPacketQueue {
+public:
+    /**
+     * @brief What Offer did with a packet
+     */
+    enum Result {
+        HOLD_SEND,      ///< The window has room; send the packet now
+        HOLD_HELD,      ///< Reliable packet queued
+        HOLD_DROPPED,   ///< Unreliable packet dropped
+        HOLD_OVERFLOW   ///< Reliable packet rejected, the queue is full
+    };
+
+    /**
+     * @brief Default constructor
+     */
+    HeldPacketQueue() : m_releasing(false), m_dropped(0) {}
+
+    /**
+     * @brief Offer a packet before it takes a sequence number
+     * 
+     * Packets pass while the window has room and nothing is queued, and
+     * always while Release is sending.
+     * 
+     * @param window Send window
+     * @param nextSequence Sequence number the packet would take
+     * @param reliable Is the packet reliable
+     * @param makePacket Returns the Packet to queue; only called when it is held
+     * @return What happened to the packet
+     */
+    template <size_t Size, typename MakePacket>
+    Result Offer(const SendWindow<Size>& window, uint16_t nextSequence, bool reliable, MakePacket makePacket) {
+        if (m_releasing || (m_held.empty() && window.CanInsert(nextSequence))) {
+            return HOLD_SEND;
+        }
+
+        if (!reliable) {
+            ++m_dropped;
+            return HOLD_DROPPED;
+        }
+
+        if (m_held.size() >= MaxHeld) {
+            return HOLD_OVERFLOW;
+        }
+
+        m_held.push_back(makePacket());
+        return HOLD_HELD;
+    }
+
+    /**
+     * @brief Send queued packets while the window has room
+     * 
+     * The send callback assigns the sequence, so nextSequence is read
+     * again after every packet.
+     * 
+     * @param window Send window
+     * @param nextSequence Sequence number the next packet takes
+     * @param send Called with a Packet& for every released packet
+     * @return Number of packets released
+     */
+    template <size_t Size, typename Send>
+    size_t Release(const SendWindow<Size>& window, const uint16_t& nextSequence, Send send) {
+        size_t released = 0;
+        m_releasing = true;
+        while (!m_held.empty() && window.CanInsert(nextSequence)) {
+            Packet packet = std::move(m_held.front());
+            m_held.pop_front();
+            send(packet);
+            ++released;
+        }
+        m_releasing = false;
+        return released;
+    }
+
+    /**
+     * @brief Drop all queued packets
+     */
+    void Clear() { m_held.clear(); }
+
+    /**
+     * @brief Get the number of queued packets
+     * 
+     * @return Queued reliable packets
+     */
+    size_t GetHeld() const { return m_held.size(); }
+
+    /**
+     * @brief Get the number of unreliable packets dropped for a full window
+     * 
+     * @return Dropped packets
+     */
+    uint64_t GetDropped() const { return m_dropped; }
+
+    /**
+     * @brief Get the queue capacity
+     * 
+     * @return Maximum queued packets
+     */
+    static size_t GetCapacity() { return MaxHeld; }
+
+private:
+    std::deque<Packet> m_held;  ///< Queued reliable packets, oldest first
+    bool m_releasing;           ///< Release is sending, so Offer lets packets through
+    uint64_t m_dropped;         ///< Unreliable packets dropped
+};
+
+/**
+ * @brief Fixed-size window of received reliable sequence numbers
+ * 
+ * Remembers which of the last Size sequence numbers were received so
+ * duplicates can be dropped in O(1). Sequences older than the window
+ * are reported as duplicates; the sender is still acknowledged.
+ */
+template <size_t Size>
+class ReceiveWindow {
+    static_assert(Size >= 2 && Size <= 32768 && (Size & (Size - 1)) == 0,
+                  "ReceiveWindow size must be a power of two up to 32768");
+
+public:
+    /**
+     * @brief Default constructor
+     */
+    ReceiveWindow() : m_latest(0), m_hasLatest(false) {
+        Clear();
+    }
+
+    /**
+     * @brief Record a received sequence number
+     * 
+     * @param sequence Received sequence number
+     * @return true if the sequence is new, false if it is a duplicate or too old
+     */
+    bool Record(uint16_t sequence) {
+        if (!m_hasLatest) {
+            m_hasLatest = true;
+            m_latest = sequence;
+            m_slots[sequence & MASK] = sequence;
+            return true;
+        }
+
+        if (SequenceGreaterThan(sequence, m_latest)) {
+            // Forget the sequences that the window slides over
+            uint16_t distance = SequenceDistance(m_latest, sequence);
+            if (distance >= Size) {
+                Clear();
+            } else {
+                for (uint16_t s = (uint16_t)(m_latest + 1); s != sequence; ++s) {
+                    m_slots[s & MASK] = EMPTY;
+                }
+            }
+
+            m_slots[sequence & MASK] = sequence;
+            m_latest = sequence;
+            return true;
+        }
+
+        if (SequenceDistance(sequence, m_latest) >= Size || m_slots[sequence & MASK] == sequence) {
+            return false;
+        }
+
+        m_slots[sequence & MASK] = sequence;
+        return true;
+    }
+
+    /**
+     * @brief Check if a sequence number was received
+     * 
+     * @param sequence Sequence number
+     * @return true if received and still inside the window
+     */
+    bool IsReceived(uint16_t sequence) const {
+        return m_hasLatest && SequenceDistance(sequence, m_latest) < Size && m_slots[sequence & MASK] == sequence;
+    }
+
+    /**
+     * @brief Get the newest received sequence number
+     * 
+     * @return Sequence number (only meaningful after the first Record)
+     */
+    uint16_t GetLatest() const { return m_latest; }
+
+    /**
+     * @brief Build the selective acknowledgment bitfield
+     * 
+     * Bit n is set when sequence (latest - 1 - n) was received, so the
+     * peer learns about the last 33 packets from one ack.
+     * 
+     * @return Received history before the latest sequence
+     */
+    uint32_t GetAckBits() const {
+        uint32_t bits = 0;
+        if (!m_hasLatest) {
+            return bits;
+        }
+
+        for (uint32_t n = 0; n < 32 && n + 1 < Size; ++n) {
+            uint16_t sequence = (uint16_t)(m_latest - 1 - n);
+            if (m_slots[sequence & MASK] == sequence) {
+                bits |= 1u << n;
+            }
+        }
+        return bits;
+    }
+
+    /**
+     * @brief Check if anything was received yet
+     * 
+     * @return true if at least one sequence was recorded
+     */
+    bool HasReceived() const { return m_hasLatest; }
+
+    /**
+     * @brief Forget all received sequence numbers
+     */
+    void Clear() {
+        for (size_t i = 0; i < Size; ++i) {
+            m_slots[i] = EMPTY;
+        }
+    }
+
+private:
+    static const uint16_t MASK = (uint16_t)(Size - 1);
+    static const uint32_t EMPTY = 0xFFFFFFFF;
+
+    uint32_t m_slots[Size];   ///< Sequence held by each slot, or EMPTY
+    uint16_t m_latest;        ///< Newest received sequence
+    bool m_hasLatest;         ///< Anything received yet
+};
+
+#endif // _RELIABILITY_WINDOW_H_
@@ -0,0 +1,113 @@
+#ifndef _RTT_ESTIMATOR_H_
+#define _RTT_ESTIMATOR_H_
+
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * @brief Round-trip time estimator and retransmission timer
+ * 
+ * Smoothed RTT and RTT variance per RFC 6298, kept in fixed point
+ * (SRTT scaled by 8, RTTVAR by 4) so every update is a few integer
+ * operations. The RTO doubles on every retransmission timeout and is
+ * recomputed from the estimate on the next valid sample. Callers apply
+ * Karn's rule by only sampling packets that were sent exactly once.
+ */
+class RttEstimator {
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param initialRto RTO before the first sample in milliseconds
+     * @param minRto Lower bound of the RTO in milliseconds
+     * @param maxRto Upper bound of the RTO in milliseconds
+     */
+    RttEstimator(uint32_t initialRto = 1000, uint32_t minRto = 50, uint32_t maxRto = 10000)
+        : m_srtt8(0), m_rttVar4(0), m_minRto(minRto), m_maxRto(maxRto),
+          m_rto(initialRto), m_samples(0), m_backoffs(0) {
+    }
+
+    /**
+     * @brief Add a round-trip sample
+     * 
+     * @param rtt Measured round trip in milliseconds (from a packet sent once)
+     */
+    void AddSample(uint32_t rtt) {
+        if (m_samples == 0) {
+            m_srtt8 = rtt << 3;
+            m_rttVar4 = rtt << 1;
+        } else {
+            // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+            int32_t error = (int32_t)rtt - (int32_t)(m_srtt8 >> 3);
+            m_srtt8 = (uint32_t)((int32_t)m_srtt8 + error);
+            m_rttVar4 = m_rttVar4 - (m_rttVar4 >> 2) + (uint32_t)(error < 0 ? -error : error);
+        }
+
+        ++m_samples;
+        m_backoffs = 0;
+        m_rto = Clamp((m_srtt8 >> 3) + std::max(uint32_t(CLOCK_GRANULARITY), m_rttVar4));
+    }
+
+    /**
+     * @brief Back off after a retransmission timeout
+     */
+    void OnTimeout() {
+        ++m_backoffs;
+        m_rto = Clamp(m_rto * 2);
+    }
+
+    /**
+     * @brief Get the retransmission timeout
+     * 
+     * @return RTO in milliseconds
+     */
+    uint32_t GetRto() const { return m_rto; }
+
+    /**
+     * @brief Get the smoothed round-trip time
+     * 
+     * @return SRTT in milliseconds, 0 before the first sample
+     */
+    uint32_t GetSrtt() const { return m_srtt8 >> 3; }
+
+    /**
+     * @brief Get the round-trip time variance
+     * 
+     * @return RTTVAR in milliseconds, 0 before the first sample
+     */
+    uint32_t GetRttVar() const { return m_rttVar4 >> 2; }
+
+    /**
+     * @brief Get the number of samples taken
+     * 
+     * @return Number of samples
+     */
+    uint32_t GetSampleCount() const { return m_samples; }
+
+    /**
+     * @brief Get the number of consecutive backoffs
+     * 
+     * @return Backoffs since the last valid sample
+     */
+    uint32_t GetBackoffCount() const { return m_backoffs; }
+
+private:
+    /**
+     * @brief Timer granularity in milliseconds (one server tick)
+     */
+    static const uint32_t CLOCK_GRANULARITY = 33;
+
+    uint32_t Clamp(uint32_t rto) const {
+        return std::min(std::max(rto, m_minRto), m_maxRto);
+    }
+
+    uint32_t m_srtt8;       ///< Smoothed RTT << 3
+    uint32_t m_rttVar4;     ///< RTT variance << 2
+    uint32_t m_minRto;      ///< Lower RTO bound
+    uint32_t m_maxRto;      ///< Upper RTO bound
+    uint32_t m_rto;         ///< Current RTO
+    uint32_t m_samples;     ///< Samples taken
+    uint32_t m_backoffs;    ///< Consecutive backoffs
+};
+
+#endif // _RTT_ESTIMATOR_H_
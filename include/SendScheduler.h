@@ -0,0 +1,179 @@
+#ifndef _SEND_SCHEDULER_H_
+#define _SEND_SCHEDULER_H_
+
+#include "ByteBufferChain.h"
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief Send priority classes, highest first
+ */
+enum SendPriority {
+    PRIORITY_CONTROL          = 0,  ///< Reliable control messages (login, region, jackout)
+    PRIORITY_SELF_MOVEMENT    = 1,  ///< The client's own movement corrections
+    PRIORITY_NEARBY_OBJECTS   = 2,  ///< Updates for nearby objects
+    PRIORITY_DISTANT_OBJECTS  = 3,  ///< Updates for distant objects
+    PRIORITY_CHAT             = 4,  ///< Chat messages
+    PRIORITY_COUNT            = 5
+};
+
+/**
+ * @brief Per-connection send scheduler with a bandwidth budget
+ * 
+ * Messages are queued per priority class and released against a token
+ * bucket. Control messages always go out, even into debt; the other
+ * classes wait for budget in priority order. A message costing more
+ * than the bucket holds goes out once the bucket is full and leaves it
+ * in debt, so it cannot block its class forever. Unreliable messages that
+ * carry a coalesce key (e.g. the object ID) replace an older queued
+ * message with the same key, in whichever class it waits, and unreliable
+ * messages that wait longer than their class allows are dropped.
+ * Reliable messages are only ever delayed.
+ * 
+ * The budget adapts additively upwards while the link is healthy and
+ * is halved when the connection reports a retransmission timeout.
+ */
+class SendScheduler {
+public:
+    /**
+     * @brief Queued message
+     */
+    struct Message {
+        uint16_t type;                        ///< Message type
+        ByteBufferChain::SharedBuffer block;  ///< Serialized message block (null once superseded)
+        bool reliable;                        ///< Is the message reliable
+        bool encrypted;                       ///< Is the message encrypted
+        uint32_t coalesceKey;                 ///< Coalesce key (0 = never coalesce)
+        uint32_t queuedTime;                  ///< Time the message was queued in milliseconds
+    };
+
+    /**
+     * @brief Scheduler statistics
+     */
+    struct Stats {
+        uint64_t sent[PRIORITY_COUNT];        ///< Messages sent per class
+        uint64_t coalesced[PRIORITY_COUNT];   ///< Messages replaced by a newer one, per class of the replaced one
+        uint64_t dropped[PRIORITY_COUNT];     ///< Messages dropped per class
+        uint64_t bytesSent;                   ///< Bytes released, including per-packet overhead
+        uint32_t rate;                        ///< Current budget in bytes per second
+    };
+
+    /**
+     * @brief Send callback
+     */
+    typedef std::function<void(const Message&)> SendCallback;
+
+    /**
+     * @brief Constructor
+     * 
+     * @param maxRate Budget ceiling in bytes per second
+     * @param minRate Budget floor in bytes per second
+     * @param burst Bucket size in bytes
+     * @param overhead Bytes charged per message on top of the block (packet headers)
+     */
+    SendScheduler(uint32_t maxRate = 65536, uint32_t minRate = 8192, uint32_t burst = 16384, uint32_t overhead = 0);
+
+    /**
+     * @brief Change the bandwidth budget
+     * 
+     * @param maxRate Budget ceiling in bytes per second
+     * @param minRate Budget floor in bytes per second
+     * @param burst Bucket size in bytes
+     */
+    void SetBudget(uint32_t maxRate, uint32_t minRate, uint32_t burst);
+
+    /**
+     * @brief Queue a message
+     * 
+     * An unreliable message replaces the queued message with the same
+     * coalesce key. When the key moved to another class, the old copy is
+     * superseded and the message is queued in its new class.
+     * 
+     * @param priority Priority class
+     * @param type Message type
+     * @param block Serialized message block
+     * @param reliable Is the message reliable
+     * @param coalesceKey Key of the state the message carries (0 = never coalesce)
+     * @param now Current time in milliseconds
+     * @param encrypted Is the message encrypted
+     */
+    void Enqueue(SendPriority priority, uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, uint32_t coalesceKey, uint32_t now, bool encrypted = false);
+
+    /**
+     * @brief Release the messages the budget allows
+     * 
+     * @param now Current time in milliseconds
+     * @param send Called for every released message, highest priority first
+     * @return Number of messages released
+     */
+    size_t Flush(uint32_t now, const SendCallback& send);
+
+    /**
+     * @brief Report a retransmission timeout (halves the budget)
+     */
+    void OnCongestion();
+
+    /**
+     * @brief Get the number of queued messages
+     * 
+     * @return Number of messages over all classes
+     */
+    size_t GetQueuedCount() const;
+
+    /**
+     * @brief Get scheduler statistics
+     * 
+     * @param stats Structure to fill
+     */
+    void GetStats(Stats& stats) const { stats = m_stats; stats.rate = m_rate; }
+
+private:
+    SendScheduler(const SendScheduler&);
+    SendScheduler& operator=(const SendScheduler&);
+
+    /**
+     * @brief Drop expired unreliable messages from the front of a class
+     */
+    void Expire(size_t priority, uint32_t now);
+
+    /**
+     * @brief Remove the front message of a class
+     */
+    void PopFront(size_t priority);
+
+    /**
+     * @brief Remove superseded messages from the front of a class
+     */
+    void SkipSuperseded(size_t priority);
+
+    /**
+     * @brief Get the budget cost of a message
+     */
+    uint32_t Cost(const Message& message) const;
+
+    /**
+     * @brief Queued message carrying a coalesce key
+     */
+    struct Coalesced {
+        Message* message;                     ///< Queued message
+        size_t priority;                      ///< Class it is queued in
+    };
+
+    std::deque<Message> m_queues[PRIORITY_COUNT];                          ///< Queues per class
+    std::unordered_map<uint32_t, Coalesced> m_coalesce;                    ///< Coalesce key to queued message, over all classes
+    size_t m_superseded;          ///< Superseded messages still in the queues
+    uint32_t m_maxRate;           ///< Budget ceiling in bytes per second
+    uint32_t m_minRate;           ///< Budget floor in bytes per second
+    uint32_t m_rate;              ///< Current budget in bytes per second
+    uint32_t m_burst;             ///< Bucket size in bytes
+    uint32_t m_overhead;          ///< Bytes charged per message on top of the block
+    int64_t m_tokens;             ///< Available bytes (negative after debt)
+    uint32_t m_lastRefill;        ///< Time of the last refill
+    bool m_refilled;              ///< Bucket was refilled at least once
+    bool m_congested;             ///< A timeout was reported since the last increase
+    Stats m_stats;                ///< Statistics
+};
+
+#endif // _SEND_SCHEDULER_H_
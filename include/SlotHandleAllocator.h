@@ -0,0 +1,147 @@
+#ifndef _SLOT_HANDLE_ALLOCATOR_H_
+#define _SLOT_HANDLE_ALLOCATOR_H_
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Allocator of generational handles
+ * 
+ * A handle packs a slot index (low INDEX_BITS) and the slot's
+ * generation (high GENERATION_BITS). Releasing a handle bumps the
+ * generation of its slot, so a stale handle never matches the slot's
+ * next occupant and the same 32 bits serve forever instead of counting
+ * up to exhaustion. Generations skip 0, so 0 is never a valid handle.
+ * 
+ * Released slots are reused first in first out, and only once more
+ * than MIN_FREE_SLOTS are waiting, so a slot's generation wraps only
+ * after thousands of reuses of every slot in the queue.
+ * 
+ * Thread-safe.
+ */
+class SlotHandleAllocator {
+public:
+    /**
+     * @brief Bits of a handle holding the slot index
+     */
+    static const uint32_t INDEX_BITS = 20;
+
+    /**
+     * @brief Bits of a handle holding the generation
+     */
+    static const uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+
+    /**
+     * @brief Most live handles
+     */
+    static const uint32_t MAX_SLOTS = 1u << INDEX_BITS;
+
+    /**
+     * @brief Released slots kept waiting before one is reused
+     */
+    static const uint32_t MIN_FREE_SLOTS = 1024;
+
+    SlotHandleAllocator() {}
+
+    /**
+     * @brief Allocate a handle
+     * 
+     * @return Handle, or 0 if MAX_SLOTS handles are live
+     */
+    uint32_t Allocate() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        uint32_t index;
+        if (m_freeSlots.size() > MIN_FREE_SLOTS || (!m_freeSlots.empty() && m_generations.size() == MAX_SLOTS)) {
+            index = m_freeSlots.front();
+            m_freeSlots.pop_front();
+        } else if (m_generations.size() < MAX_SLOTS) {
+            index = uint32_t(m_generations.size());
+            m_generations.push_back(1);
+        } else {
+            return 0;
+        }
+
+        m_live.resize(m_generations.size(), false);
+        m_live[index] = true;
+        return MakeHandle(index, m_generations[index]);
+    }
+
+    /**
+     * @brief Release a handle
+     * 
+     * @param handle Handle returned by Allocate
+     * @return true if released, false if the handle was stale or invalid
+     */
+    bool Release(uint32_t handle) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!IsLiveLocked(handle)) {
+            return false;
+        }
+
+        uint32_t index = GetIndex(handle);
+        m_live[index] = false;
+        uint32_t generation = (m_generations[index] + 1) & ((1u << GENERATION_BITS) - 1);
+        m_generations[index] = uint16_t(generation ? generation : 1);
+        m_freeSlots.push_back(index);
+        return true;
+    }
+
+    /**
+     * @brief Check if a handle is live
+     * 
+     * @param handle Handle
+     * @return true if allocated and not released since
+     */
+    bool IsLive(uint32_t handle) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return IsLiveLocked(handle);
+    }
+
+    /**
+     * @brief Get the number of live handles
+     * 
+     * @return Number of handles
+     */
+    uint32_t GetLiveCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return uint32_t(m_generations.size() - m_freeSlots.size());
+    }
+
+    /**
+     * @brief Get the slot index of a handle
+     * 
+     * @param handle Handle
+     * @return Slot index
+     */
+    static uint32_t GetIndex(uint32_t handle) { return handle & (MAX_SLOTS - 1); }
+
+    /**
+     * @brief Get the generation of a handle
+     * 
+     * @param handle Handle
+     * @return Generation
+     */
+    static uint32_t GetGeneration(uint32_t handle) { return handle >> INDEX_BITS; }
+
+private:
+    SlotHandleAllocator(const SlotHandleAllocator&) = delete;
+    SlotHandleAllocator& operator=(const SlotHandleAllocator&) = delete;
+
+    static uint32_t MakeHandle(uint32_t index, uint32_t generation) { return (generation << INDEX_BITS) | index; }
+
+    bool IsLiveLocked(uint32_t handle) const {
+        uint32_t index = GetIndex(handle);
+        return index < m_generations.size() && m_live[index] && m_generations[index] == GetGeneration(handle);
+    }
+
+    std::vector<uint16_t> m_generations;  ///< Current generation per slot
+    std::vector<bool> m_live;             ///< Slot holds a live handle
+    std::deque<uint32_t> m_freeSlots;     ///< Released slots, oldest first
+    mutable std::mutex m_mutex;           ///< Guards the allocator
+};
+
+#endif // _SLOT_HANDLE_ALLOCATOR_H_
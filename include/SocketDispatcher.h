@@ -0,0 +1,126 @@
+#ifndef _SOCKET_DISPATCHER_H_
+#define _SOCKET_DISPATCHER_H_
+
+#include "PollBackend.h"
+#include <vector>
+#include <queue>
+#include <string>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+class Socket;
+
+/**
+ * @brief Readiness-driven socket event dispatcher
+ * 
+ * SocketDispatcher sits between a socket handler and a PollBackend. It
+ * keeps the descriptor to socket mapping, waits on the backend and
+ * calls OnRead/OnWrite on the ready sockets. Handlers schedule deadlines
+ * for their timers so that the wait ends at the next deadline rather
+ * than after a fixed interval.
+ */
+class SocketDispatcher {
+public:
+    /**
+     * @brief Default constructor
+     */
+    SocketDispatcher();
+    
+    /**
+     * @brief Destructor
+     */
+    ~SocketDispatcher();
+    
+    /**
+     * @brief Select the readiness backend
+     * 
+     * Sockets that are already registered are moved to the new backend.
+     * 
+     * @param name Backend name ("epoll", "io_uring" or "select")
+     * @return true if the requested backend is active, false if a fallback was used
+     */
+    bool SetBackend(const std::string& name);
+    
+    /**
+     * @brief Check if a backend is active
+     * 
+     * @return true if a backend is active, false otherwise
+     */
+    bool HasBackend() const { return m_backend.get() != nullptr; }
+    
+    /**
+     * @brief Get the name of the active backend
+     * 
+     * @return Backend name, or "none"
+     */
+    const char* GetBackendName() const { return m_backend ? m_backend->GetName() : "none"; }
+    
+    /**
+     * @brief Start dispatching events for a socket
+     * 
+     * Registering a socket again only updates its watched events.
+     * 
+     * @param socket Socket to register
+     * @param events Events to watch (PollBackend::EventFlags)
+     */
+    void Register(Socket* socket, uint32_t events = PollBackend::POLL_READ);
+    
+    /**
+     * @brief Change the watched events of a socket
+     * 
+     * @param socket Registered socket
+     * @param events Events to watch (PollBackend::EventFlags)
+     */
+    void Modify(Socket* socket, uint32_t events);
+    
+    /**
+     * @brief Stop dispatching events for a socket
+     * 
+     * Safe to call for sockets that were never registered or whose
+     * descriptor was already closed.
+     * 
+     * @param socket Socket to unregister
+     */
+    void Unregister(Socket* socket);
+    
+    /**
+     * @brief Schedule a wake-up
+     * 
+     * @param delayMs Delay from now in milliseconds
+     */
+    void ScheduleDeadline(uint32_t delayMs);
+    
+    /**
+     * @brief Get how long the next wait may last
+     * 
+     * Expired deadlines are discarded.
+     * 
+     * @param maxWaitMs Upper bound in milliseconds
+     * @return Milliseconds until the next deadline, at most maxWaitMs
+     */
+    uint32_t GetTimeout(uint32_t maxWaitMs);
+    
+    /**
+     * @brief Wait for events and dispatch them
+     * 
+     * @param maxWaitMs Upper bound for the wait in milliseconds
+     * @return Number of events dispatched, or -1 on error
+     */
+    int Poll(uint32_t maxWaitMs);
+
+private:
+    /**
+     * @brief Get the current monotonic time in milliseconds
+     */
+    static uint64_t Now();
+
+    std::unique_ptr<PollBackend> m_backend;                 ///< Readiness backend
+    std::unordered_map<int, Socket*> m_sockets;             ///< Registered sockets by descriptor
+    std::unordered_map<int, uint32_t> m_watchedEvents;      ///< Watched events by descriptor
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t> > m_deadlines; ///< Pending deadlines
+    std::vector<PollBackend::Event> m_events;               ///< Events of the last wait
+};
+
+#endif // _SOCKET_DISPATCHER_H_
@@ -0,0 +1,382 @@
+#ifndef _SPATIAL_HASH_GRID_H_
+#define _SPATIAL_HASH_GRID_H_
+
+#include "LocationVector.h"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Uniform spatial hash grid over the horizontal plane
+ * 
+ * Indexes IDs by position in square cells of a fixed size, hashed by
+ * cell coordinates so only occupied cells use memory. Each entry keeps
+ * a copy of its position, so range and nearest queries are answered
+ * without looking the objects up. Heights are not bucketed but are
+ * part of every distance test, which is the same 3D distance as
+ * LocationVector::Distance.
+ * 
+ * Positions are updated incrementally: Move only touches the cell
+ * vectors when the ID crosses a cell boundary. A cell size around the
+ * most common query range keeps range queries to a 3x3 block of cells.
+ * 
+ * Not thread-safe; the owner serializes access.
+ */
+class SpatialHashGrid {
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param cellSize Cell edge length in world units
+     */
+    explicit SpatialHashGrid(float cellSize = 32.0f);
+
+    /**
+     * @brief Change the cell size
+     * 
+     * Rebuilds the cells.
+     * 
+     * @param cellSize Cell edge length in world units
+     */
+    void SetCellSize(float cellSize);
+
+    /**
+     * @brief Get the cell size
+     * 
+     * @return Cell edge length in world units
+     */
+    float GetCellSize() const { return float(m_cellSize); }
+
+    /**
+     * @brief Add an ID, or move it if already present
+     * 
+     * @param id ID to add
+     * @param position Position
+     */
+    void Insert(uint32_t id, const LocationVector& position);
+
+    /**
+     * @brief Move an ID
+     * 
+     * @param id ID to move
+     * @param position New position
+     * @return true if moved, false if the ID is not in the grid
+     */
+    bool Move(uint32_t id, const LocationVector& position);
+
+    /**
+     * @brief Remove an ID
+     * 
+     * @param id ID to remove
+     * @return true if removed, false if the ID is not in the grid
+     */
+    bool Remove(uint32_t id);
+
+    /**
+     * @brief Check if an ID is in the grid
+     * 
+     * @param id ID to check
+     * @return true if present
+     */
+    bool Contains(uint32_t id) const { return m_entries.count(id) != 0; }
+
+    /**
+     * @brief Get the number of IDs
+     * 
+     * @return Number of IDs
+     */
+    size_t Size() const { return m_entries.size(); }
+
+    /**
+     * @brief Get the number of occupied cells
+     * 
+     * @return Number of cells
+     */
+    size_t GetCellCount() const { return m_cells.size(); }
+
+    /**
+     * @brief Remove every ID
+     */
+    void Clear();
+
+    /**
+     * @brief Visit the IDs within range of a position
+     * 
+     * @param center Center position
+     * @param range Range in world units
+     * @param visit Called as visit(id, distanceSq) for every ID within range
+     */
+    template<typename Visitor>
+    void QueryRange(const LocationVector& center, float range, Visitor visit) const;
+
+    /**
+     * @brief Collect the IDs within range of a position
+     * 
+     * @param center Center position
+     * @param range Range in world units
+     * @param ids Vector to append the IDs to, in no particular order
+     * @return Number of IDs appended
+     */
+    size_t QueryRange(const LocationVector& center, float range, std::vector<uint32_t>& ids) const;
+
+    /**
+     * @brief Find the nearest ID accepted by a filter
+     * 
+     * Searches outwards in rings of cells around the center and stops as
+     * soon as no unsearched cell can hold anything closer.
+     * 
+     * @param center Center position
+     * @param maxRange Maximum distance
+     * @param accept Called as accept(id); only IDs it returns true for are considered
+     * @param id Receives the nearest ID
+     * @return true if found, false if nothing accepted is within range
+     */
+    template<typename Filter>
+    bool FindNearest(const LocationVector& center, float maxRange, Filter accept, uint32_t& id) const;
+
+    /**
+     * @brief Find the nearest ID
+     * 
+     * @param center Center position
+     * @param maxRange Maximum distance
+     * @param id Receives the nearest ID
+     * @return true if found, false if the grid is empty within range
+     */
+    bool FindNearest(const LocationVector& center, float maxRange, uint32_t& id) const;
+
+    /**
+     * @brief Find the nearest IDs accepted by a filter
+     * 
+     * Same ring search as FindNearest; once count IDs are found the
+     * search radius shrinks to the farthest of them.
+     * 
+     * @param center Center position
+     * @param count Most IDs to find
+     * @param maxRange Maximum distance
+     * @param accept Called as accept(id); only IDs it returns true for are considered
+     * @param ids Vector to append the IDs to, nearest first
+     * @return Number of IDs appended
+     */
+    template<typename Filter>
+    size_t FindKNearest(const LocationVector& center, size_t count, float maxRange, Filter accept, std::vector<uint32_t>& ids) const;
+
+    /**
+     * @brief Find the nearest IDs
+     * 
+     * @param center Center position
+     * @param count Most IDs to find
+     * @param maxRange Maximum distance
+     * @param ids Vector to append the IDs to, nearest first
+     * @return Number of IDs appended
+     */
+    size_t FindKNearest(const LocationVector& center, size_t count, float maxRange, std::vector<uint32_t>& ids) const;
+
+private:
+    /**
+     * @brief Grid entry
+     */
+    struct Entry {
+        uint32_t id;          ///< ID
+        double x, y, z;       ///< Position
+    };
+
+    /**
+     * @brief Where an ID is stored
+     */
+    struct Slot {
+        uint64_t cell;        ///< Cell key
+        uint32_t index;       ///< Index in the cell's entries
+    };
+
+    typedef std::unordered_map<uint64_t, std::vector<Entry>> CellMap;
+
+    /**
+     * @brief Get the cell coordinate of a world coordinate
+     */
+    int32_t GetCellCoord(double value) const {
+        double cell = std::floor(value * m_inverseCellSize);
+        return int32_t(std::max(-2147483647.0, std::min(2147483647.0, cell)));
+    }
+
+    /**
+     * @brief Get the key of a cell
+     */
+    static uint64_t GetCellKey(int32_t cellX, int32_t cellY) {
+        return (uint64_t(uint32_t(cellX)) << 32) | uint32_t(cellY);
+    }
+
+    /**
+     * @brief Remove the entry at a slot, keeping the moved entry's slot valid
+     */
+    void RemoveEntry(const Slot& slot);
+
+    /**
+     * @brief Visit the entries of one cell within range
+     */
+    template<typename Visitor>
+    void VisitCell(const std::vector<Entry>& entries, const LocationVector& center, double rangeSq, Visitor& visit) const;
+
+    /**
+     * @brief Visit cells in rings around a position, nearest rings first
+     * 
+     * Stops once no unsearched cell can hold an entry within limitSq,
+     * which the visitor may shrink as it goes.
+     */
+    template<typename Visitor>
+    void SearchRings(const LocationVector& center, float maxRange, const double& limitSq, Visitor& visit) const;
+
+    CellMap m_cells;                                ///< Entries by cell key
+    std::unordered_map<uint32_t, Slot> m_entries;   ///< Slots by ID
+    double m_cellSize;                              ///< Cell edge length
+    double m_inverseCellSize;                       ///< 1 / cell edge length
+};
+
+template<typename Visitor>
+void SpatialHashGrid::VisitCell(const std::vector<Entry>& entries, const LocationVector& center, double rangeSq, Visitor& visit) const {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        double dx = entry.x - center.x;
+        double dy = entry.y - center.y;
+        double dz = entry.z - center.z;
+        double distanceSq = dx * dx + dy * dy + dz * dz;
+        if (distanceSq <= rangeSq) {
+            visit(entry.id, distanceSq);
+        }
+    }
+}
+
+template<typename Visitor>
+void SpatialHashGrid::QueryRange(const LocationVector& center, float range, Visitor visit) const {
+    if (m_cells.empty() || range < 0.0f) {
+        return;
+    }
+
+    double rangeSq = double(range) * range;
+    int64_t minX = GetCellCoord(center.x - range);
+    int64_t maxX = GetCellCoord(center.x + range);
+    int64_t minY = GetCellCoord(center.y - range);
+    int64_t maxY = GetCellCoord(center.y + range);
+
+    // A range covering more cells than are occupied is cheaper to answer
+    // from the occupied cells
+    if (uint64_t(maxX - minX + 1) * uint64_t(maxY - minY + 1) > m_cells.size()) {
+        for (CellMap::const_iterator cell = m_cells.begin(); cell != m_cells.end(); ++cell) {
+            int64_t cellX = int32_t(uint32_t(cell->first >> 32));
+            int64_t cellY = int32_t(uint32_t(cell->first));
+            if (cellX >= minX && cellX <= maxX && cellY >= minY && cellY <= maxY) {
+                VisitCell(cell->second, center, rangeSq, visit);
+            }
+        }
+        return;
+    }
+
+    for (int64_t cellX = minX; cellX <= maxX; ++cellX) {
+        for (int64_t cellY = minY; cellY <= maxY; ++cellY) {
+            CellMap::const_iterator cell = m_cells.find(GetCellKey(int32_t(cellX), int32_t(cellY)));
+            if (cell != m_cells.end()) {
+                VisitCell(cell->second, center, rangeSq, visit);
+            }
+        }
+    }
+}
+
+template<typename Visitor>
+void SpatialHashGrid::SearchRings(const LocationVector& center, float maxRange, const double& limitSq, Visitor& visit) const {
+    int64_t centerX = GetCellCoord(center.x);
+    int64_t centerY = GetCellCoord(center.y);
+    int64_t lastRing = std::max(std::max(centerX - GetCellCoord(center.x - maxRange), GetCellCoord(center.x + maxRange) - centerX),
+                                std::max(centerY - GetCellCoord(center.y - maxRange), GetCellCoord(center.y + maxRange) - centerY));
+    size_t cellsSearched = 0;
+
+    for (int64_t ring = 0; ring <= lastRing; ++ring) {
+        // Past as many lookups as there are occupied cells, finish with a
+        // pass over the occupied cells outside the searched block
+        if (cellsSearched > m_cells.size()) {
+            for (CellMap::const_iterator cell = m_cells.begin(); cell != m_cells.end(); ++cell) {
+                int64_t cellX = int32_t(uint32_t(cell->first >> 32));
+                int64_t cellY = int32_t(uint32_t(cell->first));
+                if (std::max(std::abs(cellX - centerX), std::abs(cellY - centerY)) >= ring) {
+                    VisitCell(cell->second, center, limitSq, visit);
+                }
+            }
+            return;
+        }
+
+        for (int64_t cellX = centerX - ring; cellX <= centerX + ring; ++cellX) {
+            // Whole rows at the top and bottom of the ring, the two end cells elsewhere
+            int64_t step = (cellX == centerX - ring || cellX == centerX + ring) ? 1 : std::max<int64_t>(2 * ring, 1);
+            for (int64_t cellY = centerY - ring; cellY <= centerY + ring; cellY += step) {
+                CellMap::const_iterator cell = m_cells.find(GetCellKey(int32_t(cellX), int32_t(cellY)));
+                if (cell != m_cells.end()) {
+                    VisitCell(cell->second, center, limitSq, visit);
+                }
+                ++cellsSearched;
+            }
+        }
+
+        // Anything outside the searched block is at least this far away
+        double edge = std::min(std::min(center.x - double(centerX - ring) * m_cellSize, double(centerX + ring + 1) * m_cellSize - center.x),
+                               std::min(center.y - double(centerY - ring) * m_cellSize, double(centerY + ring + 1) * m_cellSize - center.y));
+        if (edge * edge >= limitSq) {
+            return;
+        }
+    }
+}
+
+template<typename Filter>
+bool SpatialHashGrid::FindNearest(const LocationVector& center, float maxRange, Filter accept, uint32_t& id) const {
+    if (m_cells.empty() || maxRange < 0.0f) {
+        return false;
+    }
+
+    double bestSq = double(maxRange) * maxRange;
+    bool found = false;
+    auto nearest = [&](uint32_t candidate, double distanceSq) {
+        if ((!found || distanceSq < bestSq) && accept(candidate)) {
+            found = true;
+            bestSq = distanceSq;
+            id = candidate;
+        }
+    };
+
+    SearchRings(center, maxRange, bestSq, nearest);
+    return found;
+}
+
+template<typename Filter>
+size_t SpatialHashGrid::FindKNearest(const LocationVector& center, size_t count, float maxRange, Filter accept, std::vector<uint32_t>& ids) const {
+    if (m_cells.empty() || maxRange < 0.0f || !count) {
+        return 0;
+    }
+
+    // Max-heap of the closest candidates so far; once full, only closer
+    // ones are visited
+    std::vector<std::pair<double, uint32_t>> heap;
+    heap.reserve(count);
+    double limitSq = double(maxRange) * maxRange;
+    auto nearest = [&](uint32_t candidate, double distanceSq) {
+        if ((heap.size() < count || distanceSq < limitSq) && accept(candidate)) {
+            if (heap.size() == count) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+            heap.push_back(std::make_pair(distanceSq, candidate));
+            std::push_heap(heap.begin(), heap.end());
+            if (heap.size() == count) {
+                limitSq = heap.front().first;
+            }
+        }
+    };
+
+    SearchRings(center, maxRange, limitSq, nearest);
+
+    std::sort_heap(heap.begin(), heap.end());
+    for (size_t i = 0; i < heap.size(); ++i) {
+        ids.push_back(heap[i].second);
+    }
+    return heap.size();
+}
+
+#endif // _SPATIAL_HASH_GRID_H_
@@ -0,0 +1,192 @@
+#ifndef _SPATIAL_KERNELS_H_
+#define _SPATIAL_KERNELS_H_
+
+#include "LocationVector.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Shape tested by the spatial kernels
+ * 
+ * Test() is the scalar definition every kernel matches bit for bit. It
+ * works in float, like the ObjectStore positions it is run over, so the
+ * SIMD kernels test four or eight points per instruction; near the
+ * boundary it can differ from a LocationVector::DistanceSq check by a
+ * float rounding step. Callers that must agree with LocationVector, like
+ * ObjectStore::CollectInRange, widen the range and re-test the hits.
+ */
+struct SpatialQuery {
+    /**
+     * @brief Query shapes
+     */
+    enum Shape {
+        SHAPE_RANGE,        ///< Within range (3D distance)
+        SHAPE_RANGE_2D,     ///< Within range ignoring Z
+        SHAPE_CONE          ///< Within range (3D) and within the half angle of the facing (2D)
+    };
+
+    Shape shape;            ///< Shape
+    float x, y, z;          ///< Center or cone origin
+    float rangeSq;          ///< Squared range
+    float facingX;          ///< cos of the cone facing
+    float facingY;          ///< sin of the cone facing
+    float cosHalfAngle;     ///< cos of the cone half angle
+
+    /**
+     * @brief Points within range of a center
+     * 
+     * @param center Center position
+     * @param range Range in world units
+     * @return Query
+     */
+    static SpatialQuery Range(const LocationVector& center, float range) {
+        SpatialQuery query = { SHAPE_RANGE, float(center.x), float(center.y), float(center.z), range * range, 1.0f, 0.0f, -1.0f };
+        return query;
+    }
+
+    /**
+     * @brief Points within range of a center, ignoring height
+     * 
+     * @param center Center position
+     * @param range Range in world units
+     * @return Query
+     */
+    static SpatialQuery Range2D(const LocationVector& center, float range) {
+        SpatialQuery query = { SHAPE_RANGE_2D, float(center.x), float(center.y), float(center.z), range * range, 1.0f, 0.0f, -1.0f };
+        return query;
+    }
+
+    /**
+     * @brief Points in a cone of view
+     * 
+     * @param origin Cone origin; its orientation is the facing
+     * @param range Range in world units
+     * @param halfAngle Half the cone's opening angle in radians (0 to pi)
+     * @return Query
+     */
+    static SpatialQuery Cone(const LocationVector& origin, float range, float halfAngle) {
+        SpatialQuery query = { SHAPE_CONE, float(origin.x), float(origin.y), float(origin.z), range * range,
+                               float(std::cos(origin.o)), float(std::sin(origin.o)), std::cos(halfAngle) };
+        return query;
+    }
+
+    /**
+     * @brief Test one point
+     * 
+     * @param px Point X
+     * @param py Point Y
+     * @param pz Point Z
+     * @return true if the point is inside the shape
+     */
+    bool Test(float px, float py, float pz) const {
+        float dx = px - x;
+        float dy = py - y;
+        float dz = pz - z;
+        float distance2DSq = dx*dx + dy*dy;
+        switch (shape) {
+            case SHAPE_RANGE:
+                return distance2DSq + dz*dz <= rangeSq;
+            case SHAPE_RANGE_2D:
+                return distance2DSq <= rangeSq;
+            case SHAPE_CONE:
+                return distance2DSq + dz*dz <= rangeSq && dx*facingX + dy*facingY >= cosHalfAngle * std::sqrt(distance2DSq);
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Batch spatial tests over structure-of-arrays positions
+ * 
+ * Tests a SpatialQuery against count points given as separate x, y and
+ * z float arrays (e.g. an ObjectStore chunk) and reports the hits as a
+ * bitmask or an index list. SSE2 and AVX2 versions are picked at
+ * runtime from the CPU's features, with a scalar fallback; all of them
+ * give exactly the results of SpatialQuery::Test (see
+ * SpatialKernelsTest). (Building with FMA contraction enabled, e.g.
+ * -march=native, can let the compiler fuse the scalar arithmetic and
+ * move boundary cases by one rounding step.)
+ */
+class SpatialKernels {
+public:
+    /**
+     * @brief Kernel implementations
+     */
+    enum Implementation {
+        IMPL_SCALAR,
+        IMPL_SSE2,
+        IMPL_AVX2
+    };
+
+    /**
+     * @brief Test points and set a bit per hit
+     * 
+     * @param query Query
+     * @param x Point X coordinates
+     * @param y Point Y coordinates
+     * @param z Point Z coordinates
+     * @param count Number of points
+     * @param mask Receives (count + 63) / 64 words; bit i % 64 of word i / 64 is set for a hit on point i
+     */
+    static void FilterMask(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t count, uint64_t* mask);
+
+    /**
+     * @brief Test points and list the hits
+     * 
+     * @param query Query
+     * @param x Point X coordinates
+     * @param y Point Y coordinates
+     * @param z Point Z coordinates
+     * @param count Number of points
+     * @param indices Receives the indices of the hits in ascending order (room for count entries)
+     * @return Number of hits
+     */
+    static size_t Filter(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t count, uint32_t* indices);
+
+    /**
+     * @brief Get the index of the lowest set bit of a mask word
+     * 
+     * @param bits Mask word (non-zero)
+     * @return Bit index
+     */
+    static uint32_t LowestBit(uint64_t bits) {
+#if defined(__GNUC__)
+        return (uint32_t)__builtin_ctzll(bits);
+#else
+        uint32_t bit = 0;
+        while (!(bits & (uint64_t(1) << bit))) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    /**
+     * @brief Get the implementation in use
+     * 
+     * @return Implementation
+     */
+    static Implementation GetImplementation();
+
+    /**
+     * @brief Select an implementation
+     * 
+     * For comparing implementations; the best supported one is selected
+     * by default.
+     * 
+     * @param implementation Implementation
+     * @return true if selected, false if the CPU or build does not support it
+     */
+    static bool SetImplementation(Implementation implementation);
+
+    /**
+     * @brief Get the name of an implementation
+     * 
+     * @param implementation Implementation
+     * @return Name
+     */
+    static const char* GetImplementationName(Implementation implementation);
+};
+
+#endif // _SPATIAL_KERNELS_H_
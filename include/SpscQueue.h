@@ -0,0 +1,97 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Bounded lock-free single-producer single-consumer queue
+ * 
+ * Exactly one thread may push and exactly one (other) thread may pop.
+ * The capacity is rounded up to a power of two. The producer and the
+ * consumer indices live on separate cache lines so the two threads do
+ * not contend on the same line.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param capacity Minimum number of elements the queue can hold
+     */
+    explicit SpscQueue(size_t capacity) : m_head(0), m_tail(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    /**
+     * @brief Push an element (producer thread only)
+     * 
+     * The element is only moved from when the push succeeds.
+     * 
+     * @param value Element to push
+     * @return true if pushed, false if the queue is full
+     */
+    bool TryPush(T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop an element (consumer thread only)
+     * 
+     * @param value Receives the element
+     * @return true if an element was popped, false if the queue is empty
+     */
+    bool TryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Get the approximate number of queued elements
+     * 
+     * @return Number of elements
+     */
+    size_t GetSize() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the queue capacity
+     * 
+     * @return Capacity
+     */
+    size_t GetCapacity() const { return m_mask + 1; }
+
+private:
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+
+    std::vector<T> m_slots;                 ///< Ring storage
+    size_t m_mask;                          ///< Capacity - 1
+    char m_pad0[64];                        ///< Keeps m_head off the line above
+    std::atomic<size_t> m_head;             ///< Next slot to pop (consumer)
+    char m_pad1[64];                        ///< Keeps m_tail off m_head's line
+    std::atomic<size_t> m_tail;             ///< Next slot to push (producer)
+};
+
+#endif // _SPSC_QUEUE_H_
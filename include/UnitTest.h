@@ -0,0 +1,63 @@
+#ifndef _UNIT_TEST_H_
+#define _UNIT_TEST_H_
+
+#include <cstdio>
+
+/**
+ * @brief Checks for the standalone test programs
+ * 
+ * Each *Test.cpp beside the code it covers is its own program: it runs
+ * its checks from main() and returns UnitTest::Result(), non-zero if any
+ * check failed. They only need the headers and the units under test,
+ * e.g. g++ -std=c++11 -Iinclude src/network/ReliabilityWindowTest.cpp
+ */
+namespace UnitTest {
+
+/**
+ * @brief Number of checks run
+ */
+inline int& Checks() {
+    static int checks = 0;
+    return checks;
+}
+
+/**
+ * @brief Number of checks failed
+ */
+inline int& Failures() {
+    static int failures = 0;
+    return failures;
+}
+
+/**
+ * @brief Record a check
+ * 
+ * @param passed Check result
+ * @param file Source file
+ * @param line Source line
+ * @param expression Checked expression
+ */
+inline void Check(bool passed, const char* file, int line, const char* expression) {
+    ++Checks();
+    if (!passed) {
+        ++Failures();
+        printf("%s:%d: check failed: %s\n", file, line, expression);
+    }
+}
+
+/**
+ * @brief Print the summary
+ * 
+ * @param name Test program name
+ * @return Exit code, 0 if every check passed
+ */
+inline int Result(const char* name) {
+    printf("%s: %d checks, %d failed\n", name, Checks(), Failures());
+    return Failures() ? 1 : 0;
+}
+
+} // namespace UnitTest
+
+#define TEST_CHECK(expression) UnitTest::Check((expression), __FILE__, __LINE__, #expression)
+
+#endif // _UNIT_TEST_H_
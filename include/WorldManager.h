@@ -4,6 +4,9 @@
 #include "LocationVector.h"
 #include "GameObject.h"
 #include "NavMeshManager.h"
+#include "ConcurrentSlotTable.h"
+#include "EpochManager.h"
+#include "DistrictMembers.h"
 #include <map>
 #include <vector>
 #include <string>
@@ -21,12 +24,31 @@ struct DistrictData {
     std::vector<uint32_t> adjacentDistricts; ///< Adjacent district IDs
     std::vector<LocationVector> hardlinePositions; ///< Hardline teleport positions
     std::vector<LocationVector> spawnPositions; ///< Player spawn positions
+    LocationVector boundsMin = LocationVector(-32768.0, -32768.0, -32768.0); ///< Minimum corner, for LocationCodec
+    LocationVector boundsMax = LocationVector(32768.0, 32768.0, 32768.0);    ///< Maximum corner, for LocationCodec
+};
+
+/**
+ * @brief Read-only view of one district, published by WorldManager::Update
+ * 
+ * Holds no positions: range queries read the ObjectStore, so only a
+ * change of membership republishes it and moving objects cost nothing.
+ */
+struct DistrictSnapshot {
+    std::vector<std::shared_ptr<GameObject>> objects;  ///< Objects in the district
 };
 
 /**
  * @brief World manager
  * 
  * The WorldManager handles the game world state, objects, and spatial queries.
+ * 
+ * Lookups never block: GetObject reads a ConcurrentSlotTable,
+ * GetObjectsInRange and GetNearestObject the district's grid in the
+ * ObjectStore, and GetObjectsInDistrict the district's last published
+ * DistrictSnapshot,
+ * so it may lag the live indices by one Update. Writers (AddObject, RemoveObject, MoveObject, Update) are
+ * serialized by m_objectsMutex and never wait for readers.
  */
 class WorldManager {
 public:
@@ -43,6 +65,9 @@ public:
     /**
      * @brief Initialize the world manager
      * 
+     * Sets the ObjectStore grid cell size to World.GridCellSize before
+     * any object is created.
+     * 
      * @return true if successful, false otherwise
      */
     bool Initialize();
@@ -86,6 +111,9 @@ public:
     /**
      * @brief Remove a game object from the world
      * 
+     * O(1), and safe while Update is iterating the district: the object
+     * is dropped from the district set when the iteration ends.
+     * 
      * @param objectId Object ID to remove
      * @return true if successful, false otherwise
      */
@@ -94,6 +122,9 @@ public:
     /**
      * @brief Get a game object by ID
      * 
+     * An array lookup by the ID's slot index; stale IDs of destroyed
+     * objects find nothing. Lock-free and wait-free.
+     * 
      * @param objectId Object ID to find
      * @return Shared pointer to game object, or nullptr if not found
      */
@@ -102,14 +133,38 @@ public:
     /**
      * @brief Get all objects in a district
      * 
+     * Copied from the district's snapshot without taking a lock.
+     * 
      * @param districtId District ID to query
      * @return Vector of game objects in the district
      */
     std::vector<std::shared_ptr<GameObject>> GetObjectsInDistrict(uint8_t districtId);
     
+    /**
+     * @brief Move a game object
+     * 
+     * Sets the object's position and district. A district change also
+     * marks both districts for republishing; a move within the district
+     * does not. Range and nearest queries read the ObjectStore grid,
+     * which GameObject::SetPosition keeps current by itself, so only
+     * district changes need to come through here.
+     * 
+     * @param objectId Object ID to move
+     * @param position New position
+     * @param districtId New district ID
+     * @return true if successful, false if the object is not in the world
+     */
+    bool MoveObject(uint32_t objectId, const LocationVector& position, uint8_t districtId);
+    
     /**
      * @brief Get objects in range
      * 
+     * Answered by ObjectStore::CollectInRange over the cells of the
+     * district's grid around the position without taking a lock, then
+     * resolved with GetObject, which
+     * drops objects that are not in the world. Positions are the live
+     * ones, not those of the last Update.
+     * 
      * @param position Center position
      * @param range Range in world units
      * @param districtId District ID (must match position's district)
@@ -120,6 +175,10 @@ public:
     /**
      * @brief Get nearest object of a specific type
      * 
+     * Answered by ObjectStore::FindNearest, which searches the
+     * district's grid in rings of cells outwards from the position and
+     * only measures objects of that type, then resolved with GetObject.
+     * 
      * @param position Center position
      * @param objectType Object type to find
      * @param districtId District ID (must match position's district)
@@ -128,6 +187,18 @@ public:
      */
     std::shared_ptr<GameObject> GetNearestObject(const LocationVector& position, uint16_t objectType, uint8_t districtId, float maxRange = 100.0f);
     
+    /**
+     * @brief Get the nearest objects of a specific type
+     * 
+     * @param position Center position
+     * @param objectType Object type to find
+     * @param districtId District ID (must match position's district)
+     * @param count Most objects to return
+     * @param maxRange Maximum search range
+     * @return Up to count objects, nearest first
+     */
+    std::vector<std::shared_ptr<GameObject>> GetNearestObjects(const LocationVector& position, uint16_t objectType, uint8_t districtId, size_t count, float maxRange = 100.0f);
+    
     /**
      * @brief Find path between two points
      * 
@@ -178,6 +249,9 @@ public:
     /**
      * @brief Update the world
      * 
+     * Ends by publishing a new snapshot of every district that objects
+     * were added to or removed from, and collecting retired data.
+     * 
      * @param diff Time difference since last update in milliseconds
      */
     void Update(uint32_t diff);
@@ -196,26 +270,44 @@ private:
      * @return true if successful, false otherwise
      */
     bool LoadWorldObjects();
-
+    
+    /**
+     * @brief Publish snapshots of the districts marked in m_dirtyDistricts
+     * 
+     * Called with m_objectsMutex held.
+     */
+    void PublishSnapshots();
+    
     /**
      * @brief District data map
      */
     std::map<uint8_t, DistrictData> m_districts;
     
     /**
-     * @brief Game object map (ID to object)
+     * @brief Game objects by ID (generational handles from GameServer::AllocateObjectId), read lock-free
      */
-    std::map<uint32_t, std::shared_ptr<GameObject>> m_objects;
+    ConcurrentSlotTable<std::shared_ptr<GameObject>> m_objects;
     
     /**
-     * @brief Object map mutex
+     * @brief Serializes writers and guards the live indices below; lookups do not take it
      */
     std::mutex m_objectsMutex;
     
     /**
-     * @brief District objects map (district ID to object IDs)
+     * @brief Last published view of each district, read lock-free by lookups
+     */
+    RcuSnapshot<DistrictSnapshot> m_districtSnapshots[256];
+    
+    /**
+     * @brief Districts whose membership changed since their snapshot was published, guarded by m_objectsMutex
      */
-    std::map<uint8_t, std::vector<uint32_t>> m_districtObjects;
+    std::vector<bool> m_dirtyDistricts = std::vector<bool>(256, false);
+    
+    /**
+     * @brief Objects of each district (O(1) removal, stable iteration during Update)
+     */
+    std::map<uint8_t, DistrictMembers> m_districtObjects;
+
     
     /**
      * @brief NavMesh manager
@@ -49,12 +49,18 @@ void AuthServer::Start()
     // Get the listen port from config
     int port = sConfig.GetIntDefault("Auth.ListenPort", 10001);
     
+    // Select the socket readiness backend
+    std::string pollBackend = "epoll";
+    sConfig.GetString("Network.PollBackend", &pollBackend);
+    authSocketHandler.SetPollBackend(pollBackend);
+    
     // Create the listen socket
     listenSocketInst = new AuthListenSocket(authSocketHandler);
     
     // Bind and listen
     if (listenSocketInst->Bind(port))
     {
+        authSocketHandler.RegisterSocket(listenSocketInst);
         INFO_LOG(format("Auth server listening on port %1%") % port);
     }
     else
@@ -70,6 +76,7 @@ void AuthServer::Stop()
     // Close the listen socket
     if (listenSocketInst)
     {
+        authSocketHandler.UnregisterSocket(listenSocketInst);
         delete listenSocketInst;
         listenSocketInst = nullptr;
     }
@@ -79,10 +86,11 @@ void AuthServer::Stop()
 
 void AuthServer::Loop()
 {
-    // Process socket events
+    // Process socket events, waking up early for the next socket deadline;
+    // Poll also adopts accepted sockets and deletes closed ones
     if (listenSocketInst)
     {
-        authSocketHandler.Select(0, 50000);
+        authSocketHandler.Poll(50);
     }
 }
 
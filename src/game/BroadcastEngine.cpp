@@ -0,0 +1,143 @@
+#include "../../include/BroadcastEngine.h"
+#include "../../include/GameSocket.h"
+#include "../../include/GameHandler.h"
+#include "../../include/GameShard.h"
+#include "../../include/InterestManager.h"
+#include "../../include/Log.h"
+
+BroadcastEngine::BroadcastEngine()
+    : m_messagesSerialized(0)
+    , m_bytesSerialized(0)
+    , m_packetsSent(0)
+    , m_bytesSent(0)
+{
+}
+
+ByteBufferChain::SharedBuffer BroadcastEngine::Serialize(const MessageBase& message)
+{
+    std::shared_ptr<ByteBuffer> block = std::make_shared<ByteBuffer>();
+    block->reserve(BLOCK_HEADER_SIZE + message.GetSerializedSize());
+
+    // Block header, length is patched once the data is written
+    *block << uint16_t(message.GetType());
+    *block << uint16_t(0);
+    SerializeMessage(message, *block);
+    if (!PatchBlockLength(*block))
+    {
+        ERROR_LOG(format("Message type %1% is %2% bytes, too large for a block; not sent") % message.GetType() % (block->wpos() - BLOCK_HEADER_SIZE));
+        return ByteBufferChain::SharedBuffer();
+    }
+
+    m_messagesSerialized.fetch_add(1, std::memory_order_relaxed);
+    m_bytesSerialized.fetch_add(block->wpos(), std::memory_order_relaxed);
+
+    return block;
+}
+
+void BroadcastEngine::Send(uint16_t type, const ByteBufferChain::SharedBuffer& block, const std::vector<GameSocket*>& recipients, bool reliable, bool encrypted)
+{
+    if (!block)
+    {
+        return;
+    }
+
+    uint64_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+
+    for (size_t i = 0; i < recipients.size(); ++i)
+    {
+        GameSocket* socket = recipients[i];
+        if (!socket || !socket->IsInWorld())
+        {
+            continue;
+        }
+
+        bytesSent += socket->SendSharedMessage(type, block, reliable, encrypted);
+        ++packetsSent;
+    }
+
+    m_packetsSent.fetch_add(packetsSent, std::memory_order_relaxed);
+    m_bytesSent.fetch_add(bytesSent, std::memory_order_relaxed);
+}
+
+void BroadcastEngine::BroadcastToDistrict(GameHandler& handler, uint8_t district, const MessageBase& message, uint32_t exceptId)
+{
+    std::vector<GameSocket*> recipients;
+    handler.GetSocketsInDistrict(district, recipients, exceptId);
+    if (recipients.empty())
+    {
+        return;
+    }
+
+    Send(message.GetType(), Serialize(message), recipients);
+}
+
+void BroadcastEngine::BroadcastToAll(GameHandler& handler, const MessageBase& message, uint32_t exceptId)
+{
+    std::vector<GameSocket*> recipients;
+    handler.GetAllSockets(recipients, exceptId);
+    if (recipients.empty())
+    {
+        return;
+    }
+
+    Send(message.GetType(), Serialize(message), recipients);
+}
+
+void BroadcastEngine::BroadcastToObservers(GameHandler& handler, const InterestManager& interest, uint32_t objectId, const MessageBase& message, bool reliable, bool encrypted)
+{
+    std::vector<uint32_t> observers;
+    interest.GetObservers(objectId, observers);
+    if (observers.empty())
+    {
+        return;
+    }
+
+    std::vector<GameSocket*> recipients;
+    recipients.reserve(observers.size());
+    for (size_t i = 0; i < observers.size(); ++i)
+    {
+        if (GameSocket* socket = handler.FindSocketByPlayerId(observers[i]))
+        {
+            recipients.push_back(socket);
+        }
+    }
+
+    Send(message.GetType(), Serialize(message), recipients, reliable, encrypted);
+}
+
+void BroadcastEngine::BroadcastToObservers(GameShardSet& shards, const InterestManager& interest, uint32_t objectId, const MessageBase& message, bool reliable, bool encrypted)
+{
+    std::vector<uint32_t> observers;
+    interest.GetObservers(objectId, observers);
+    if (observers.empty())
+    {
+        return;
+    }
+
+    ByteBufferChain::SharedBuffer block = Serialize(message);
+    if (!block)
+    {
+        return;
+    }
+
+    uint64_t packetsSent = 0;
+    for (size_t i = 0; i < observers.size(); ++i)
+    {
+        if (shards.SendToPlayer(observers[i], message.GetType(), block, reliable, encrypted))
+        {
+            ++packetsSent;
+        }
+    }
+
+    m_packetsSent.fetch_add(packetsSent, std::memory_order_relaxed);
+    m_bytesSent.fetch_add(packetsSent * block->wpos(), std::memory_order_relaxed);
+}
+
+void BroadcastEngine::GetStats(Stats& stats) const
+{
+    stats.messagesSerialized = m_messagesSerialized.load(std::memory_order_relaxed);
+    stats.bytesSerialized = m_bytesSerialized.load(std::memory_order_relaxed);
+    stats.packetsSent = m_packetsSent.load(std::memory_order_relaxed);
+    stats.bytesSent = m_bytesSent.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,92 @@
+#include "../../include/DistrictMembers.h"
+#include "../../include/GameObject.h"
+
+#include <algorithm>
+
+DistrictMembers::DistrictMembers()
+    : m_iterating(0)
+{
+}
+
+bool DistrictMembers::Add(GameObject& object)
+{
+    if (object.GetDistrictIndex() != NO_INDEX)
+    {
+        return false;
+    }
+
+    object.SetDistrictIndex(uint32_t(m_members.size()));
+    Member member = { object.GetObjectId(), &object };
+    m_members.push_back(member);
+    return true;
+}
+
+bool DistrictMembers::Remove(GameObject& object)
+{
+    if (!Contains(object))
+    {
+        return false;
+    }
+
+    uint32_t index = object.GetDistrictIndex();
+    object.SetDistrictIndex(NO_INDEX);
+
+    if (m_iterating)
+    {
+        // Leave a hole for the iteration to skip; EndIteration compacts
+        m_members[index].objectId = 0;
+        m_members[index].object = nullptr;
+        m_removed.push_back(index);
+        return true;
+    }
+
+    Erase(index);
+    return true;
+}
+
+bool DistrictMembers::Contains(const GameObject& object) const
+{
+    uint32_t index = object.GetDistrictIndex();
+    return index < m_members.size() && m_members[index].object == &object;
+}
+
+void DistrictMembers::EndIteration()
+{
+    if (!m_iterating || --m_iterating)
+    {
+        return;
+    }
+
+    // Highest first, so every hole above the one being filled is gone
+    // and the member moved into it is live
+    std::sort(m_removed.begin(), m_removed.end());
+    for (std::vector<uint32_t>::reverse_iterator itr = m_removed.rbegin(); itr != m_removed.rend(); ++itr)
+    {
+        Erase(*itr);
+    }
+    m_removed.clear();
+}
+
+void DistrictMembers::Clear()
+{
+    for (size_t i = 0; i < m_members.size(); ++i)
+    {
+        if (m_members[i].object)
+        {
+            m_members[i].object->SetDistrictIndex(NO_INDEX);
+        }
+    }
+    m_members.clear();
+    m_removed.clear();
+}
+
+void DistrictMembers::Erase(uint32_t index)
+{
+    uint32_t last = uint32_t(m_members.size() - 1);
+    if (index != last)
+    {
+        m_members[index] = m_members[last];
+        m_members[index].object->SetDistrictIndex(index);
+    }
+    m_members.pop_back();
+}
@@ -0,0 +1,176 @@
+#include "../../include/EpochManager.h"
+
+namespace {
+
+/**
+ * @brief Retired items that trigger a collection from Retire
+ */
+const size_t COLLECT_THRESHOLD = 1024;
+
+} // namespace
+
+EpochManager& EpochManager::getSingleton()
+{
+    // Deliberately leaked, see the header
+    static EpochManager* manager = new EpochManager();
+    return *manager;
+}
+
+EpochManager::EpochManager()
+    : m_epoch(1),
+      m_overflowReaders(0)
+{
+    for (uint32_t i = 0; i < MAX_READERS; ++i)
+    {
+        m_readers[i].epoch.store(0, std::memory_order_relaxed);
+        m_readers[i].claimed.store(false, std::memory_order_relaxed);
+    }
+}
+
+EpochManager::ThreadState::~ThreadState()
+{
+    if (record)
+    {
+        record->epoch.store(0, std::memory_order_release);
+        record->claimed.store(false, std::memory_order_release);
+    }
+}
+
+EpochManager::ThreadState& EpochManager::GetThreadState()
+{
+    static thread_local ThreadState state;
+    if (!state.registered)
+    {
+        state.registered = true;
+        for (uint32_t i = 0; i < MAX_READERS; ++i)
+        {
+            bool expected = false;
+            if (m_readers[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            {
+                state.record = &m_readers[i];
+                break;
+            }
+        }
+    }
+    return state;
+}
+
+void EpochManager::Enter()
+{
+    ThreadState& state = GetThreadState();
+    if (state.depth++)
+    {
+        return;
+    }
+
+    if (state.record)
+    {
+        state.record->epoch.store(m_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+    else
+    {
+        m_overflowReaders.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pairs with the fences in Retire and TryAdvance: either the collector
+    // sees this reader, or this reader sees every unlink before the scan
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void EpochManager::Leave()
+{
+    ThreadState& state = GetThreadState();
+    if (--state.depth)
+    {
+        return;
+    }
+
+    if (state.record)
+    {
+        state.record->epoch.store(0, std::memory_order_release);
+    }
+    else
+    {
+        m_overflowReaders.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void EpochManager::Retire(void* pointer, void (*deleter)(void*))
+{
+    // The caller's unlink must be ordered before any later epoch scan
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool collect;
+    {
+        std::lock_guard<std::mutex> lock(m_retiredMutex);
+        Retired retired = { pointer, deleter, m_epoch.load(std::memory_order_relaxed) };
+        m_retired.push_back(retired);
+        collect = m_retired.size() >= COLLECT_THRESHOLD;
+    }
+
+    if (collect)
+    {
+        Collect();
+    }
+}
+
+bool EpochManager::TryAdvance()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_overflowReaders.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < MAX_READERS; ++i)
+    {
+        uint64_t entered = m_readers[i].epoch.load(std::memory_order_acquire);
+        if (entered && entered != epoch)
+        {
+            return false;
+        }
+    }
+
+    m_epoch.store(epoch + 1, std::memory_order_release);
+    return true;
+}
+
+size_t EpochManager::Collect()
+{
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_retiredMutex);
+
+        // Two advances free what was retired in the current epoch when no
+        // reader is inside a guard
+        if (TryAdvance())
+        {
+            TryAdvance();
+        }
+
+        uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (count < m_retired.size() && m_retired[count].epoch + 2 <= epoch)
+        {
+            ++count;
+        }
+
+        ready.assign(m_retired.begin(), m_retired.begin() + count);
+        m_retired.erase(m_retired.begin(), m_retired.begin() + count);
+    }
+
+    // Deleters run unlocked; they may release objects that retire more
+    for (size_t i = 0; i < ready.size(); ++i)
+    {
+        ready[i].deleter(ready[i].pointer);
+    }
+    return ready.size();
+}
+
+size_t EpochManager::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_retiredMutex);
+    return m_retired.size();
+}
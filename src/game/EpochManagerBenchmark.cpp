@@ -0,0 +1,249 @@
+#include "../../include/ConcurrentSlotTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Stand-in for a player or object looked up by id
+ */
+struct Value
+{
+    uint32_t id;
+    uint32_t district;
+};
+
+typedef std::shared_ptr<Value> ValuePtr;
+
+/**
+ * @brief Deterministic generator so runs compare
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint32_t Next(uint32_t range)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)((state >> 33) % range);
+    }
+};
+
+/**
+ * @brief Map behind a mutex, as GetPlayer and GetObject were before the table
+ */
+class LockedMap
+{
+public:
+    void Insert(uint32_t id, const ValuePtr& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_values[id] = value;
+    }
+
+    void Erase(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_values.erase(id);
+    }
+
+    ValuePtr Get(uint32_t id) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unordered_map<uint32_t, ValuePtr>::const_iterator it = m_values.find(id);
+        return it != m_values.end() ? it->second : ValuePtr();
+    }
+
+private:
+    std::unordered_map<uint32_t, ValuePtr> m_values;
+    mutable std::mutex m_mutex;
+};
+
+/**
+ * @brief ConcurrentSlotTable with its handle allocator, as GameServer holds players
+ */
+class SlotTable
+{
+public:
+    uint32_t Allocate() { return m_handles.Allocate(); }
+
+    void Insert(uint32_t id, const ValuePtr& value) { m_values.Insert(id, value); }
+
+    void Erase(uint32_t id)
+    {
+        m_values.Erase(id);
+        m_handles.Release(id);
+    }
+
+    ValuePtr Get(uint32_t id) const { return m_values.Get(id); }
+
+private:
+    SlotHandleAllocator m_handles;
+    ConcurrentSlotTable<ValuePtr> m_values;
+};
+
+/**
+ * @brief Id source for LockedMap, which has no allocator of its own
+ */
+struct CountingIds
+{
+    uint32_t next;
+
+    CountingIds() : next(1) {}
+
+    uint32_t Allocate() { return next++; }
+};
+
+uint32_t AllocateId(SlotTable& table, CountingIds&) { return table.Allocate(); }
+uint32_t AllocateId(LockedMap&, CountingIds& ids) { return ids.Allocate(); }
+
+/**
+ * @brief Result of one run
+ */
+struct Result
+{
+    std::vector<uint64_t> lookups;
+    uint64_t hits;
+    uint64_t replaced;
+    double seconds;
+};
+
+/**
+ * @brief Run readers against a writer that keeps replacing objects
+ *
+ * The ids readers pick from live in a shared array the writer updates
+ * after each replacement, so most lookups hit and the rest find an id
+ * that was just erased, as a socket thread racing a logout does.
+ */
+template<typename Table>
+Result Run(size_t readers, uint32_t objects, double seconds, bool writing)
+{
+    Table table;
+    CountingIds ids;
+    std::unique_ptr<std::atomic<uint32_t>[]> live(new std::atomic<uint32_t>[objects]);
+    for (uint32_t i = 0; i < objects; ++i)
+    {
+        uint32_t id = AllocateId(table, ids);
+        ValuePtr value(new Value());
+        value->id = id;
+        value->district = i % 8;
+        table.Insert(id, value);
+        live[i].store(id, std::memory_order_relaxed);
+    }
+
+    Result result = Result();
+    result.lookups.resize(readers, 0);
+    std::vector<uint64_t> hits(readers, 0);
+    std::atomic<bool> stop(false);
+
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r)
+    {
+        threads.push_back(std::thread([&, r]() {
+            Random random(42 + r);
+            uint64_t lookups = 0, found = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                for (size_t i = 0; i < 256; ++i)
+                {
+                    uint32_t id = live[random.Next(objects)].load(std::memory_order_relaxed);
+                    ValuePtr value = table.Get(id);
+                    found += value && value->id == id;
+                }
+                lookups += 256;
+            }
+            result.lookups[r] = lookups;
+            hits[r] = found;
+        }));
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    if (writing)
+    {
+        // Logouts and logins back to back, as fast as the writer can go
+        Random random(7);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            for (size_t i = 0; i < 64; ++i)
+            {
+                uint32_t index = random.Next(objects);
+                table.Erase(live[index].load(std::memory_order_relaxed));
+                uint32_t id = AllocateId(table, ids);
+                ValuePtr value(new Value());
+                value->id = id;
+                value->district = index % 8;
+                table.Insert(id, value);
+                live[index].store(id, std::memory_order_relaxed);
+            }
+            result.replaced += 64;
+        }
+    }
+    else
+    {
+        std::this_thread::sleep_until(end);
+    }
+    stop.store(true);
+    for (size_t r = 0; r < threads.size(); ++r)
+    {
+        threads[r].join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t r = 0; r < readers; ++r)
+    {
+        result.hits += hits[r];
+    }
+    return result;
+}
+
+template<typename Table>
+void Report(const char* label, size_t readers, uint32_t objects, double seconds, bool writing)
+{
+    Result result = Run<Table>(readers, objects, seconds, writing);
+
+    uint64_t total = 0, slowest = result.lookups[0];
+    for (size_t r = 0; r < readers; ++r)
+    {
+        total += result.lookups[r];
+        slowest = result.lookups[r] < slowest ? result.lookups[r] : slowest;
+    }
+    printf("%-13s %zu readers, %-9s: %6.2f M lookups/s per reader (slowest %6.2f), %7.2f M/s total, "
+           "%.1f%% hits, %7.0f replacements/s\n",
+           label, readers, writing ? "writer" : "no writer",
+           total / result.seconds / readers / 1e6, slowest / result.seconds / 1e6, total / result.seconds / 1e6,
+           100.0 * result.hits / (total ? total : 1), result.replaced / result.seconds);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    uint32_t objects = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 10000;
+    size_t readers = argc > 3 ? strtoul(argv[3], NULL, 10) : 8;
+    if (!objects || !readers)
+    {
+        printf("need at least one object and one reader\n");
+        return 1;
+    }
+
+    // One reader shows the uncontended cost; the full reader count with
+    // a writer replacing objects is the peak-hour case
+    Report<LockedMap>("mutex map", 1, objects, seconds, true);
+    Report<SlotTable>("epoch table", 1, objects, seconds, true);
+    Report<LockedMap>("mutex map", readers, objects, seconds, false);
+    Report<SlotTable>("epoch table", readers, objects, seconds, false);
+    Report<LockedMap>("mutex map", readers, objects, seconds, true);
+    Report<SlotTable>("epoch table", readers, objects, seconds, true);
+    return 0;
+}
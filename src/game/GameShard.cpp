@@ -0,0 +1,330 @@
+#include "../../include/GameShard.h"
+#include "../../include/GameSocket.h"
+#include "../../include/Log.h"
+#include "../../include/Config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Open a non-blocking UDP socket bound to the game port
+ * 
+ * @param port Game port
+ * @param reusePort Join the SO_REUSEPORT group of the port
+ * @return Socket descriptor, or -1 on failure
+ */
+static int OpenShardSocket(uint16_t port, bool reusePort)
+{
+#ifdef _WIN32
+    (void)port;
+    (void)reusePort;
+    return -1;
+#else
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+    if (reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+#else
+    if (reusePort)
+    {
+        close(fd);
+        return -1;
+    }
+#endif
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+#endif
+}
+
+/**
+ * @brief Get the current monotonic time in milliseconds
+ * 
+ * @return Time in milliseconds, wrapping like the session timers
+ */
+static uint32_t GetTimeMs()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+GameShard::GameShard(uint32_t index, size_t queueSize)
+    : m_index(index)
+    , m_fd(-1)
+    , m_commands(queueSize)
+    , m_outbound(queueSize)
+    , m_running(false)
+    , m_connections(0)
+{
+    m_handler.SetShard(this);
+}
+
+GameShard::~GameShard()
+{
+    Stop();
+}
+
+bool GameShard::Start(uint16_t port, size_t batchSize, const std::string& pollBackend)
+{
+    m_fd = OpenShardSocket(port, true);
+    if (m_fd < 0)
+    {
+        ERROR_LOG(format("Game shard %1% failed to bind port %2% (%3%)") % m_index % port % strerror(errno));
+        return false;
+    }
+
+    m_poll.reset(PollBackend::Create(pollBackend));
+    m_poll->Add(m_fd, PollBackend::POLL_READ);
+    m_handler.EnableBatchedIO(batchSize);
+
+    m_running = true;
+    m_thread = std::thread(&GameShard::Run, this);
+    return true;
+}
+
+void GameShard::Stop()
+{
+    m_running = false;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    if (m_fd >= 0)
+    {
+#ifndef _WIN32
+        close(m_fd);
+#endif
+        m_fd = -1;
+    }
+}
+
+void GameShard::PushCommand(uint32_t playerId, uint16_t type, ByteBuffer&& data)
+{
+    GameCommand command;
+    command.shard = m_index;
+    command.playerId = playerId;
+    command.type = type;
+    command.data = std::move(data);
+
+    // Keep ordering: once something is pending, everything goes behind it
+    if (!m_pending.empty() || !m_commands.TryPush(command))
+    {
+        m_pending.push_back(std::move(command));
+    }
+}
+
+void GameShard::FlushPendingCommands()
+{
+    while (!m_pending.empty() && m_commands.TryPush(m_pending.front()))
+    {
+        m_pending.pop_front();
+    }
+}
+
+void GameShard::DrainOutbound()
+{
+    GameOutbound outbound;
+    while (m_outbound.TryPop(outbound))
+    {
+        if (outbound.playerId)
+        {
+            GameSocket* socket = m_handler.FindSocketByPlayerId(outbound.playerId);
+            if (socket)
+            {
+                socket->SendSharedMessage(outbound.type, outbound.block, outbound.reliable, outbound.encrypted);
+            }
+            continue;
+        }
+
+        m_recipients.clear();
+        m_handler.GetAllSockets(m_recipients);
+        for (size_t i = 0; i < m_recipients.size(); ++i)
+        {
+            m_recipients[i]->SendSharedMessage(outbound.type, outbound.block, outbound.reliable, outbound.encrypted);
+        }
+    }
+}
+
+void GameShard::Run()
+{
+    INFO_LOG(format("Game shard %1% started") % m_index);
+
+    std::vector<PollBackend::Event> events;
+    std::chrono::steady_clock::time_point lastUpdate = std::chrono::steady_clock::now();
+
+    while (m_running)
+    {
+        DrainOutbound();
+
+        m_poll->Wait(events, 5);
+        m_handler.GetBatchedIO()->Receive(m_fd,
+            [this](const char* data, size_t length, struct sockaddr* addr, socklen_t addrLen)
+            {
+                m_handler.ProcessDatagram(data, length, addr, addrLen);
+            });
+
+        // Resends, acknowledgments and timeouts for the shard's sessions
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        uint32_t diff = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(now - lastUpdate).count();
+        lastUpdate = now;
+        m_handler.Update(diff);
+
+        // Pack the drained blocks, resends and acks into packets, then
+        // send them in one batch
+        m_handler.FlushOutbound(GetTimeMs());
+        FlushPendingCommands();
+        m_handler.FlushBatchedIO(m_fd);
+        m_connections.store(m_handler.GetConnectionCount(), std::memory_order_relaxed);
+    }
+
+    INFO_LOG(format("Game shard %1% stopped") % m_index);
+}
+
+GameShardSet::GameShardSet()
+{
+}
+
+GameShardSet::~GameShardSet()
+{
+    Stop();
+}
+
+size_t GameShardSet::Start(uint16_t port, size_t count, size_t queueSize)
+{
+    size_t batchSize = 1;
+    if (sConfig.GetIntDefault("Game.BatchedIO", 1))
+    {
+        batchSize = (size_t)std::max(1, sConfig.GetIntDefault("Game.IOBatchSize", 64));
+    }
+
+    std::string pollBackend = "epoll";
+    sConfig.GetString("Network.PollBackend", &pollBackend);
+
+#ifndef SO_REUSEPORT
+    if (count > 1)
+    {
+        ERROR_LOG("SO_REUSEPORT is not available, using a single game shard");
+        count = 1;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::unique_ptr<GameShard> shard(new GameShard((uint32_t)i, queueSize));
+        if (!shard->Start(port, batchSize, pollBackend))
+        {
+            break;
+        }
+        m_shards.push_back(std::move(shard));
+    }
+
+    INFO_LOG(format("Started %1% of %2% game shards on port %3%, %4% datagrams per system call") % m_shards.size() % count % port % batchSize);
+    return m_shards.size();
+}
+
+void GameShardSet::Stop()
+{
+    m_shards.clear();
+    m_playerShards.clear();
+}
+
+size_t GameShardSet::GetConnectionCount() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        total += m_shards[i]->GetConnectionCount();
+    }
+    return total;
+}
+
+size_t GameShardSet::DrainCommands(const CommandCallback& callback, size_t maxCommands)
+{
+    size_t total = 0;
+    GameCommand command;
+
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        for (size_t n = 0; n < maxCommands && m_shards[i]->PopCommand(command); ++n)
+        {
+            if (command.playerId)
+            {
+                m_playerShards[command.playerId] = command.shard;
+            }
+
+            callback(command);
+            ++total;
+        }
+    }
+
+    return total;
+}
+
+bool GameShardSet::SendToPlayer(uint32_t playerId, uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, bool encrypted)
+{
+    std::map<uint32_t, uint32_t>::const_iterator itr = m_playerShards.find(playerId);
+    if (itr == m_playerShards.end())
+    {
+        return false;
+    }
+
+    GameOutbound outbound;
+    outbound.playerId = playerId;
+    outbound.type = type;
+    outbound.block = block;
+    outbound.reliable = reliable;
+    outbound.encrypted = encrypted;
+    return m_shards[itr->second]->PushOutbound(outbound);
+}
+
+void GameShardSet::SendToAll(uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, bool encrypted)
+{
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        GameOutbound outbound;
+        outbound.playerId = 0;
+        outbound.type = type;
+        outbound.block = block;
+        outbound.reliable = reliable;
+        outbound.encrypted = encrypted;
+        if (!m_shards[i]->PushOutbound(outbound))
+        {
+            ERROR_LOG(format("Game shard %1% outbound queue full, broadcast dropped") % i);
+        }
+    }
+}
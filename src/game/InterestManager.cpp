@@ -0,0 +1,262 @@
+#include "../../include/InterestManager.h"
+#include "../../include/WorldManager.h"
+#include "../../include/GameObject.h"
+#include "../../include/ObjectStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+InterestManager::InterestManager(float enterRange, float leaveRange)
+    : m_enterRange(enterRange)
+    , m_leaveRange(std::max(enterRange, leaveRange))
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void InterestManager::SetRanges(float enterRange, float leaveRange)
+{
+    m_enterRange = enterRange;
+    leaveRange = std::max(enterRange, leaveRange);
+    if (leaveRange != m_leaveRange)
+    {
+        m_leaveRange = leaveRange;
+        for (std::unordered_map<uint8_t, SpatialHashGrid>::iterator grid = m_grids.begin(); grid != m_grids.end(); ++grid)
+        {
+            grid->second.SetCellSize(m_leaveRange);
+        }
+    }
+}
+
+void InterestManager::AddObserver(uint32_t playerId, uint32_t objectId, const LocationVector& position, uint8_t district)
+{
+    if (m_observers.count(playerId))
+    {
+        MoveObserver(playerId, position, district);
+        return;
+    }
+
+    Observer& observer = m_observers[playerId];
+    observer.objectId = objectId;
+    observer.position = position;
+    observer.district = district;
+    GetGrid(district).Insert(playerId, position);
+}
+
+void InterestManager::MoveObserver(uint32_t playerId, const LocationVector& position, uint8_t district)
+{
+    std::unordered_map<uint32_t, Observer>::iterator itr = m_observers.find(playerId);
+    if (itr == m_observers.end())
+    {
+        return;
+    }
+
+    Observer& observer = itr->second;
+    if (district != observer.district)
+    {
+        GetGrid(observer.district).Remove(playerId);
+    }
+    GetGrid(district).Insert(playerId, position);
+    observer.position = position;
+    observer.district = district;
+}
+
+void InterestManager::RemoveObserver(uint32_t playerId, const TransitionCallback& onLeave)
+{
+    std::unordered_map<uint32_t, Observer>::iterator itr = m_observers.find(playerId);
+    if (itr == m_observers.end())
+    {
+        return;
+    }
+
+    Observer& observer = itr->second;
+
+    // The player's own object leaves everyone else's view
+    RemoveObject(observer.objectId, onLeave);
+
+    // Nobody needs to be told what the departing player stops seeing
+    for (std::unordered_set<uint32_t>::const_iterator object = observer.visible.begin(); object != observer.visible.end(); ++object)
+    {
+        std::unordered_map<uint32_t, std::unordered_set<uint32_t>>::iterator observedBy = m_observedBy.find(*object);
+        if (observedBy != m_observedBy.end())
+        {
+            observedBy->second.erase(playerId);
+            if (observedBy->second.empty())
+            {
+                m_observedBy.erase(observedBy);
+            }
+        }
+    }
+
+    GetGrid(observer.district).Remove(playerId);
+    m_observers.erase(itr);
+}
+
+void InterestManager::RemoveObject(uint32_t objectId, const TransitionCallback& onLeave)
+{
+    std::unordered_map<uint32_t, std::unordered_set<uint32_t>>::iterator itr = m_observedBy.find(objectId);
+    if (itr == m_observedBy.end())
+    {
+        return;
+    }
+
+    std::unordered_set<uint32_t> observers;
+    observers.swap(itr->second);
+    m_observedBy.erase(itr);
+
+    for (std::unordered_set<uint32_t>::const_iterator playerId = observers.begin(); playerId != observers.end(); ++playerId)
+    {
+        std::unordered_map<uint32_t, Observer>::iterator observer = m_observers.find(*playerId);
+        if (observer != m_observers.end())
+        {
+            observer->second.visible.erase(objectId);
+        }
+        ++m_stats.leaves;
+        if (onLeave)
+        {
+            onLeave(*playerId, objectId);
+        }
+    }
+}
+
+void InterestManager::Update(WorldManager& world, const TransitionCallback& onEnter, const TransitionCallback& onLeave)
+{
+    double enterSq = double(m_enterRange) * m_enterRange;
+    double leaveSq = double(m_leaveRange) * m_leaveRange;
+    std::unordered_set<uint32_t> next;
+    uint64_t candidates = 0;
+
+    for (std::unordered_map<uint32_t, Observer>::iterator itr = m_observers.begin(); itr != m_observers.end(); ++itr)
+    {
+        uint32_t playerId = itr->first;
+        Observer& observer = itr->second;
+        next.clear();
+
+        // An object stays in view up to the leave range but only enters
+        // within the enter range. The store also holds objects that are
+        // not in the world, which GetObject does not find.
+        m_candidates.clear();
+        sObjectStore.CollectInRange(observer.position, m_leaveRange, observer.district, true, m_candidates);
+        for (size_t i = 0; i < m_candidates.size(); ++i)
+        {
+            uint32_t objectId = m_candidates[i];
+            std::shared_ptr<GameObject> object;
+            if (objectId == observer.objectId || !(object = world.GetObject(objectId)))
+            {
+                continue;
+            }
+
+            double distanceSq = observer.position.DistanceSq(object->GetPosition());
+            if (distanceSq <= enterSq || (distanceSq <= leaveSq && observer.visible.count(objectId)))
+            {
+                next.insert(objectId);
+            }
+        }
+        candidates += m_candidates.size();
+
+        // Other players
+        GetGrid(observer.district).QueryRange(observer.position, m_leaveRange, [&](uint32_t otherId, double distanceSq) {
+            if (otherId == playerId)
+            {
+                return;
+            }
+
+            const Observer& other = m_observers[otherId];
+            if (distanceSq <= enterSq || (distanceSq <= leaveSq && observer.visible.count(other.objectId)))
+            {
+                next.insert(other.objectId);
+            }
+            ++candidates;
+        });
+
+        m_entered.clear();
+        m_left.clear();
+        for (std::unordered_set<uint32_t>::const_iterator object = next.begin(); object != next.end(); ++object)
+        {
+            if (!observer.visible.count(*object))
+            {
+                m_entered.push_back(*object);
+            }
+        }
+        for (std::unordered_set<uint32_t>::const_iterator object = observer.visible.begin(); object != observer.visible.end(); ++object)
+        {
+            if (!next.count(*object))
+            {
+                m_left.push_back(*object);
+            }
+        }
+        observer.visible.swap(next);
+
+        for (size_t i = 0; i < m_left.size(); ++i)
+        {
+            std::unordered_map<uint32_t, std::unordered_set<uint32_t>>::iterator observedBy = m_observedBy.find(m_left[i]);
+            if (observedBy != m_observedBy.end())
+            {
+                observedBy->second.erase(playerId);
+                if (observedBy->second.empty())
+                {
+                    m_observedBy.erase(observedBy);
+                }
+            }
+            if (onLeave)
+            {
+                onLeave(playerId, m_left[i]);
+            }
+        }
+        for (size_t i = 0; i < m_entered.size(); ++i)
+        {
+            m_observedBy[m_entered[i]].insert(playerId);
+            if (onEnter)
+            {
+                onEnter(playerId, m_entered[i]);
+            }
+        }
+
+        m_stats.enters += m_entered.size();
+        m_stats.leaves += m_left.size();
+    }
+
+    m_stats.candidates = candidates;
+}
+
+void InterestManager::GetObservers(uint32_t objectId, std::vector<uint32_t>& observers) const
+{
+    std::unordered_map<uint32_t, std::unordered_set<uint32_t>>::const_iterator itr = m_observedBy.find(objectId);
+    if (itr != m_observedBy.end())
+    {
+        observers.insert(observers.end(), itr->second.begin(), itr->second.end());
+    }
+}
+
+bool InterestManager::IsVisible(uint32_t playerId, uint32_t objectId) const
+{
+    std::unordered_map<uint32_t, Observer>::const_iterator itr = m_observers.find(playerId);
+    return itr != m_observers.end() && itr->second.visible.count(objectId) != 0;
+}
+
+const std::unordered_set<uint32_t>* InterestManager::GetVisibleSet(uint32_t playerId) const
+{
+    std::unordered_map<uint32_t, Observer>::const_iterator itr = m_observers.find(playerId);
+    return itr != m_observers.end() ? &itr->second.visible : nullptr;
+}
+
+void InterestManager::GetStats(Stats& stats) const
+{
+    stats = m_stats;
+    stats.observers = (uint32_t)m_observers.size();
+    stats.visiblePairs = 0;
+    for (std::unordered_map<uint32_t, Observer>::const_iterator itr = m_observers.begin(); itr != m_observers.end(); ++itr)
+    {
+        stats.visiblePairs += (uint32_t)itr->second.visible.size();
+    }
+}
+
+SpatialHashGrid& InterestManager::GetGrid(uint8_t district)
+{
+    std::unordered_map<uint8_t, SpatialHashGrid>::iterator itr = m_grids.find(district);
+    if (itr == m_grids.end())
+    {
+        itr = m_grids.insert(std::make_pair(district, SpatialHashGrid(m_leaveRange))).first;
+    }
+    return itr->second;
+}
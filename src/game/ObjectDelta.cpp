@@ -0,0 +1,351 @@
+#include "../../include/ObjectDelta.h"
+
+#include <cstring>
+
+uint8_t ObjectState::Diff(const ObjectState& other) const
+{
+    uint8_t mask = 0;
+    if (location.x != other.location.x || location.y != other.location.y || location.z != other.location.z)
+    {
+        mask |= DELTA_FIELD_POSITION;
+    }
+    if (location.o != other.location.o)
+    {
+        mask |= DELTA_FIELD_ORIENTATION;
+    }
+    if (district != other.district)
+    {
+        mask |= DELTA_FIELD_DISTRICT;
+    }
+    if (stateFlags != other.stateFlags)
+    {
+        mask |= DELTA_FIELD_STATE_FLAGS;
+    }
+    if (scale != other.scale)
+    {
+        mask |= DELTA_FIELD_SCALE;
+    }
+    if (visible != other.visible)
+    {
+        mask |= DELTA_FIELD_VISIBLE;
+    }
+    if (data.wpos() != other.data.wpos() ||
+        (data.wpos() && memcmp(data.contents(), other.data.contents(), data.wpos()) != 0))
+    {
+        mask |= DELTA_FIELD_DATA;
+    }
+    return mask;
+}
+
+void ObjectState::Write(uint8_t mask, const LocationCodec& codec, ByteBuffer& buffer) const
+{
+    if (mask & DELTA_FULL_STATE)
+    {
+        mask = DELTA_FULL_STATE | DELTA_FIELD_ALL;
+    }
+
+    buffer << mask;
+    if (mask & DELTA_FIELD_POSITION)
+    {
+        codec.WritePosition(location, buffer);
+    }
+    if (mask & DELTA_FIELD_ORIENTATION)
+    {
+        codec.WriteOrientation(location, buffer);
+    }
+    if (mask & DELTA_FIELD_DISTRICT)
+    {
+        buffer << district;
+    }
+    if (mask & DELTA_FIELD_STATE_FLAGS)
+    {
+        buffer << stateFlags;
+    }
+    if (mask & DELTA_FIELD_SCALE)
+    {
+        buffer << scale;
+    }
+    if (mask & DELTA_FIELD_VISIBLE)
+    {
+        buffer << uint8_t(visible ? 1 : 0);
+    }
+    if (mask & DELTA_FIELD_DATA)
+    {
+        buffer << uint16_t(data.wpos());
+        buffer.append(data.contents(), data.wpos());
+    }
+}
+
+bool ObjectState::Apply(ByteView& view, const LocationCodec& codec)
+{
+    if (view.remaining() < 1)
+    {
+        return false;
+    }
+
+    uint8_t mask;
+    view >> mask;
+
+    const struct {
+        uint8_t field;
+        size_t size;
+    } sizes[] = {
+        { DELTA_FIELD_POSITION, codec.GetPositionSize() }, { DELTA_FIELD_ORIENTATION, codec.GetOrientationSize() },
+        { DELTA_FIELD_DISTRICT, 1 }, { DELTA_FIELD_STATE_FLAGS, 4 }, { DELTA_FIELD_SCALE, 4 },
+        { DELTA_FIELD_VISIBLE, 1 }, { DELTA_FIELD_DATA, 2 }
+    };
+    size_t fixed = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        if (mask & sizes[i].field)
+        {
+            fixed += sizes[i].size;
+        }
+    }
+    if (view.remaining() < fixed)
+    {
+        return false;
+    }
+
+    if ((mask & DELTA_FIELD_POSITION) && !codec.ReadPosition(view, location))
+    {
+        return false;
+    }
+    if ((mask & DELTA_FIELD_ORIENTATION) && !codec.ReadOrientation(view, location))
+    {
+        return false;
+    }
+    if (mask & DELTA_FIELD_DISTRICT)
+    {
+        view >> district;
+    }
+    if (mask & DELTA_FIELD_STATE_FLAGS)
+    {
+        view >> stateFlags;
+    }
+    if (mask & DELTA_FIELD_SCALE)
+    {
+        view >> scale;
+    }
+    if (mask & DELTA_FIELD_VISIBLE)
+    {
+        uint8_t flag;
+        view >> flag;
+        visible = flag != 0;
+    }
+    if (mask & DELTA_FIELD_DATA)
+    {
+        uint16_t length;
+        view >> length;
+        if (view.remaining() < length)
+        {
+            return false;
+        }
+        data.clear();
+        data.append(view.contents() + view.rpos(), length);
+        view.skip(length);
+    }
+    return true;
+}
+
+DeltaTracker::DeltaTracker()
+    : m_frame(0)
+{
+    for (size_t i = 0; i < FRAME_HISTORY; ++i)
+    {
+        m_frames[i].id = 0xFFFFFFFF;
+        m_frames[i].packets = 0;
+        m_frames[i].acked = 0;
+    }
+    m_frames[0].id = 0;
+
+    for (size_t i = 0; i < SEQUENCE_HISTORY; ++i)
+    {
+        m_packets[i].valid = false;
+    }
+
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool DeltaTracker::Encode(uint32_t objectId, const ObjectState& state, const LocationCodec& codec, ByteBuffer& buffer)
+{
+    ObjectBaseline& object = m_objects[objectId];
+
+    uint8_t mask;
+    if (!object.hasBaseline)
+    {
+        mask = DELTA_FULL_STATE | DELTA_FIELD_ALL;
+    }
+    else
+    {
+        // Fields the client may hold a different value for, whichever of
+        // the pending updates it received
+        mask = state.Diff(object.baseline) | object.droppedMask;
+        for (size_t i = 0; i < object.pendingCount; ++i)
+        {
+            mask |= object.pending[i].mask;
+        }
+
+        if (!mask)
+        {
+            ++m_stats.unchanged;
+            return false;
+        }
+        if ((mask & DELTA_FIELD_ALL) == DELTA_FIELD_ALL)
+        {
+            mask |= DELTA_FULL_STATE;
+        }
+    }
+
+    state.Write(mask, codec, buffer);
+    if (mask & DELTA_FULL_STATE)
+    {
+        ++m_stats.full;
+    }
+    else
+    {
+        ++m_stats.delta;
+    }
+
+    // A second update in the same frame replaces the first
+    Frame& frame = m_frames[m_frame % FRAME_HISTORY];
+    if (object.pendingCount && object.pending[object.pendingCount - 1].frame == m_frame)
+    {
+        PendingState& pending = object.pending[object.pendingCount - 1];
+        pending.mask |= mask;
+        pending.state = state;
+        return true;
+    }
+
+    if (object.pendingCount == PENDING_PER_OBJECT)
+    {
+        object.droppedMask |= object.pending[0].mask;
+        for (size_t i = 1; i < PENDING_PER_OBJECT; ++i)
+        {
+            object.pending[i - 1] = std::move(object.pending[i]);
+        }
+        --object.pendingCount;
+    }
+
+    PendingState& pending = object.pending[object.pendingCount++];
+    pending.frame = m_frame;
+    pending.mask = mask;
+    pending.state = state;
+    frame.objects.push_back(objectId);
+    return true;
+}
+
+void DeltaTracker::Forget(uint32_t objectId)
+{
+    m_objects.erase(objectId);
+}
+
+void DeltaTracker::OnPacketSent(uint16_t sequence)
+{
+    SentPacket& packet = m_packets[sequence % SEQUENCE_HISTORY];
+    packet.sequence = sequence;
+    packet.frame = m_frame;
+    packet.valid = true;
+    ++m_frames[m_frame % FRAME_HISTORY].packets;
+}
+
+void DeltaTracker::OnAcknowledged(uint16_t ackNum, uint32_t ackBits)
+{
+    Acknowledge(ackNum);
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        if (ackBits & (1u << i))
+        {
+            Acknowledge(uint16_t(ackNum - 1 - i));
+        }
+    }
+}
+
+void DeltaTracker::EndFrame()
+{
+    Frame& closed = m_frames[m_frame % FRAME_HISTORY];
+    if (closed.packets && closed.acked == closed.packets)
+    {
+        Promote(closed);
+    }
+
+    ++m_frame;
+    Frame& frame = m_frames[m_frame % FRAME_HISTORY];
+    frame.id = m_frame;
+    frame.packets = 0;
+    frame.acked = 0;
+    frame.objects.clear();
+}
+
+void DeltaTracker::Clear()
+{
+    m_objects.clear();
+    for (size_t i = 0; i < FRAME_HISTORY; ++i)
+    {
+        m_frames[i].objects.clear();
+    }
+}
+
+void DeltaTracker::Acknowledge(uint16_t sequence)
+{
+    SentPacket& packet = m_packets[sequence % SEQUENCE_HISTORY];
+    if (!packet.valid || packet.sequence != sequence)
+    {
+        return;
+    }
+    packet.valid = false;
+
+    Frame& frame = m_frames[packet.frame % FRAME_HISTORY];
+    if (frame.id != packet.frame)
+    {
+        return;
+    }
+
+    // The current frame may still send packets; it completes once closed
+    if (++frame.acked == frame.packets && frame.id != m_frame)
+    {
+        Promote(frame);
+    }
+}
+
+void DeltaTracker::Promote(Frame& frame)
+{
+    for (size_t i = 0; i < frame.objects.size(); ++i)
+    {
+        std::unordered_map<uint32_t, ObjectBaseline>::iterator itr = m_objects.find(frame.objects[i]);
+        if (itr == m_objects.end())
+        {
+            continue;
+        }
+
+        ObjectBaseline& object = itr->second;
+        size_t delivered = object.pendingCount;
+        for (size_t j = 0; j < object.pendingCount; ++j)
+        {
+            if (object.pending[j].frame == frame.id)
+            {
+                delivered = j;
+                break;
+            }
+        }
+        if (delivered == object.pendingCount)
+        {
+            continue;
+        }
+
+        // The client holds this state or a newer pending one
+        object.baseline = std::move(object.pending[delivered].state);
+        object.hasBaseline = true;
+        object.droppedMask = 0;
+
+        size_t kept = 0;
+        for (size_t j = delivered + 1; j < object.pendingCount; ++j)
+        {
+            object.pending[kept++] = std::move(object.pending[j]);
+        }
+        object.pendingCount = kept;
+        ++m_stats.promoted;
+    }
+
+    frame.objects.clear();
+}
@@ -0,0 +1,461 @@
+#include "../../include/ObjectStore.h"
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+ObjectStore& ObjectStore::getSingleton()
+{
+    // Deliberately leaked, see the header
+    static ObjectStore* store = new ObjectStore();
+    return *store;
+}
+
+ObjectStore::ObjectStore()
+    : m_slotCount(0)
+    , m_cellSize(100.0)
+    , m_inverseCellSize(1.0 / m_cellSize)
+{
+    for (uint32_t i = 0; i < MAX_DISTRICTS; ++i)
+    {
+        m_districts[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+uint32_t ObjectStore::Allocate(uint32_t objectId, uint16_t objectType)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t slot;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = m_slotCount.load(std::memory_order_relaxed);
+        uint32_t chunk = slot >> CHUNK_BITS;
+        if (chunk >= MAX_CHUNKS)
+        {
+            throw std::bad_alloc();
+        }
+        if (!m_chunks[chunk])
+        {
+            m_chunks[chunk].reset(new Chunk());
+        }
+    }
+
+    Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    chunk.x[i] = 0.0f;
+    chunk.y[i] = 0.0f;
+    chunk.z[i] = 0.0f;
+    chunk.o[i] = 0.0f;
+    chunk.objectId[i] = objectId;
+    chunk.stateFlags[i] = 0;
+    chunk.objectType[i] = objectType;
+    chunk.district[i] = 0;
+    chunk.visible[i] = 1;
+    chunk.inUse[i] = 1;
+    Link(slot);
+
+    // Publish the initialized slot to scans
+    if (slot == m_slotCount.load(std::memory_order_relaxed))
+    {
+        m_slotCount.store(slot + 1, std::memory_order_release);
+    }
+    return slot;
+}
+
+void ObjectStore::Free(uint32_t slot)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    chunk.inUse[i] = 0;
+    chunk.objectId[i] = 0;
+    Unlink(slot);
+    m_freeSlots.push_back(slot);
+}
+
+void ObjectStore::SetLocation(uint32_t slot, const LocationVector& location)
+{
+    Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    chunk.x[i] = float(location.x);
+    chunk.y[i] = float(location.y);
+    chunk.z[i] = float(location.z);
+    chunk.o[i] = float(location.o);
+
+    uint8_t districtId = chunk.district[i];
+    uint16_t bucket = chunk.bucket[i];
+    uint32_t index = chunk.bucketIndex[i];
+    if (GetBucket(chunk, i) == bucket)
+    {
+        CopyToList(slot);
+
+        // Unlink of another slot may have moved this one within the list
+        // since the index was read; the copy then went to the old entry
+        if (chunk.district[i] == districtId && chunk.bucket[i] == bucket && chunk.bucketIndex[i] == index)
+        {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (GetBucket(chunk, i) != chunk.bucket[i])
+    {
+        Unlink(slot);
+        Link(slot);
+    }
+    else
+    {
+        CopyToList(slot);
+    }
+}
+
+void ObjectStore::SetDistrict(uint32_t slot, uint8_t districtId)
+{
+    Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    if (chunk.district[i] == districtId)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Unlink(slot);
+    chunk.district[i] = districtId;
+    Link(slot);
+}
+
+bool ObjectStore::SetCellSize(float cellSize)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!(cellSize > 0.0f) || m_slotCount.load(std::memory_order_relaxed) != m_freeSlots.size())
+    {
+        return false;
+    }
+
+    // Every list is empty, so no slot is filed under the old size
+    m_cellSize = cellSize;
+    m_inverseCellSize = 1.0 / m_cellSize;
+    return true;
+}
+
+uint32_t ObjectStore::GetDistrictSlotCount(uint8_t districtId) const
+{
+    const DistrictGrid* grid = m_districts[districtId].load(std::memory_order_acquire);
+    return grid ? grid->count.load(std::memory_order_acquire) : 0;
+}
+
+uint32_t ObjectStore::GetObjectCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slotCount.load(std::memory_order_relaxed) - uint32_t(m_freeSlots.size());
+}
+
+size_t ObjectStore::Collect(const SpatialQuery& query, uint8_t districtId, bool visibleOnly, std::vector<uint32_t>& objectIds) const
+{
+    return Collect(query, districtId, visibleOnly, nullptr, objectIds);
+}
+
+size_t ObjectStore::CollectInRange(const LocationVector& center, float range, uint8_t districtId, bool visibleOnly, std::vector<uint32_t>& objectIds) const
+{
+    if (range < 0.0f)
+    {
+        return 0;
+    }
+
+    // The float test rounds the center, the differences and the squares;
+    // 1e-6 of the magnitudes involved is a few float steps more than that
+    ExactRange exact = { center, double(range) * range };
+    double pad = (std::fabs(center.x) + std::fabs(center.y) + std::fabs(center.z) + range) * 1e-6;
+    return Collect(SpatialQuery::Range(center, float(range + pad)), districtId, visibleOnly, &exact, objectIds);
+}
+
+size_t ObjectStore::Collect(const SpatialQuery& query, uint8_t districtId, bool visibleOnly, const ExactRange* exact, std::vector<uint32_t>& objectIds) const
+{
+    const DistrictGrid* grid = m_districts[districtId].load(std::memory_order_acquire);
+    if (!grid)
+    {
+        return 0;
+    }
+
+    size_t count = objectIds.size();
+
+    // Every shape lies within range of its center in the plane; the
+    // bounding square is widened by a few float steps of the coordinates
+    // for the rounding in SpatialQuery::Test
+    double range = std::sqrt(double(query.rangeSq));
+    double pad = (std::fabs(query.x) + std::fabs(query.y) + range) * 1e-6;
+    int64_t minX = GetCellCoord(query.x - range - pad);
+    int64_t maxX = GetCellCoord(query.x + range + pad);
+    int64_t minY = GetCellCoord(query.y - range - pad);
+    int64_t maxY = GetCellCoord(query.y + range + pad);
+
+    if (uint64_t(maxX - minX + 1) * uint64_t(maxY - minY + 1) > CELL_BUCKETS)
+    {
+        for (uint32_t bucket = 0; bucket < CELL_BUCKETS; ++bucket)
+        {
+            const BucketList* list = grid->buckets[bucket].load(std::memory_order_acquire);
+            if (list)
+            {
+                CollectBucket(query, districtId, bucket, *list, visibleOnly, exact, objectIds);
+            }
+        }
+        return objectIds.size() - count;
+    }
+
+    // Cells that hash to the same bucket share its list, which is scanned once
+    uint64_t visited[CELL_BUCKETS / 64] = { 0 };
+    for (int64_t cellX = minX; cellX <= maxX; ++cellX)
+    {
+        for (int64_t cellY = minY; cellY <= maxY; ++cellY)
+        {
+            uint32_t bucket = GetBucket(cellX, cellY);
+            uint64_t bit = uint64_t(1) << (bucket % 64);
+            if (visited[bucket / 64] & bit)
+            {
+                continue;
+            }
+            visited[bucket / 64] |= bit;
+
+            const BucketList* list = grid->buckets[bucket].load(std::memory_order_acquire);
+            if (list)
+            {
+                CollectBucket(query, districtId, bucket, *list, visibleOnly, exact, objectIds);
+            }
+        }
+    }
+
+    return objectIds.size() - count;
+}
+
+void ObjectStore::CollectBucket(const SpatialQuery& query, uint8_t districtId, uint32_t bucket, const BucketList& list, bool visibleOnly, const ExactRange* exact, std::vector<uint32_t>& objectIds) const
+{
+    uint32_t slotCount = list.count.load(std::memory_order_acquire);
+
+    // Runs of SEGMENT_BASE never straddle a segment of the list
+    for (uint32_t base = 0; base < slotCount; base += SEGMENT_BASE)
+    {
+        uint32_t run = std::min(slotCount - base, uint32_t(SEGMENT_BASE));
+        uint32_t segmentIndex, offset;
+        Locate(base, segmentIndex, offset);
+        const Segment& segment = *list.segments[segmentIndex];
+
+        uint64_t mask;
+        SpatialKernels::FilterMask(query, &segment.x[offset], &segment.y[offset], &segment.z[offset], run, &mask);
+        for (; mask; mask &= mask - 1)
+        {
+            uint32_t slot = segment.slot[offset + SpatialKernels::LowestBit(mask)];
+            const Chunk& chunk = GetChunk(slot);
+            uint32_t i = GetIndex(slot);
+
+            // The list may have changed since it was read
+            if (!chunk.inUse[i] || chunk.district[i] != districtId || chunk.bucket[i] != bucket || (visibleOnly && !chunk.visible[i]))
+            {
+                continue;
+            }
+
+            if (exact ? exact->center.DistanceSq(LocationVector(chunk.x[i], chunk.y[i], chunk.z[i])) <= exact->rangeSq
+                      : query.Test(chunk.x[i], chunk.y[i], chunk.z[i]))
+            {
+                objectIds.push_back(chunk.objectId[i]);
+            }
+        }
+    }
+}
+
+size_t ObjectStore::FindNearest(const LocationVector& center, float maxRange, uint8_t districtId, uint16_t objectType, bool visibleOnly, size_t count, std::vector<uint32_t>& objectIds) const
+{
+    const DistrictGrid* grid = m_districts[districtId].load(std::memory_order_acquire);
+    if (!grid || !count || maxRange < 0.0f)
+    {
+        return 0;
+    }
+
+    // Max-heap of the closest candidates so far; once full, only closer
+    // ones are taken
+    std::vector<std::pair<double, uint32_t>> heap;
+    heap.reserve(count);
+    double limitSq = double(maxRange) * maxRange;
+    auto visitBucket = [&](uint32_t bucket) {
+        const BucketList* list = grid->buckets[bucket].load(std::memory_order_acquire);
+        uint32_t slotCount = list ? list->count.load(std::memory_order_acquire) : 0;
+        for (uint32_t base = 0; base < slotCount; base += SEGMENT_BASE)
+        {
+            uint32_t run = std::min(slotCount - base, uint32_t(SEGMENT_BASE));
+            uint32_t segmentIndex, offset;
+            Locate(base, segmentIndex, offset);
+            const Segment& segment = *list->segments[segmentIndex];
+            for (uint32_t j = offset; j < offset + run; ++j)
+            {
+                if (segment.objectType[j] != objectType)
+                {
+                    continue;
+                }
+
+                double dx = segment.x[j] - center.x;
+                double dy = segment.y[j] - center.y;
+                double dz = segment.z[j] - center.z;
+                double distanceSq = dx * dx + dy * dy + dz * dz;
+                if (distanceSq > limitSq || (heap.size() == count && distanceSq >= limitSq))
+                {
+                    continue;
+                }
+
+                uint32_t slot = segment.slot[j];
+                const Chunk& chunk = GetChunk(slot);
+                uint32_t i = GetIndex(slot);
+                if (!chunk.inUse[i] || chunk.district[i] != districtId || chunk.bucket[i] != bucket || (visibleOnly && !chunk.visible[i]))
+                {
+                    continue;
+                }
+
+                if (heap.size() == count)
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                }
+                heap.push_back(std::make_pair(distanceSq, chunk.objectId[i]));
+                std::push_heap(heap.begin(), heap.end());
+                if (heap.size() == count)
+                {
+                    limitSq = heap.front().first;
+                }
+            }
+        }
+    };
+
+    int64_t centerX = GetCellCoord(center.x);
+    int64_t centerY = GetCellCoord(center.y);
+    int64_t lastRing = std::max(std::max(centerX - GetCellCoord(center.x - maxRange), GetCellCoord(center.x + maxRange) - centerX),
+                                std::max(centerY - GetCellCoord(center.y - maxRange), GetCellCoord(center.y + maxRange) - centerY));
+
+    if (uint64_t(2 * lastRing + 1) * uint64_t(2 * lastRing + 1) > CELL_BUCKETS)
+    {
+        // More cells than buckets: every bucket is visited anyway
+        for (uint32_t bucket = 0; bucket < CELL_BUCKETS; ++bucket)
+        {
+            visitBucket(bucket);
+        }
+    }
+    else
+    {
+        uint64_t visited[CELL_BUCKETS / 64] = { 0 };
+        for (int64_t ring = 0; ring <= lastRing; ++ring)
+        {
+            for (int64_t cellX = centerX - ring; cellX <= centerX + ring; ++cellX)
+            {
+                // Whole rows at the top and bottom of the ring, the two end cells elsewhere
+                int64_t step = (cellX == centerX - ring || cellX == centerX + ring) ? 1 : std::max<int64_t>(2 * ring, 1);
+                for (int64_t cellY = centerY - ring; cellY <= centerY + ring; cellY += step)
+                {
+                    uint32_t bucket = GetBucket(cellX, cellY);
+                    uint64_t bit = uint64_t(1) << (bucket % 64);
+                    if (!(visited[bucket / 64] & bit))
+                    {
+                        visited[bucket / 64] |= bit;
+                        visitBucket(bucket);
+                    }
+                }
+            }
+
+            // Anything outside the searched block is at least this far away
+            double edge = std::min(std::min(center.x - double(centerX - ring) * m_cellSize, double(centerX + ring + 1) * m_cellSize - center.x),
+                                   std::min(center.y - double(centerY - ring) * m_cellSize, double(centerY + ring + 1) * m_cellSize - center.y));
+            if (edge * edge >= limitSq)
+            {
+                break;
+            }
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    for (size_t i = 0; i < heap.size(); ++i)
+    {
+        objectIds.push_back(heap[i].second);
+    }
+    return heap.size();
+}
+
+void ObjectStore::Link(uint32_t slot)
+{
+    Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    uint8_t districtId = chunk.district[i];
+
+    DistrictGrid* grid = m_districts[districtId].load(std::memory_order_relaxed);
+    if (!grid)
+    {
+        grid = new DistrictGrid();
+        m_districts[districtId].store(grid, std::memory_order_release);
+    }
+
+    uint32_t bucket = GetBucket(chunk, i);
+    BucketList* list = grid->buckets[bucket].load(std::memory_order_relaxed);
+    if (!list)
+    {
+        list = new BucketList();
+        grid->buckets[bucket].store(list, std::memory_order_release);
+    }
+
+    uint32_t count = list->count.load(std::memory_order_relaxed);
+    uint32_t segmentIndex, offset;
+    Locate(count, segmentIndex, offset);
+    std::unique_ptr<Segment>& segment = list->segments[segmentIndex];
+    if (!segment)
+    {
+        segment.reset(new Segment(SEGMENT_BASE << segmentIndex));
+    }
+
+    segment->slot[offset] = slot;
+    segment->objectType[offset] = chunk.objectType[i];
+    chunk.bucket[i] = uint16_t(bucket);
+    chunk.bucketIndex[i] = count;
+    CopyToList(slot);
+    list->count.store(count + 1, std::memory_order_release);
+    grid->count.store(grid->count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void ObjectStore::CopyToList(uint32_t slot)
+{
+    const Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    const DistrictGrid* grid = m_districts[chunk.district[i]].load(std::memory_order_acquire);
+    BucketList& list = *grid->buckets[chunk.bucket[i]].load(std::memory_order_acquire);
+
+    uint32_t segmentIndex, offset;
+    Locate(chunk.bucketIndex[i], segmentIndex, offset);
+    Segment& segment = *list.segments[segmentIndex];
+    segment.x[offset] = chunk.x[i];
+    segment.y[offset] = chunk.y[i];
+    segment.z[offset] = chunk.z[i];
+}
+
+void ObjectStore::Unlink(uint32_t slot)
+{
+    Chunk& chunk = GetChunk(slot);
+    uint32_t i = GetIndex(slot);
+    DistrictGrid& grid = *m_districts[chunk.district[i]].load(std::memory_order_relaxed);
+    BucketList& list = *grid.buckets[chunk.bucket[i]].load(std::memory_order_relaxed);
+
+    uint32_t last = list.count.load(std::memory_order_relaxed) - 1;
+    uint32_t hole = chunk.bucketIndex[i];
+    if (hole != last)
+    {
+        uint32_t lastSegment, lastOffset, holeSegment, holeOffset;
+        Locate(last, lastSegment, lastOffset);
+        Locate(hole, holeSegment, holeOffset);
+        uint32_t moved = list.segments[lastSegment]->slot[lastOffset];
+        list.segments[holeSegment]->slot[holeOffset] = moved;
+        list.segments[holeSegment]->objectType[holeOffset] = list.segments[lastSegment]->objectType[lastOffset];
+        GetChunk(moved).bucketIndex[GetIndex(moved)] = hole;
+        CopyToList(moved);
+    }
+    list.count.store(last, std::memory_order_release);
+    grid.count.store(grid.count.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
@@ -0,0 +1,197 @@
+#include "../../include/ObjectStore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const uint8_t DISTRICT = 1;
+const uint16_t TYPE_COMMON = 1;
+const uint16_t TYPE_RARE = 7;
+const double WORLD_SIZE = 8192.0;
+
+/**
+ * @brief Deterministic generator so runs compare
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    double Next(double low, double high)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return low + (high - low) * (double(state >> 11) / double(1ULL << 53));
+    }
+};
+
+double ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Answer a range query by testing every object, as a district scan does
+ */
+size_t ScanRange(const std::vector<uint32_t>& slots, const SpatialQuery& query, std::vector<uint32_t>& objectIds)
+{
+    size_t count = objectIds.size();
+    for (size_t s = 0; s < slots.size(); ++s)
+    {
+        uint32_t slot = slots[s];
+        const ObjectStore::Chunk& chunk = sObjectStore.GetChunk(slot);
+        uint32_t i = ObjectStore::GetIndex(slot);
+        if (chunk.inUse[i] && chunk.district[i] == DISTRICT && query.Test(chunk.x[i], chunk.y[i], chunk.z[i]))
+        {
+            objectIds.push_back(chunk.objectId[i]);
+        }
+    }
+    return objectIds.size() - count;
+}
+
+/**
+ * @brief Find the nearest object of a type by measuring every object
+ */
+bool ScanNearest(const std::vector<uint32_t>& slots, const LocationVector& center, float maxRange, uint16_t objectType, uint32_t& objectId)
+{
+    double bestSq = double(maxRange) * maxRange;
+    bool found = false;
+    for (size_t s = 0; s < slots.size(); ++s)
+    {
+        uint32_t slot = slots[s];
+        const ObjectStore::Chunk& chunk = sObjectStore.GetChunk(slot);
+        uint32_t i = ObjectStore::GetIndex(slot);
+        if (!chunk.inUse[i] || chunk.district[i] != DISTRICT || chunk.objectType[i] != objectType)
+        {
+            continue;
+        }
+
+        double dx = chunk.x[i] - center.x, dy = chunk.y[i] - center.y, dz = chunk.z[i] - center.z;
+        double distanceSq = dx * dx + dy * dy + dz * dz;
+        if (distanceSq <= bestSq)
+        {
+            bestSq = distanceSq;
+            objectId = chunk.objectId[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Populate the store and time range, nearest and move operations
+ */
+void Run(uint32_t objects, size_t queries, float range)
+{
+    Random random(42);
+    std::vector<uint32_t> slots;
+    slots.reserve(objects);
+    for (uint32_t id = 1; id <= objects; ++id)
+    {
+        uint32_t slot = sObjectStore.Allocate(id, id % 50 ? TYPE_COMMON : TYPE_RARE);
+        sObjectStore.SetDistrict(slot, DISTRICT);
+        sObjectStore.SetLocation(slot, LocationVector(random.Next(0.0, WORLD_SIZE), random.Next(0.0, WORLD_SIZE), random.Next(0.0, 20.0)));
+        slots.push_back(slot);
+    }
+
+    std::vector<LocationVector> centers;
+    for (size_t i = 0; i < queries; ++i)
+    {
+        centers.push_back(LocationVector(random.Next(0.0, WORLD_SIZE), random.Next(0.0, WORLD_SIZE), 10.0));
+    }
+
+    // Range: the grid against a scan of every object, which only runs a
+    // tenth of the queries
+    std::vector<uint32_t> objectIds;
+    std::vector<size_t> gridHits(queries, 0);
+    size_t totalHits = 0, rangeAgree = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        objectIds.clear();
+        gridHits[i] = sObjectStore.CollectInRange(centers[i], range, DISTRICT, false, objectIds);
+        totalHits += gridHits[i];
+    }
+    double gridNs = ElapsedNs(start) / queries;
+
+    size_t scanQueries = queries / 10 ? queries / 10 : 1;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scanQueries; ++i)
+    {
+        objectIds.clear();
+        rangeAgree += ScanRange(slots, SpatialQuery::Range(centers[i], range), objectIds) == gridHits[i];
+    }
+    double scanNs = ElapsedNs(start) / scanQueries;
+
+    // Nearest of a type that is 2% of the objects
+    size_t nearestAgree = 0;
+    start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> nearest(queries, 0);
+    for (size_t i = 0; i < queries; ++i)
+    {
+        objectIds.clear();
+        if (sObjectStore.FindNearest(centers[i], range * 5.0f, DISTRICT, TYPE_RARE, false, 1, objectIds))
+        {
+            nearest[i] = objectIds[0];
+        }
+    }
+    double nearestNs = ElapsedNs(start) / queries;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scanQueries; ++i)
+    {
+        uint32_t objectId = 0;
+        ScanNearest(slots, centers[i], range * 5.0f, TYPE_RARE, objectId);
+        nearestAgree += objectId == nearest[i];
+    }
+    double scanNearestNs = ElapsedNs(start) / scanQueries;
+
+    // Moves at walking speed: mostly within the cell, some across
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < 10; ++round)
+    {
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            LocationVector position = sObjectStore.GetLocation(slots[i]);
+            position.x += random.Next(-2.0, 2.0);
+            position.y += random.Next(-2.0, 2.0);
+            sObjectStore.SetLocation(slots[i], position);
+        }
+    }
+    double moveNs = ElapsedNs(start) / (slots.size() * 10);
+
+    printf("%6u objects, range %3.0f: range grid %6.0f ns, scan %7.0f ns, %.1f hits (%zu of %zu agree); "
+           "nearest grid %5.0f ns, scan %7.0f ns (%zu of %zu agree); move %.0f ns\n",
+           objects, range, gridNs, scanNs, double(totalHits) / queries, rangeAgree, scanQueries,
+           nearestNs, scanNearestNs, nearestAgree, scanQueries, moveNs);
+
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t queries = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    float cellSize = argc > 2 ? float(atof(argv[2])) : 100.0f;
+    if (!sObjectStore.SetCellSize(cellSize))
+    {
+        printf("invalid cell size %f\n", cellSize);
+        return 1;
+    }
+
+    // Ranges of AI checks, interest management and commands
+    const float ranges[] = { 30.0f, 100.0f, 300.0f };
+    for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i)
+    {
+        Run(10000, queries, ranges[i]);
+        Run(100000, queries, ranges[i]);
+    }
+    return 0;
+}
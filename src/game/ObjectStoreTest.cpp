@@ -0,0 +1,360 @@
+#include "../../include/ObjectStore.h"
+#include "../../include/UnitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+std::vector<uint32_t> CollectSorted(uint8_t districtId, const LocationVector& center, float range, bool visibleOnly)
+{
+    std::vector<uint32_t> objectIds;
+    sObjectStore.CollectInRange(center, range, districtId, visibleOnly, objectIds);
+    std::sort(objectIds.begin(), objectIds.end());
+    return objectIds;
+}
+
+/**
+ * @brief Collect only returns objects of the queried district, wherever they are
+ */
+void TestDistrictScoping()
+{
+    // Enough objects for several runs of 64 and a second chunk
+    std::vector<uint32_t> slots;
+    for (uint32_t id = 1; id <= 5000; ++id)
+    {
+        uint32_t slot = sObjectStore.Allocate(id, 0);
+        sObjectStore.SetLocation(slot, LocationVector(id % 100, id / 100, 0.0));
+        sObjectStore.SetDistrict(slot, uint8_t(10 + id % 3));
+        slots.push_back(slot);
+    }
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(10) + sObjectStore.GetDistrictSlotCount(11) + sObjectStore.GetDistrictSlotCount(12) == 5000);
+
+    std::vector<uint32_t> hits = CollectSorted(11, LocationVector(0.0, 0.0, 0.0), 1e6f, false);
+    size_t wrong = 0;
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        wrong += hits[i] % 3 != 1;
+    }
+    TEST_CHECK(wrong == 0);
+    TEST_CHECK(hits.size() == sObjectStore.GetDistrictSlotCount(11));
+
+    // Moving and freeing keep the lists dense and consistent
+    for (size_t i = 0; i < slots.size(); i += 2)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+    for (size_t i = 1; i < slots.size(); i += 4)
+    {
+        sObjectStore.SetDistrict(slots[i], 11);
+    }
+
+    std::vector<uint32_t> expected;
+    for (size_t i = 1; i < slots.size(); i += 2)
+    {
+        uint32_t id = uint32_t(i + 1);
+        if (i % 4 == 1 || id % 3 == 1)
+        {
+            expected.push_back(id);
+        }
+    }
+    TEST_CHECK(CollectSorted(11, LocationVector(0.0, 0.0, 0.0), 1e6f, false) == expected);
+
+    for (size_t i = 1; i < slots.size(); i += 2)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(10) == 0);
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(11) == 0);
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(12) == 0);
+    TEST_CHECK(sObjectStore.GetObjectCount() == 0);
+}
+
+/**
+ * @brief Range and visibility are applied to the district's objects
+ */
+void TestRangeAndVisibility()
+{
+    uint32_t near = sObjectStore.Allocate(1, 0);
+    uint32_t hidden = sObjectStore.Allocate(2, 0);
+    uint32_t far = sObjectStore.Allocate(3, 0);
+    uint32_t elsewhere = sObjectStore.Allocate(4, 0);
+    sObjectStore.SetLocation(near, LocationVector(5.0, 0.0, 0.0));
+    sObjectStore.SetLocation(hidden, LocationVector(0.0, 5.0, 0.0));
+    sObjectStore.SetLocation(far, LocationVector(50.0, 0.0, 0.0));
+    sObjectStore.SetLocation(elsewhere, LocationVector(0.0, 0.0, 0.0));
+    sObjectStore.GetChunk(hidden).visible[ObjectStore::GetIndex(hidden)] = 0;
+    sObjectStore.SetDistrict(near, 7);
+    sObjectStore.SetDistrict(hidden, 7);
+    sObjectStore.SetDistrict(far, 7);
+    sObjectStore.SetDistrict(elsewhere, 8);
+
+    TEST_CHECK(CollectSorted(7, LocationVector(0.0, 0.0, 0.0), 10.0f, true) == std::vector<uint32_t>(1, 1));
+    TEST_CHECK(CollectSorted(7, LocationVector(0.0, 0.0, 0.0), 10.0f, false).size() == 2);
+    TEST_CHECK(CollectSorted(7, LocationVector(0.0, 0.0, 0.0), 100.0f, false).size() == 3);
+    TEST_CHECK(CollectSorted(9, LocationVector(0.0, 0.0, 0.0), 100.0f, false).empty());
+
+    sObjectStore.Free(near);
+    sObjectStore.Free(hidden);
+    sObjectStore.Free(far);
+    sObjectStore.Free(elsewhere);
+}
+
+/**
+ * @brief The list's position copies follow moves, district changes and frees
+ */
+void TestListPositions()
+{
+    // Frees move the last entries of the list into the holes
+    std::vector<uint32_t> slots;
+    for (uint32_t id = 1; id <= 300; ++id)
+    {
+        uint32_t slot = sObjectStore.Allocate(id, 0);
+        sObjectStore.SetDistrict(slot, 20);
+        sObjectStore.SetLocation(slot, LocationVector(id * 10.0, 0.0, 0.0));
+        slots.push_back(slot);
+    }
+    for (size_t i = 0; i < slots.size(); i += 3)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+    for (size_t i = 1; i < slots.size(); i += 3)
+    {
+        sObjectStore.SetLocation(slots[i], LocationVector(0.0, (i + 1) * 10.0, 0.0));
+    }
+    sObjectStore.SetDistrict(slots[2], 21);
+    sObjectStore.SetDistrict(slots[2], 20);
+
+    size_t misses = 0;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        uint32_t id = uint32_t(i + 1);
+        LocationVector position = i % 3 == 1 ? LocationVector(0.0, id * 10.0, 0.0) : LocationVector(id * 10.0, 0.0, 0.0);
+        std::vector<uint32_t> hits = CollectSorted(20, position, 1.0f, false);
+        misses += hits != (i % 3 == 0 ? std::vector<uint32_t>() : std::vector<uint32_t>(1, id));
+    }
+    TEST_CHECK(misses == 0);
+
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (i % 3 != 0)
+        {
+            sObjectStore.Free(slots[i]);
+        }
+    }
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(20) == 0);
+}
+
+/**
+ * @brief Deterministic generator so failures reproduce
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    double Next(double low, double high)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return low + (high - low) * (double(state >> 11) / double(1ULL << 53));
+    }
+};
+
+/**
+ * @brief Brute-force answer over the given slots
+ */
+std::vector<uint32_t> ScanSorted(const std::vector<uint32_t>& slots, const SpatialQuery& query)
+{
+    std::vector<uint32_t> objectIds;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        const ObjectStore::Chunk& chunk = sObjectStore.GetChunk(slots[i]);
+        uint32_t index = ObjectStore::GetIndex(slots[i]);
+        if (query.Test(chunk.x[index], chunk.y[index], chunk.z[index]))
+        {
+            objectIds.push_back(chunk.objectId[index]);
+        }
+    }
+    std::sort(objectIds.begin(), objectIds.end());
+    return objectIds;
+}
+
+/**
+ * @brief The grid answers like a scan of every object, after moves across cells
+ */
+void TestGridMatchesScan()
+{
+    TEST_CHECK(sObjectStore.SetCellSize(25.0f));
+    TEST_CHECK(sObjectStore.GetCellSize() == 25.0f);
+
+    // Spread wide enough that many cells share a bucket
+    Random random(3);
+    std::vector<uint32_t> slots;
+    for (uint32_t id = 1; id <= 4000; ++id)
+    {
+        uint32_t slot = sObjectStore.Allocate(id, 0);
+        sObjectStore.SetDistrict(slot, 30);
+        sObjectStore.SetLocation(slot, LocationVector(random.Next(-20000.0, 20000.0), random.Next(-20000.0, 20000.0), random.Next(-50.0, 50.0)));
+        slots.push_back(slot);
+    }
+    TEST_CHECK(!sObjectStore.SetCellSize(50.0f));
+
+    size_t mismatches = 0;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int q = 0; q < 200; ++q)
+        {
+            const ObjectStore::Chunk& chunk = sObjectStore.GetChunk(slots[q * 7]);
+            uint32_t index = ObjectStore::GetIndex(slots[q * 7]);
+            LocationVector center(chunk.x[index] + random.Next(-30.0, 30.0), chunk.y[index] + random.Next(-30.0, 30.0), 0.0, random.Next(0.0, 6.28));
+            float range = float(random.Next(1.0, q % 20 ? 200.0 : 5000.0));
+
+            SpatialQuery queries[] = { SpatialQuery::Range(center, range), SpatialQuery::Range2D(center, range), SpatialQuery::Cone(center, range, 0.7f) };
+            for (size_t k = 0; k < 3; ++k)
+            {
+                std::vector<uint32_t> hits;
+                sObjectStore.Collect(queries[k], 30, false, hits);
+                std::sort(hits.begin(), hits.end());
+                mismatches += hits != ScanSorted(slots, queries[k]);
+            }
+        }
+
+        // Small steps mostly stay in the cell, jumps change bucket
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            const ObjectStore::Chunk& chunk = sObjectStore.GetChunk(slots[i]);
+            uint32_t index = ObjectStore::GetIndex(slots[i]);
+            double step = i % 5 ? 10.0 : 5000.0;
+            sObjectStore.SetLocation(slots[i], LocationVector(chunk.x[index] + random.Next(-step, step), chunk.y[index] + random.Next(-step, step), chunk.z[index]));
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(30) == slots.size());
+
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+    TEST_CHECK(sObjectStore.GetDistrictSlotCount(30) == 0);
+    TEST_CHECK(sObjectStore.SetCellSize(100.0f));
+}
+
+/**
+ * @brief Nearest queries find the closest objects of the type, nearest first
+ */
+void TestFindNearest()
+{
+    Random random(5);
+    std::vector<uint32_t> slots;
+    for (uint32_t id = 1; id <= 3000; ++id)
+    {
+        uint32_t slot = sObjectStore.Allocate(id, uint16_t(id % 10 == 0 ? 7 : 1));
+        sObjectStore.SetDistrict(slot, 40);
+        sObjectStore.SetLocation(slot, LocationVector(random.Next(-3000.0, 3000.0), random.Next(-3000.0, 3000.0), random.Next(-10.0, 10.0)));
+        slots.push_back(slot);
+    }
+
+    size_t mismatches = 0;
+    for (int q = 0; q < 300; ++q)
+    {
+        LocationVector center(random.Next(-3000.0, 3000.0), random.Next(-3000.0, 3000.0), 0.0);
+        float maxRange = float(random.Next(50.0, q % 10 ? 800.0 : 20000.0));
+        size_t count = 1 + q % 5;
+
+        // Expected: the type's objects within range by distance, ties by ID
+        std::vector<std::pair<double, uint32_t>> expected;
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            const ObjectStore::Chunk& chunk = sObjectStore.GetChunk(slots[i]);
+            uint32_t index = ObjectStore::GetIndex(slots[i]);
+            double dx = chunk.x[index] - center.x, dy = chunk.y[index] - center.y, dz = chunk.z[index] - center.z;
+            double distanceSq = dx * dx + dy * dy + dz * dz;
+            if (chunk.objectType[index] == 7 && distanceSq <= double(maxRange) * maxRange)
+            {
+                expected.push_back(std::make_pair(distanceSq, chunk.objectId[index]));
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.resize(std::min(expected.size(), count));
+
+        std::vector<uint32_t> found;
+        sObjectStore.FindNearest(center, maxRange, 40, 7, false, count, found);
+        bool same = found.size() == expected.size();
+        for (size_t i = 0; same && i < found.size(); ++i)
+        {
+            same = found[i] == expected[i].second;
+        }
+        mismatches += !same;
+    }
+    TEST_CHECK(mismatches == 0);
+
+    std::vector<uint32_t> found;
+    TEST_CHECK(sObjectStore.FindNearest(LocationVector(0.0, 0.0, 0.0), 1e6f, 40, 8, false, 3, found) == 0);
+    TEST_CHECK(sObjectStore.FindNearest(LocationVector(0.0, 0.0, 0.0), 1e6f, 41, 7, false, 3, found) == 0);
+
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+}
+
+/**
+ * @brief CollectInRange agrees with LocationVector::DistanceSq on the boundary
+ */
+void TestRangeBoundary()
+{
+    // Points on the sphere, nudged by a few float steps; the center is
+    // off the float grid, as an observer position usually is
+    Random random(9);
+    LocationVector center(1234.56789, -987.654321, 12.3456789);
+    float range = 150.0f;
+    std::vector<uint32_t> slots;
+    for (uint32_t id = 1; id <= 4000; ++id)
+    {
+        double angle = random.Next(0.0, 6.2831853);
+        double height = random.Next(-range, range);
+        double horizontal = std::sqrt(double(range) * range - height * height);
+        float x = float(center.x + horizontal * std::cos(angle));
+        float y = float(center.y + horizontal * std::sin(angle));
+        for (int steps = int(id % 5) - 2; steps; steps += steps < 0 ? 1 : -1)
+        {
+            x = std::nextafter(x, steps < 0 ? float(center.x) : 1e9f);
+        }
+
+        uint32_t slot = sObjectStore.Allocate(id, 0);
+        sObjectStore.SetDistrict(slot, 50);
+        sObjectStore.SetLocation(slot, LocationVector(x, y, float(center.z + height)));
+        slots.push_back(slot);
+    }
+
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (center.DistanceSq(sObjectStore.GetLocation(slots[i])) <= double(range) * range)
+        {
+            expected.push_back(uint32_t(i + 1));
+        }
+    }
+    TEST_CHECK(!expected.empty() && expected.size() < slots.size());
+    TEST_CHECK(CollectSorted(50, center, range, false) == expected);
+
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        sObjectStore.Free(slots[i]);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestDistrictScoping();
+    TestRangeAndVisibility();
+    TestListPositions();
+    TestGridMatchesScan();
+    TestFindNearest();
+    TestRangeBoundary();
+    return UnitTest::Result("ObjectStoreTest");
+}
@@ -0,0 +1,139 @@
+#include "../../include/SpatialHashGrid.h"
+
+SpatialHashGrid::SpatialHashGrid(float cellSize)
+    : m_cellSize(cellSize > 0.0f ? cellSize : 32.0f)
+    , m_inverseCellSize(1.0 / m_cellSize)
+{
+}
+
+void SpatialHashGrid::SetCellSize(float cellSize)
+{
+    if (cellSize <= 0.0f || double(cellSize) == m_cellSize)
+    {
+        return;
+    }
+
+    CellMap cells;
+    cells.swap(m_cells);
+    m_entries.clear();
+    m_cellSize = cellSize;
+    m_inverseCellSize = 1.0 / m_cellSize;
+
+    for (CellMap::const_iterator cell = cells.begin(); cell != cells.end(); ++cell)
+    {
+        for (size_t i = 0; i < cell->second.size(); ++i)
+        {
+            const Entry& entry = cell->second[i];
+            Insert(entry.id, LocationVector(entry.x, entry.y, entry.z));
+        }
+    }
+}
+
+void SpatialHashGrid::Insert(uint32_t id, const LocationVector& position)
+{
+    if (Move(id, position))
+    {
+        return;
+    }
+
+    uint64_t key = GetCellKey(GetCellCoord(position.x), GetCellCoord(position.y));
+    std::vector<Entry>& entries = m_cells[key];
+
+    Slot& slot = m_entries[id];
+    slot.cell = key;
+    slot.index = uint32_t(entries.size());
+
+    Entry entry = { id, position.x, position.y, position.z };
+    entries.push_back(entry);
+}
+
+bool SpatialHashGrid::Move(uint32_t id, const LocationVector& position)
+{
+    std::unordered_map<uint32_t, Slot>::iterator itr = m_entries.find(id);
+    if (itr == m_entries.end())
+    {
+        return false;
+    }
+
+    Slot& slot = itr->second;
+    uint64_t key = GetCellKey(GetCellCoord(position.x), GetCellCoord(position.y));
+    if (key == slot.cell)
+    {
+        Entry& entry = m_cells[key][slot.index];
+        entry.x = position.x;
+        entry.y = position.y;
+        entry.z = position.z;
+        return true;
+    }
+
+    RemoveEntry(slot);
+
+    std::vector<Entry>& entries = m_cells[key];
+    slot.cell = key;
+    slot.index = uint32_t(entries.size());
+
+    Entry entry = { id, position.x, position.y, position.z };
+    entries.push_back(entry);
+    return true;
+}
+
+bool SpatialHashGrid::Remove(uint32_t id)
+{
+    std::unordered_map<uint32_t, Slot>::iterator itr = m_entries.find(id);
+    if (itr == m_entries.end())
+    {
+        return false;
+    }
+
+    RemoveEntry(itr->second);
+    m_entries.erase(itr);
+    return true;
+}
+
+void SpatialHashGrid::Clear()
+{
+    m_cells.clear();
+    m_entries.clear();
+}
+
+size_t SpatialHashGrid::QueryRange(const LocationVector& center, float range, std::vector<uint32_t>& ids) const
+{
+    size_t count = ids.size();
+    QueryRange(center, range, [&ids](uint32_t id, double) {
+        ids.push_back(id);
+    });
+    return ids.size() - count;
+}
+
+bool SpatialHashGrid::FindNearest(const LocationVector& center, float maxRange, uint32_t& id) const
+{
+    return FindNearest(center, maxRange, [](uint32_t) { return true; }, id);
+}
+
+size_t SpatialHashGrid::FindKNearest(const LocationVector& center, size_t count, float maxRange, std::vector<uint32_t>& ids) const
+{
+    return FindKNearest(center, count, maxRange, [](uint32_t) { return true; }, ids);
+}
+
+void SpatialHashGrid::RemoveEntry(const Slot& slot)
+{
+    CellMap::iterator cell = m_cells.find(slot.cell);
+    if (cell == m_cells.end())
+    {
+        return;
+    }
+
+    // Swap with the last entry of the cell and fix that entry's slot
+    std::vector<Entry>& entries = cell->second;
+    if (slot.index + 1 != entries.size())
+    {
+        entries[slot.index] = entries.back();
+        m_entries[entries[slot.index].id].index = slot.index;
+    }
+    entries.pop_back();
+
+    if (entries.empty())
+    {
+        m_cells.erase(cell);
+    }
+}
@@ -0,0 +1,234 @@
+#include "../../include/SpatialKernels.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPATIAL_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Scalar kernel for one shape
+ */
+template<SpatialQuery::Shape shape>
+void FilterMaskScalar(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t begin, size_t count, uint64_t* mask)
+{
+    // A copy with a constant shape lets Test fold the switch
+    SpatialQuery shaped = query;
+    shaped.shape = shape;
+    for (size_t i = begin; i < count; ++i)
+    {
+        if (shaped.Test(x[i], y[i], z[i]))
+        {
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+}
+
+/**
+ * @brief Scalar kernel, also used for the tails of the SIMD kernels
+ */
+void FilterMaskScalar(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t begin, size_t count, uint64_t* mask)
+{
+    switch (query.shape)
+    {
+        case SpatialQuery::SHAPE_RANGE:
+            FilterMaskScalar<SpatialQuery::SHAPE_RANGE>(query, x, y, z, begin, count, mask);
+            break;
+        case SpatialQuery::SHAPE_RANGE_2D:
+            FilterMaskScalar<SpatialQuery::SHAPE_RANGE_2D>(query, x, y, z, begin, count, mask);
+            break;
+        case SpatialQuery::SHAPE_CONE:
+            FilterMaskScalar<SpatialQuery::SHAPE_CONE>(query, x, y, z, begin, count, mask);
+            break;
+    }
+}
+
+#ifdef SPATIAL_KERNELS_X86
+
+/**
+ * @brief Test four points, returning a 4-bit hit mask
+ */
+__attribute__((target("sse2")))
+inline int TestSse2(const SpatialQuery& query, __m128 px, __m128 py, __m128 pz)
+{
+    __m128 dx = _mm_sub_ps(px, _mm_set1_ps(query.x));
+    __m128 dy = _mm_sub_ps(py, _mm_set1_ps(query.y));
+    __m128 distance2DSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    __m128 rangeSq = _mm_set1_ps(query.rangeSq);
+
+    if (query.shape == SpatialQuery::SHAPE_RANGE_2D)
+    {
+        return _mm_movemask_ps(_mm_cmple_ps(distance2DSq, rangeSq));
+    }
+
+    __m128 dz = _mm_sub_ps(pz, _mm_set1_ps(query.z));
+    __m128 hits = _mm_cmple_ps(_mm_add_ps(distance2DSq, _mm_mul_ps(dz, dz)), rangeSq);
+    if (query.shape == SpatialQuery::SHAPE_CONE && _mm_movemask_ps(hits))
+    {
+        __m128 dot = _mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(query.facingX)), _mm_mul_ps(dy, _mm_set1_ps(query.facingY)));
+        __m128 edge = _mm_mul_ps(_mm_set1_ps(query.cosHalfAngle), _mm_sqrt_ps(distance2DSq));
+        hits = _mm_and_ps(hits, _mm_cmpge_ps(dot, edge));
+    }
+    return _mm_movemask_ps(hits);
+}
+
+__attribute__((target("sse2")))
+void FilterMaskSse2(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t count, uint64_t* mask)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        int bits = TestSse2(query, _mm_loadu_ps(x + i), _mm_loadu_ps(y + i), _mm_loadu_ps(z + i));
+        mask[i >> 6] |= uint64_t(bits) << (i & 63);
+    }
+    FilterMaskScalar(query, x, y, z, i, count, mask);
+}
+
+/**
+ * @brief Test eight points, returning an 8-bit hit mask
+ */
+__attribute__((target("avx2")))
+inline int TestAvx2(const SpatialQuery& query, __m256 px, __m256 py, __m256 pz)
+{
+    __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(query.x));
+    __m256 dy = _mm256_sub_ps(py, _mm256_set1_ps(query.y));
+    __m256 distance2DSq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    __m256 rangeSq = _mm256_set1_ps(query.rangeSq);
+
+    if (query.shape == SpatialQuery::SHAPE_RANGE_2D)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(distance2DSq, rangeSq, _CMP_LE_OQ));
+    }
+
+    __m256 dz = _mm256_sub_ps(pz, _mm256_set1_ps(query.z));
+    __m256 hits = _mm256_cmp_ps(_mm256_add_ps(distance2DSq, _mm256_mul_ps(dz, dz)), rangeSq, _CMP_LE_OQ);
+    if (query.shape == SpatialQuery::SHAPE_CONE && _mm256_movemask_ps(hits))
+    {
+        __m256 dot = _mm256_add_ps(_mm256_mul_ps(dx, _mm256_set1_ps(query.facingX)), _mm256_mul_ps(dy, _mm256_set1_ps(query.facingY)));
+        __m256 edge = _mm256_mul_ps(_mm256_set1_ps(query.cosHalfAngle), _mm256_sqrt_ps(distance2DSq));
+        hits = _mm256_and_ps(hits, _mm256_cmp_ps(dot, edge, _CMP_GE_OQ));
+    }
+    return _mm256_movemask_ps(hits);
+}
+
+__attribute__((target("avx2")))
+void FilterMaskAvx2(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t count, uint64_t* mask)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        int bits = TestAvx2(query, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), _mm256_loadu_ps(z + i));
+        mask[i >> 6] |= uint64_t(bits) << (i & 63);
+    }
+    FilterMaskScalar(query, x, y, z, i, count, mask);
+}
+
+#endif // SPATIAL_KERNELS_X86
+
+bool IsSupported(SpatialKernels::Implementation implementation)
+{
+    switch (implementation)
+    {
+        case SpatialKernels::IMPL_SCALAR:
+            return true;
+#ifdef SPATIAL_KERNELS_X86
+        case SpatialKernels::IMPL_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case SpatialKernels::IMPL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+SpatialKernels::Implementation DetectImplementation()
+{
+#ifdef SPATIAL_KERNELS_X86
+    __builtin_cpu_init();
+#endif
+    if (IsSupported(SpatialKernels::IMPL_AVX2))
+    {
+        return SpatialKernels::IMPL_AVX2;
+    }
+    if (IsSupported(SpatialKernels::IMPL_SSE2))
+    {
+        return SpatialKernels::IMPL_SSE2;
+    }
+    return SpatialKernels::IMPL_SCALAR;
+}
+
+std::atomic<int> g_implementation(DetectImplementation());
+
+} // namespace
+
+void SpatialKernels::FilterMask(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t count, uint64_t* mask)
+{
+    memset(mask, 0, ((count + 63) / 64) * sizeof(uint64_t));
+
+    switch (g_implementation.load(std::memory_order_relaxed))
+    {
+#ifdef SPATIAL_KERNELS_X86
+        case IMPL_AVX2:
+            FilterMaskAvx2(query, x, y, z, count, mask);
+            break;
+        case IMPL_SSE2:
+            FilterMaskSse2(query, x, y, z, count, mask);
+            break;
+#endif
+        default:
+            FilterMaskScalar(query, x, y, z, 0, count, mask);
+            break;
+    }
+}
+
+size_t SpatialKernels::Filter(const SpatialQuery& query, const float* x, const float* y, const float* z, size_t count, uint32_t* indices)
+{
+    size_t hits = 0;
+    uint64_t mask;
+    for (size_t base = 0; base < count; base += 64)
+    {
+        size_t block = count - base < 64 ? count - base : 64;
+        FilterMask(query, x + base, y + base, z + base, block, &mask);
+        while (mask)
+        {
+            indices[hits++] = uint32_t(base + LowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+    return hits;
+}
+
+SpatialKernels::Implementation SpatialKernels::GetImplementation()
+{
+    return Implementation(g_implementation.load(std::memory_order_relaxed));
+}
+
+bool SpatialKernels::SetImplementation(Implementation implementation)
+{
+    if (!IsSupported(implementation))
+    {
+        return false;
+    }
+
+    g_implementation.store(implementation, std::memory_order_relaxed);
+    return true;
+}
+
+const char* SpatialKernels::GetImplementationName(Implementation implementation)
+{
+    switch (implementation)
+    {
+        case IMPL_SCALAR:
+            return "scalar";
+        case IMPL_SSE2:
+            return "SSE2";
+        case IMPL_AVX2:
+            return "AVX2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,145 @@
+#include "../../include/SpatialKernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Deterministic generator so runs compare
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    double Next(double low, double high)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return low + (high - low) * (double(state >> 11) / double(1ULL << 53));
+    }
+};
+
+/**
+ * @brief Positions as SoA floats for the kernels and as LocationVectors for the baseline
+ */
+struct Positions
+{
+    std::vector<float> x, y, z;
+    std::vector<LocationVector> locations;
+
+    Positions(size_t count, double size)
+    {
+        Random random(42);
+        for (size_t i = 0; i < count; ++i)
+        {
+            LocationVector location(random.Next(0.0, size), random.Next(0.0, size), random.Next(0.0, 50.0));
+            x.push_back(float(location.x));
+            y.push_back(float(location.y));
+            z.push_back(float(location.z));
+            locations.push_back(location);
+        }
+    }
+};
+
+double ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Time the scalar LocationVector loop the kernels replace
+ */
+double RunBaseline(const Positions& positions, const LocationVector& center, float range, size_t repeats, size_t& hits)
+{
+    double rangeSq = double(range) * range;
+    std::vector<uint32_t> indices(positions.locations.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        hits = 0;
+        for (size_t i = 0; i < positions.locations.size(); ++i)
+        {
+            if (center.DistanceSq(positions.locations[i]) <= rangeSq)
+            {
+                indices[hits++] = uint32_t(i);
+            }
+        }
+    }
+    return ElapsedNs(start) / (repeats * positions.locations.size());
+}
+
+/**
+ * @brief Time FilterMask and Filter with the selected implementation
+ */
+void RunKernels(const Positions& positions, const SpatialQuery& query, size_t repeats, double& maskNs, double& filterNs, size_t& hits)
+{
+    size_t count = positions.x.size();
+    std::vector<uint64_t> mask((count + 63) / 64);
+    std::vector<uint32_t> indices(count);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        SpatialKernels::FilterMask(query, positions.x.data(), positions.y.data(), positions.z.data(), count, mask.data());
+    }
+    maskNs = ElapsedNs(start) / (repeats * count);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        hits = SpatialKernels::Filter(query, positions.x.data(), positions.y.data(), positions.z.data(), count, indices.data());
+    }
+    filterNs = ElapsedNs(start) / (repeats * count);
+}
+
+void Run(size_t count, size_t repeats)
+{
+    // Roughly 1% of the points within range
+    Positions positions(count, 1000.0);
+    LocationVector center(500.0, 500.0, 25.0, 1.0);
+    float range = 56.0f;
+
+    size_t baselineHits = 0;
+    double baselineNs = RunBaseline(positions, center, range, repeats, baselineHits);
+    printf("%6zu points: LocationVector::DistanceSq loop %.3f ns/point (%zu hits)\n", count, baselineNs, baselineHits);
+
+    const char* shapes[] = { "range", "range 2D", "cone" };
+    SpatialQuery queries[] = { SpatialQuery::Range(center, range), SpatialQuery::Range2D(center, range), SpatialQuery::Cone(center, range, 0.6f) };
+    SpatialKernels::Implementation implementations[] = { SpatialKernels::IMPL_SCALAR, SpatialKernels::IMPL_SSE2, SpatialKernels::IMPL_AVX2 };
+    for (size_t impl = 0; impl < sizeof(implementations) / sizeof(implementations[0]); ++impl)
+    {
+        if (!SpatialKernels::SetImplementation(implementations[impl]))
+        {
+            printf("        %-6s not supported\n", SpatialKernels::GetImplementationName(implementations[impl]));
+            continue;
+        }
+
+        for (size_t shape = 0; shape < sizeof(queries) / sizeof(queries[0]); ++shape)
+        {
+            double maskNs, filterNs;
+            size_t hits = 0;
+            RunKernels(positions, queries[shape], repeats, maskNs, filterNs, hits);
+            printf("        %-6s %-8s: mask %.3f ns/point, list %.3f ns/point (%zu hits)\n",
+                   SpatialKernels::GetImplementationName(implementations[impl]), shapes[shape], maskNs, filterNs, hits);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t points = argc > 1 ? strtoul(argv[1], NULL, 10) : 50000000;
+
+    // A district bucket, an interest scan and a whole district
+    const size_t counts[] = { 64, 4096, 100000 };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+    {
+        Run(counts[i], points / counts[i] ? points / counts[i] : 1);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "../../include/SpatialKernels.h"
+#include "../../include/UnitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Deterministic generator so failures reproduce
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    float Next(float min, float max)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return min + (max - min) * float(state >> 40) / float(1u << 24);
+    }
+};
+
+/**
+ * @brief Points spread around a query, many of them on its boundary
+ */
+struct Points
+{
+    std::vector<float> x, y, z;
+
+    Points(const SpatialQuery& query, float range, size_t count, uint64_t seed)
+    {
+        Random random(seed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            float angle = random.Next(0.0f, 6.2831853f);
+            float height = random.Next(-range, range);
+            float distance = random.Next(0.0f, 1.5f * range);
+
+            // Every other point lies on the sphere or circle, nudged by a
+            // few float steps either way
+            if (i % 2)
+            {
+                float horizontal = query.shape == SpatialQuery::SHAPE_RANGE_2D ? range : std::sqrt(std::max(0.0f, range * range - height * height));
+                distance = horizontal;
+                for (int steps = int(i % 7) - 3; steps; steps += steps < 0 ? 1 : -1)
+                {
+                    distance = std::nextafter(distance, steps < 0 ? 0.0f : 2.0f * range);
+                }
+            }
+
+            x.push_back(query.x + distance * std::cos(angle));
+            y.push_back(query.y + distance * std::sin(angle));
+            z.push_back(query.z + height);
+        }
+    }
+};
+
+/**
+ * @brief Every implementation matches SpatialQuery::Test on every point
+ */
+void TestExactMatch(const SpatialQuery& query, float range, size_t count, uint64_t seed)
+{
+    Points points(query, range, count, seed);
+    std::vector<uint64_t> expected((count + 63) / 64, 0);
+    std::vector<uint32_t> expectedIndices;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (query.Test(points.x[i], points.y[i], points.z[i]))
+        {
+            expected[i / 64] |= uint64_t(1) << (i % 64);
+            expectedIndices.push_back(uint32_t(i));
+        }
+    }
+
+    SpatialKernels::Implementation implementations[] = { SpatialKernels::IMPL_SCALAR, SpatialKernels::IMPL_SSE2, SpatialKernels::IMPL_AVX2 };
+    for (size_t impl = 0; impl < sizeof(implementations) / sizeof(implementations[0]); ++impl)
+    {
+        if (!SpatialKernels::SetImplementation(implementations[impl]))
+        {
+            printf("%s not supported, skipped\n", SpatialKernels::GetImplementationName(implementations[impl]));
+            continue;
+        }
+
+        std::vector<uint64_t> mask(expected.size() + 1, ~uint64_t(0));
+        SpatialKernels::FilterMask(query, points.x.data(), points.y.data(), points.z.data(), count, mask.data());
+        mask.pop_back();
+        TEST_CHECK(mask == expected);
+
+        std::vector<uint32_t> indices(count + 1);
+        indices.resize(SpatialKernels::Filter(query, points.x.data(), points.y.data(), points.z.data(), count, indices.data()));
+        TEST_CHECK(indices == expectedIndices);
+    }
+}
+
+/**
+ * @brief The boundary is inclusive and a point at the center is inside
+ */
+void TestBoundary()
+{
+    SpatialQuery range = SpatialQuery::Range(LocationVector(0.0, 0.0, 0.0), 10.0f);
+    TEST_CHECK(range.Test(10.0f, 0.0f, 0.0f));
+    TEST_CHECK(range.Test(0.0f, 0.0f, 10.0f));
+    TEST_CHECK(!range.Test(std::nextafter(10.0f, 11.0f), 0.0f, 0.0f));
+    TEST_CHECK(range.Test(0.0f, 0.0f, 0.0f));
+
+    SpatialQuery range2D = SpatialQuery::Range2D(LocationVector(0.0, 0.0, 0.0), 10.0f);
+    TEST_CHECK(range2D.Test(0.0f, 10.0f, 1000.0f));
+
+    // Facing +X with a 45 degree half angle
+    SpatialQuery cone = SpatialQuery::Cone(LocationVector(0.0, 0.0, 0.0, 0.0), 10.0f, 0.7853982f);
+    TEST_CHECK(cone.Test(5.0f, 0.0f, 0.0f));
+    TEST_CHECK(cone.Test(5.0f, 4.0f, 0.0f));
+    TEST_CHECK(!cone.Test(4.0f, 5.0f, 0.0f));
+    TEST_CHECK(!cone.Test(-5.0f, 0.0f, 0.0f));
+}
+
+} // namespace
+
+int main()
+{
+    TestBoundary();
+
+    // Counts cover whole SIMD widths, tails and several mask words
+    const size_t counts[] = { 1, 7, 64, 67, 1000, 4096 };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+    {
+        LocationVector center(1234.5, -877.25, 12.0, 2.0);
+        TestExactMatch(SpatialQuery::Range(center, 50.0f), 50.0f, counts[i], i + 1);
+        TestExactMatch(SpatialQuery::Range2D(center, 50.0f), 50.0f, counts[i], i + 101);
+        TestExactMatch(SpatialQuery::Cone(center, 50.0f, 0.6f), 50.0f, counts[i], i + 201);
+        TestExactMatch(SpatialQuery::Cone(LocationVector(-30000.0, 30000.0, 0.0, -1.0), 300.0f, 2.5f), 300.0f, counts[i], i + 301);
+    }
+    return UnitTest::Result("SpatialKernelsTest");
+}
@@ -0,0 +1,212 @@
+#include "../../include/BatchedUdpIO.h"
+
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+BatchedUdpIO::BatchedUdpIO(size_t batchSize, size_t maxDatagramSize)
+    : m_batchSize(batchSize ? batchSize : 1)
+    , m_maxDatagramSize(maxDatagramSize)
+{
+    m_recvData.resize(m_batchSize * m_maxDatagramSize);
+    m_recvAddrs.resize(m_batchSize);
+    m_outbound.reserve(m_batchSize);
+#if defined(__linux__)
+    m_recvMsgs.resize(m_batchSize);
+    m_recvIovs.resize(m_batchSize);
+    m_sendMsgs.resize(m_batchSize);
+    m_sendIovs.resize(m_batchSize * ByteBufferChain::MAX_SEGMENTS);
+#endif
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+size_t BatchedUdpIO::Receive(int fd, const ReceiveCallback& callback, size_t maxBatches)
+{
+    size_t total = 0;
+
+#if defined(__linux__)
+    std::vector<struct mmsghdr>& msgs = m_recvMsgs;
+    std::vector<struct iovec>& iovs = m_recvIovs;
+
+    for (size_t batch = 0; batch < maxBatches; ++batch)
+    {
+        for (size_t i = 0; i < m_batchSize; ++i)
+        {
+            iovs[i].iov_base = &m_recvData[i * m_maxDatagramSize];
+            iovs[i].iov_len = m_maxDatagramSize;
+
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &m_recvAddrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(m_recvAddrs[i]);
+        }
+
+        int count = recvmmsg(fd, &msgs[0], (unsigned int)m_batchSize, MSG_DONTWAIT, NULL);
+        ++m_stats.receiveCalls;
+        if (count <= 0)
+        {
+            break;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            // Truncated datagrams are larger than anything the protocol sends
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+            {
+                continue;
+            }
+
+            callback(&m_recvData[i * m_maxDatagramSize], msgs[i].msg_len,
+                     (struct sockaddr*)&m_recvAddrs[i], msgs[i].msg_hdr.msg_namelen);
+            ++total;
+        }
+
+        m_stats.datagramsReceived += count;
+
+        if ((size_t)count < m_batchSize)
+        {
+            break;
+        }
+    }
+#else
+    // Never block the caller, even if the socket was left blocking
+#ifdef MSG_DONTWAIT
+    const int flags = MSG_DONTWAIT;
+#else
+    const int flags = 0;
+#endif
+
+    for (size_t i = 0; i < maxBatches * m_batchSize; ++i)
+    {
+        socklen_t addrLen = sizeof(m_recvAddrs[0]);
+        int len = recvfrom(fd, &m_recvData[0], (int)m_maxDatagramSize, flags,
+                           (struct sockaddr*)&m_recvAddrs[0], &addrLen);
+        ++m_stats.receiveCalls;
+        if (len < 0)
+        {
+            break;
+        }
+
+        ++m_stats.datagramsReceived;
+
+        // A datagram filling the whole buffer may have been cut short
+        if ((size_t)len >= m_maxDatagramSize)
+        {
+            continue;
+        }
+
+        callback(&m_recvData[0], len, (struct sockaddr*)&m_recvAddrs[0], addrLen);
+        ++total;
+    }
+#endif
+
+    return total;
+}
+
+void BatchedUdpIO::Queue(const struct sockaddr* addr, socklen_t addrLen, ByteBufferChain&& chain)
+{
+    if (chain.IsEmpty())
+    {
+        return;
+    }
+
+    // No address family is longer than sockaddr_storage
+    if (addrLen > (socklen_t)sizeof(struct sockaddr_storage))
+    {
+        addrLen = (socklen_t)sizeof(struct sockaddr_storage);
+    }
+
+    m_outbound.push_back(Outbound());
+    Outbound& outbound = m_outbound.back();
+    memcpy(&outbound.addr, addr, addrLen);
+    outbound.addrLen = addrLen;
+
+    if (chain.GetSegmentCount() > ByteBufferChain::MAX_SEGMENTS)
+    {
+        ByteBuffer flat;
+        chain.Flatten(flat);
+        outbound.chain.AppendOwned(std::move(flat));
+        return;
+    }
+
+    outbound.chain = std::move(chain);
+}
+
+void BatchedUdpIO::Queue(const struct sockaddr* addr, socklen_t addrLen, ByteBuffer&& datagram)
+{
+    ByteBufferChain chain;
+    chain.AppendOwned(std::move(datagram));
+    Queue(addr, addrLen, std::move(chain));
+}
+
+size_t BatchedUdpIO::Flush(int fd)
+{
+    size_t sent = 0;
+
+#if defined(__linux__)
+    std::vector<struct mmsghdr>& msgs = m_sendMsgs;
+    std::vector<struct iovec>& iovs = m_sendIovs;
+
+    size_t next = 0;
+    while (next < m_outbound.size())
+    {
+        size_t count = std::min(m_batchSize, m_outbound.size() - next);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Outbound& outbound = m_outbound[next + i];
+            struct iovec* iov = &iovs[i * ByteBufferChain::MAX_SEGMENTS];
+
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &outbound.addr;
+            msgs[i].msg_hdr.msg_namelen = outbound.addrLen;
+            msgs[i].msg_hdr.msg_iov = iov;
+            msgs[i].msg_hdr.msg_iovlen = outbound.chain.BuildIoVec(iov, ByteBufferChain::MAX_SEGMENTS);
+        }
+
+        int result = sendmmsg(fd, &msgs[0], (unsigned int)count, 0);
+        ++m_stats.sendCalls;
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // Drop the rest of the batch rather than spin on a full socket
+            m_stats.sendErrors += count;
+            next += count;
+            continue;
+        }
+
+        // A short count means the first unsent datagram failed; skip it
+        sent += result;
+        next += result;
+        if ((size_t)result < count)
+        {
+            ++m_stats.sendErrors;
+            ++next;
+        }
+    }
+#else
+    for (size_t i = 0; i < m_outbound.size(); ++i)
+    {
+        Outbound& outbound = m_outbound[i];
+        ++m_stats.sendCalls;
+        if (outbound.chain.SendTo(fd, (struct sockaddr*)&outbound.addr, outbound.addrLen) < 0)
+        {
+            ++m_stats.sendErrors;
+            continue;
+        }
+        ++sent;
+    }
+#endif
+
+    m_stats.datagramsSent += sent;
+    m_outbound.clear();
+    return sent;
+}
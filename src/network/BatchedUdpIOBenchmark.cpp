@@ -0,0 +1,107 @@
+#include "../../include/BatchedUdpIO.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t DATAGRAM_SIZE = 120;
+const size_t ROUND_SIZE = 256;
+
+/**
+ * @brief Open a non-blocking UDP socket on a loopback port picked by the kernel
+ */
+int OpenLoopback(struct sockaddr_in& addr)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    int bufferSize = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || getsockname(fd, (struct sockaddr*)&addr, &addrLen) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Push datagrams through loopback in rounds and report packets per second
+ */
+void Run(size_t batchSize, size_t datagrams)
+{
+    struct sockaddr_in senderAddr, receiverAddr;
+    int sender = OpenLoopback(senderAddr);
+    int receiver = OpenLoopback(receiverAddr);
+    if (sender < 0 || receiver < 0)
+    {
+        printf("batch %3zu: could not open loopback sockets\n", batchSize);
+        exit(1);
+    }
+
+    byte payload[DATAGRAM_SIZE] = { 0 };
+    BatchedUdpIO senderIO(batchSize);
+    BatchedUdpIO receiverIO(batchSize);
+    size_t received = 0;
+    BatchedUdpIO::ReceiveCallback count = [&received](const char*, size_t, struct sockaddr*, socklen_t) { ++received; };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < datagrams; sent += ROUND_SIZE)
+    {
+        for (size_t i = sent; i < datagrams && i < sent + ROUND_SIZE; ++i)
+        {
+            ByteBuffer datagram(DATAGRAM_SIZE);
+            datagram.append(payload, DATAGRAM_SIZE);
+            senderIO.Queue((struct sockaddr*)&receiverAddr, sizeof(receiverAddr), std::move(datagram));
+        }
+        senderIO.Flush(sender);
+
+        // Loopback delivers synchronously, so the round is already queued
+        while (receiverIO.Receive(receiver, count, ROUND_SIZE))
+        {
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BatchedUdpIO::Stats sendStats, receiveStats;
+    senderIO.GetStats(sendStats);
+    receiverIO.GetStats(receiveStats);
+    printf("batch %3zu: %9.0f pps, %zu of %zu received, %.3f send and %.3f receive calls per datagram\n",
+           batchSize, received / seconds, received, datagrams,
+           double(sendStats.sendCalls) / datagrams, double(receiveStats.receiveCalls) / (received ? received : 1));
+
+    close(sender);
+    close(receiver);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t datagrams = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+
+    // One datagram per call is the Game.BatchedIO = 0 configuration
+    const size_t batchSizes[] = { 1, 8, 32, 64 };
+    for (size_t i = 0; i < sizeof(batchSizes) / sizeof(batchSizes[0]); ++i)
+    {
+        Run(batchSizes[i], datagrams);
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "../../include/ByteBufferChain.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <cstring>
+#include <cerrno>
+#endif
+
+int ByteBufferChain::SendTo(int fd, const struct sockaddr* addr, socklen_t addrLen) const
+{
+    if (m_segments.empty())
+    {
+        return 0;
+    }
+
+#ifdef _WIN32
+    // No sendmsg here, send one contiguous copy instead
+    ByteBuffer flat;
+    Flatten(flat);
+    return sendto(fd, (const char*)flat.contents(), (int)flat.wpos(), 0, addr, addrLen);
+#else
+    if (m_segments.size() > MAX_SEGMENTS)
+    {
+        ByteBuffer flat;
+        Flatten(flat);
+        return (int)sendto(fd, flat.contents(), flat.wpos(), 0, addr, addrLen);
+    }
+
+    struct iovec iov[MAX_SEGMENTS];
+    size_t count = BuildIoVec(iov, MAX_SEGMENTS);
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = const_cast<struct sockaddr*>(addr);
+    msg.msg_namelen = addrLen;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    ssize_t sent;
+    do
+    {
+        sent = sendmsg(fd, &msg, 0);
+    } while (sent < 0 && errno == EINTR);
+
+    return (int)sent;
+#endif
+}
@@ -0,0 +1,191 @@
+#include "../../include/Fragmentation.h"
+
+#include <cstring>
+
+size_t FragmentSplitter::Split(const ByteBufferChain::SharedBuffer& message, size_t maxPayload, uint16_t messageId, const FragmentCallback& emit)
+{
+    size_t total = message->wpos();
+    if (!maxPayload || total == 0)
+    {
+        return 0;
+    }
+
+    size_t count = (total + maxPayload - 1) / maxPayload;
+    if (count > MAX_FRAGMENTS)
+    {
+        return 0;
+    }
+
+    FragmentHeader header;
+    header.messageId = messageId;
+    header.fragmentCount = (uint16_t)count;
+    header.totalLength = (uint32_t)total;
+    size_t stride = header.GetStride();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t offset = i * stride;
+        size_t length = i + 1 < count ? stride : total - offset;
+
+        ByteBuffer fragmentHeader;
+        fragmentHeader.reserve(FragmentHeader::SIZE);
+        fragmentHeader << header.messageId;
+        fragmentHeader << (uint16_t)i;
+        fragmentHeader << header.fragmentCount;
+        fragmentHeader << header.totalLength;
+
+        ByteBufferChain fragment;
+        fragment.AppendOwned(std::move(fragmentHeader));
+        fragment.AppendShared(message, offset, length);
+        emit(fragment);
+    }
+
+    return count;
+}
+
+FragmentAssembler::FragmentAssembler(size_t maxMessages, size_t maxBytes, uint32_t timeout)
+    : m_maxMessages(maxMessages)
+    , m_maxBytes(maxBytes)
+    , m_reservedBytes(0)
+    , m_timeout(timeout)
+    , m_recentNext(0)
+{
+    for (size_t i = 0; i < RECENT_COMPLETED; ++i)
+    {
+        m_recent[i] = 0xFFFFFFFF;
+    }
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+FragmentAssembler::Result FragmentAssembler::AddFragment(ByteView& data, uint32_t now, ByteBuffer& message)
+{
+    if (data.remaining() < FragmentHeader::SIZE)
+    {
+        ++m_stats.rejected;
+        return FRAGMENT_REJECTED;
+    }
+
+    FragmentHeader header;
+    data >> header.messageId;
+    data >> header.fragmentIndex;
+    data >> header.fragmentCount;
+    data >> header.totalLength;
+
+    if (header.fragmentCount == 0 || header.fragmentCount > FragmentSplitter::MAX_FRAGMENTS ||
+        header.fragmentIndex >= header.fragmentCount || header.totalLength < header.fragmentCount ||
+        header.totalLength > m_maxBytes)
+    {
+        ++m_stats.rejected;
+        return FRAGMENT_REJECTED;
+    }
+
+    // Every fragment must land exactly on its slot
+    uint32_t stride = header.GetStride();
+    size_t offset = (size_t)header.fragmentIndex * stride;
+    size_t length = header.fragmentIndex + 1 < header.fragmentCount ? stride : header.totalLength - offset;
+    if (offset >= header.totalLength || data.remaining() != length)
+    {
+        ++m_stats.rejected;
+        return FRAGMENT_REJECTED;
+    }
+
+    std::map<uint16_t, Pending>::iterator itr = m_pending.find(header.messageId);
+    if (itr != m_pending.end() &&
+        (itr->second.fragmentCount != header.fragmentCount || itr->second.totalLength != header.totalLength))
+    {
+        // A reused message ID after the old message was abandoned by the sender
+        Release(itr);
+        itr = m_pending.end();
+    }
+
+    if (itr == m_pending.end())
+    {
+        if (IsRecentlyCompleted(header.messageId))
+        {
+            return FRAGMENT_DUPLICATE;
+        }
+
+        Expire(now);
+        if (m_pending.size() >= m_maxMessages || m_reservedBytes + header.totalLength > m_maxBytes)
+        {
+            ++m_stats.rejected;
+            return FRAGMENT_REJECTED;
+        }
+
+        itr = m_pending.insert(std::make_pair(header.messageId, Pending())).first;
+        Pending& pending = itr->second;
+        // Filled by writeAt; complete only once every fragment has arrived
+        pending.buffer.extendUninitialized(header.totalLength);
+        pending.received.assign(header.fragmentCount, 0);
+        pending.fragmentCount = header.fragmentCount;
+        pending.receivedCount = 0;
+        pending.totalLength = header.totalLength;
+        pending.firstSeen = now;
+        m_reservedBytes += header.totalLength;
+    }
+
+    Pending& pending = itr->second;
+    if (pending.received[header.fragmentIndex])
+    {
+        return FRAGMENT_DUPLICATE;
+    }
+
+    pending.buffer.writeAt(offset, data.contents() + data.rpos(), length);
+    data.skip(length);
+    pending.received[header.fragmentIndex] = 1;
+
+    if (++pending.receivedCount < pending.fragmentCount)
+    {
+        return FRAGMENT_PENDING;
+    }
+
+    pending.buffer.wpos(pending.totalLength);
+    message = std::move(pending.buffer);
+    m_recent[m_recentNext] = header.messageId;
+    m_recentNext = (m_recentNext + 1) % RECENT_COMPLETED;
+    Release(itr);
+    ++m_stats.completed;
+    return FRAGMENT_COMPLETE;
+}
+
+size_t FragmentAssembler::Expire(uint32_t now)
+{
+    size_t expired = 0;
+    std::map<uint16_t, Pending>::iterator itr = m_pending.begin();
+    while (itr != m_pending.end())
+    {
+        std::map<uint16_t, Pending>::iterator current = itr++;
+        if (now - current->second.firstSeen >= m_timeout)
+        {
+            Release(current);
+            ++expired;
+        }
+    }
+
+    m_stats.expired += expired;
+    return expired;
+}
+
+void FragmentAssembler::Clear()
+{
+    m_pending.clear();
+    m_reservedBytes = 0;
+}
+
+bool FragmentAssembler::IsRecentlyCompleted(uint16_t messageId) const
+{
+    for (size_t i = 0; i < RECENT_COMPLETED; ++i)
+    {
+        if (m_recent[i] == messageId)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FragmentAssembler::Release(std::map<uint16_t, Pending>::iterator itr)
+{
+    m_reservedBytes -= itr->second.totalLength;
+    m_pending.erase(itr);
+}
@@ -0,0 +1,171 @@
+#include "../../include/LocationCodec.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Full turn in radians
+ */
+static const double TWO_PI = 6.283185307179586476925;
+
+LocationCodec::LocationCodec(const LocationVector& boundsMin, const LocationVector& boundsMax, uint8_t positionBits, uint8_t orientationBits)
+    : m_positionBits(std::min(std::max(positionBits, uint8_t(1)), uint8_t(MAX_POSITION_BITS)))
+    , m_orientationBits(std::min(std::max(orientationBits, uint8_t(1)), uint8_t(MAX_ORIENTATION_BITS)))
+{
+    m_maxPosition = (1u << m_positionBits) - 1;
+    m_orientationSteps = 1u << m_orientationBits;
+
+    double min[3] = { boundsMin.x, boundsMin.y, boundsMin.z };
+    double max[3] = { boundsMax.x, boundsMax.y, boundsMax.z };
+    for (int i = 0; i < 3; ++i)
+    {
+        double extent = std::max(max[i] - min[i], 1e-6);
+        m_min[i] = min[i];
+        m_step[i] = extent / m_maxPosition;
+        m_scale[i] = m_maxPosition / extent;
+    }
+}
+
+uint32_t LocationCodec::QuantizeAxis(double value, double min, double scale, uint32_t maxValue)
+{
+    double steps = std::floor((value - min) * scale + 0.5);
+    if (!(steps > 0.0))
+    {
+        return 0;   // Also catches NaN
+    }
+    return steps >= maxValue ? maxValue : (uint32_t)steps;
+}
+
+QuantizedLocation LocationCodec::Quantize(const LocationVector& location) const
+{
+    QuantizedLocation quantized;
+    quantized.x = QuantizeAxis(location.x, m_min[0], m_scale[0], m_maxPosition);
+    quantized.y = QuantizeAxis(location.y, m_min[1], m_scale[1], m_maxPosition);
+    quantized.z = QuantizeAxis(location.z, m_min[2], m_scale[2], m_maxPosition);
+
+    // Any angle maps onto one turn; a full turn wraps to 0
+    double turns = location.o / TWO_PI;
+    turns -= std::floor(turns);
+    double steps = std::floor(turns * m_orientationSteps + 0.5);
+    quantized.o = steps >= 0.0 && steps < m_orientationSteps ? (uint32_t)steps : 0;
+    return quantized;
+}
+
+LocationVector LocationCodec::Dequantize(const QuantizedLocation& quantized) const
+{
+    return LocationVector(m_min[0] + quantized.x * m_step[0],
+                          m_min[1] + quantized.y * m_step[1],
+                          m_min[2] + quantized.z * m_step[2],
+                          quantized.o * (TWO_PI / m_orientationSteps));
+}
+
+void LocationCodec::Write(const QuantizedLocation& quantized, ByteBuffer& buffer) const
+{
+    uint32_t values[4] = { quantized.x, quantized.y, quantized.z, quantized.o };
+    uint8_t widths[4] = { m_positionBits, m_positionBits, m_positionBits, m_orientationBits };
+    PackBits(values, widths, 4, buffer);
+}
+
+void LocationCodec::WritePosition(const QuantizedLocation& quantized, ByteBuffer& buffer) const
+{
+    uint32_t values[3] = { quantized.x, quantized.y, quantized.z };
+    uint8_t widths[3] = { m_positionBits, m_positionBits, m_positionBits };
+    PackBits(values, widths, 3, buffer);
+}
+
+void LocationCodec::WriteOrientation(const QuantizedLocation& quantized, ByteBuffer& buffer) const
+{
+    PackBits(&quantized.o, &m_orientationBits, 1, buffer);
+}
+
+bool LocationCodec::Read(ByteView& data, QuantizedLocation& quantized) const
+{
+    uint32_t* values[4] = { &quantized.x, &quantized.y, &quantized.z, &quantized.o };
+    uint8_t widths[4] = { m_positionBits, m_positionBits, m_positionBits, m_orientationBits };
+
+    // Orientation values are always below one turn; position values
+    // cannot exceed their bit width
+    return UnpackBits(data, values, widths, 4) && quantized.o < m_orientationSteps;
+}
+
+bool LocationCodec::ReadPosition(ByteView& data, QuantizedLocation& quantized) const
+{
+    uint32_t* values[3] = { &quantized.x, &quantized.y, &quantized.z };
+    uint8_t widths[3] = { m_positionBits, m_positionBits, m_positionBits };
+    return UnpackBits(data, values, widths, 3);
+}
+
+bool LocationCodec::ReadOrientation(ByteView& data, QuantizedLocation& quantized) const
+{
+    uint32_t* values[1] = { &quantized.o };
+    return UnpackBits(data, values, &m_orientationBits, 1) && quantized.o < m_orientationSteps;
+}
+
+bool LocationCodec::Read(ByteView& data, LocationVector& location) const
+{
+    QuantizedLocation quantized;
+    if (!Read(data, quantized))
+    {
+        return false;
+    }
+
+    location = Dequantize(quantized);
+    return true;
+}
+
+double LocationCodec::GetPositionStep() const
+{
+    return std::max(m_step[0], std::max(m_step[1], m_step[2]));
+}
+
+void LocationCodec::PackBits(const uint32_t* values, const uint8_t* widths, size_t count, ByteBuffer& buffer)
+{
+    // Little-endian bit stream, flushed a byte at a time
+    uint64_t bits = 0;
+    uint32_t pending = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        bits |= uint64_t(values[i] & ((1u << widths[i]) - 1)) << pending;
+        pending += widths[i];
+        while (pending >= 8)
+        {
+            buffer << uint8_t(bits);
+            bits >>= 8;
+            pending -= 8;
+        }
+    }
+    if (pending)
+    {
+        buffer << uint8_t(bits);
+    }
+}
+
+bool LocationCodec::UnpackBits(ByteView& data, uint32_t* const* values, const uint8_t* widths, size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total += widths[i];
+    }
+    if (data.remaining() < (total + 7) / 8)
+    {
+        return false;
+    }
+
+    uint64_t bits = 0;
+    uint32_t available = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        while (available < widths[i])
+        {
+            uint8_t byte;
+            data >> byte;
+            bits |= uint64_t(byte) << available;
+            available += 8;
+        }
+        *values[i] = uint32_t(bits & ((1u << widths[i]) - 1));
+        bits >>= widths[i];
+        available -= widths[i];
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+#include "../../include/LocationCodec.h"
+#include "../../include/UnitTest.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double TWO_PI = 6.283185307179586476925;
+
+/**
+ * @brief Deterministic generator so failures reproduce
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    double Next(double min, double max)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return min + (max - min) * (double)(state >> 11) / (double)(1ULL << 53);
+    }
+};
+
+/**
+ * @brief Distance between two angles, wrapping at a full turn
+ */
+double AngleError(double a, double b)
+{
+    double difference = std::fmod(std::fabs(a - b), TWO_PI);
+    return std::min(difference, TWO_PI - difference);
+}
+
+/**
+ * @brief Write then read a location, checking the size and the bits
+ */
+void CheckWireRoundTrip(const LocationCodec& codec, const QuantizedLocation& quantized)
+{
+    ByteBuffer buffer;
+    codec.Write(quantized, buffer);
+    TEST_CHECK(buffer.wpos() == codec.GetEncodedSize());
+
+    ByteView view(buffer);
+    QuantizedLocation read;
+    TEST_CHECK(codec.Read(view, read));
+    TEST_CHECK(read == quantized);
+    TEST_CHECK(view.remaining() == 0);
+
+    // Position and orientation written apart read back the same
+    ByteBuffer split;
+    codec.WritePosition(quantized, split);
+    TEST_CHECK(split.wpos() == codec.GetPositionSize());
+    codec.WriteOrientation(quantized, split);
+    TEST_CHECK(split.wpos() == codec.GetPositionSize() + codec.GetOrientationSize());
+
+    ByteView splitView(split);
+    QuantizedLocation splitRead;
+    TEST_CHECK(codec.ReadPosition(splitView, splitRead));
+    TEST_CHECK(codec.ReadOrientation(splitView, splitRead));
+    TEST_CHECK(splitRead == quantized);
+}
+
+/**
+ * @brief Random locations inside the box stay within half a step and round trip exactly
+ */
+void TestRoundTripAndErrorBound(uint8_t positionBits, uint8_t orientationBits)
+{
+    LocationVector boundsMin(-1000.0, -50.0, 0.0);
+    LocationVector boundsMax(3000.0, 150.0, 1.0);
+    LocationCodec codec(boundsMin, boundsMax, positionBits, orientationBits);
+
+    double steps = (double)((1u << positionBits) - 1);
+    double halfStep[3] = { 4000.0 / steps / 2, 200.0 / steps / 2, 1.0 / steps / 2 };
+    double halfTurnStep = TWO_PI / (1u << orientationBits) / 2;
+    const double slack = 1e-9;
+
+    Random random(positionBits * 131 + orientationBits);
+    size_t failures = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        LocationVector location(random.Next(boundsMin.x, boundsMax.x),
+                                random.Next(boundsMin.y, boundsMax.y),
+                                random.Next(boundsMin.z, boundsMax.z),
+                                random.Next(-2 * TWO_PI, 2 * TWO_PI));
+        QuantizedLocation quantized = codec.Quantize(location);
+        LocationVector rounded = codec.Dequantize(quantized);
+
+        // Error bound: half a step per axis, half a step of the turn
+        if (std::fabs(rounded.x - location.x) > halfStep[0] + slack ||
+            std::fabs(rounded.y - location.y) > halfStep[1] + slack ||
+            std::fabs(rounded.z - location.z) > halfStep[2] + slack ||
+            AngleError(rounded.o, location.o) > halfTurnStep + slack)
+        {
+            ++failures;
+        }
+
+        // Quantizing what the peer sees gives the same bits again
+        if (codec.Quantize(rounded) != quantized || codec.Round(rounded).x != rounded.x)
+        {
+            ++failures;
+        }
+
+        if (i % 100 == 0)
+        {
+            CheckWireRoundTrip(codec, quantized);
+        }
+    }
+    TEST_CHECK(failures == 0);
+}
+
+/**
+ * @brief The box corners map to the ends of the range and outside values clamp
+ */
+void TestBounds()
+{
+    LocationVector boundsMin(-100.0, -100.0, -100.0);
+    LocationVector boundsMax(100.0, 100.0, 100.0);
+    LocationCodec codec(boundsMin, boundsMax, 20, 10);
+    uint32_t maxPosition = (1u << 20) - 1;
+
+    QuantizedLocation low = codec.Quantize(boundsMin);
+    TEST_CHECK(low.x == 0 && low.y == 0 && low.z == 0);
+    QuantizedLocation high = codec.Quantize(boundsMax);
+    TEST_CHECK(high.x == maxPosition && high.y == maxPosition && high.z == maxPosition);
+
+    // The corners survive the round trip exactly
+    TEST_CHECK(codec.Round(boundsMin).x == boundsMin.x);
+    TEST_CHECK(std::fabs(codec.Round(boundsMax).x - boundsMax.x) < 1e-9);
+
+    QuantizedLocation outside = codec.Quantize(LocationVector(-1e9, 1e9, 100.5));
+    TEST_CHECK(outside.x == 0 && outside.y == maxPosition && outside.z == maxPosition);
+
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    QuantizedLocation invalid = codec.Quantize(LocationVector(nan, nan, nan, nan));
+    TEST_CHECK(invalid.x == 0 && invalid.y == 0 && invalid.z == 0 && invalid.o == 0);
+
+    CheckWireRoundTrip(codec, low);
+    CheckWireRoundTrip(codec, high);
+}
+
+/**
+ * @brief Orientation wraps at a full turn in either direction
+ */
+void TestOrientationWrap()
+{
+    LocationCodec codec;
+    uint32_t steps = 1u << codec.GetOrientationBits();
+
+    TEST_CHECK(codec.Quantize(LocationVector(0, 0, 0, 0.0)).o == 0);
+    TEST_CHECK(codec.Quantize(LocationVector(0, 0, 0, TWO_PI)).o == 0);
+    TEST_CHECK(codec.Quantize(LocationVector(0, 0, 0, TWO_PI - 1e-12)).o == 0);
+    TEST_CHECK(codec.Quantize(LocationVector(0, 0, 0, -TWO_PI / 4)).o == steps * 3 / 4);
+    TEST_CHECK(codec.Quantize(LocationVector(0, 0, 0, 5 * TWO_PI + TWO_PI / 2)).o == steps / 2);
+}
+
+/**
+ * @brief Sizes match the documented packing, and truncated data is rejected
+ */
+void TestSizesAndTruncation()
+{
+    LocationCodec codec;
+    TEST_CHECK(codec.GetEncodedSize() == 9);
+    TEST_CHECK(codec.GetPositionSize() == 8);
+    TEST_CHECK(codec.GetOrientationSize() == 2);
+
+    LocationCodec widest(LocationVector(0, 0, 0), LocationVector(1, 1, 1), 255, 255);
+    TEST_CHECK(widest.GetPositionBits() == LocationCodec::MAX_POSITION_BITS);
+    TEST_CHECK(widest.GetOrientationBits() == LocationCodec::MAX_ORIENTATION_BITS);
+
+    ByteBuffer buffer;
+    codec.Write(LocationVector(1.0, 2.0, 3.0, 1.0), buffer);
+    ByteView truncated(buffer.contents(), buffer.wpos() - 1);
+    QuantizedLocation quantized;
+    TEST_CHECK(!codec.Read(truncated, quantized));
+}
+
+} // namespace
+
+int main()
+{
+    TestRoundTripAndErrorBound(20, 10);
+    TestRoundTripAndErrorBound(1, 1);
+    TestRoundTripAndErrorBound(7, 3);
+    TestRoundTripAndErrorBound(LocationCodec::MAX_POSITION_BITS, LocationCodec::MAX_ORIENTATION_BITS);
+    TestBounds();
+    TestOrientationWrap();
+    TestSizesAndTruncation();
+    return UnitTest::Result("LocationCodecTest");
+}
@@ -0,0 +1,84 @@
+#include "../../include/PacketAggregator.h"
+
+#include <cstring>
+
+PacketAggregator::PacketAggregator(size_t mtu)
+{
+    for (size_t i = 0; i < 2; ++i)
+    {
+        m_open[i].type = 0;
+        m_open[i].blockCount = 0;
+        m_open[i].encrypted = false;
+    }
+
+    memset(&m_stats, 0, sizeof(m_stats));
+    SetMtu(mtu);
+}
+
+void PacketAggregator::SetMtu(size_t mtu)
+{
+    size_t headers = GAME_HEADER_SIZE + ACK_BITS_SIZE;
+    m_maxPayload = mtu > headers + BLOCK_HEADER_SIZE ? mtu - headers : (size_t)BLOCK_HEADER_SIZE;
+}
+
+void PacketAggregator::Add(uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, bool encrypted, const PacketCallback& emit)
+{
+    Reserve(type, block->wpos(), reliable, encrypted, emit).blocks.AppendShared(block);
+}
+
+void PacketAggregator::Add(uint16_t type, ByteBuffer&& block, bool reliable, bool encrypted, const PacketCallback& emit)
+{
+    Reserve(type, block.wpos(), reliable, encrypted, emit).blocks.AppendOwned(std::move(block));
+}
+
+size_t PacketAggregator::Flush(const PacketCallback& emit)
+{
+    size_t emitted = 0;
+
+    // Reliable first: it carries the state the client must not miss
+    for (int reliable = 1; reliable >= 0; --reliable)
+    {
+        if (m_open[reliable].blockCount)
+        {
+            Emit(m_open[reliable], reliable != 0, emit);
+            ++emitted;
+        }
+    }
+
+    return emitted;
+}
+
+PacketAggregator::OpenPacket& PacketAggregator::Reserve(uint16_t type, size_t length, bool reliable, bool encrypted, const PacketCallback& emit)
+{
+    OpenPacket& packet = m_open[reliable ? 1 : 0];
+
+    // Oversized blocks travel alone and are left to fragmentation; a
+    // change of encryption starts a new packet
+    if (packet.blockCount &&
+        (packet.encrypted != encrypted ||
+         packet.blocks.GetTotalLength() + length > m_maxPayload ||
+         packet.blockCount == 255 ||
+         packet.blocks.GetSegmentCount() + 1 >= ByteBufferChain::MAX_SEGMENTS))
+    {
+        Emit(packet, reliable, emit);
+    }
+
+    if (!packet.blockCount)
+    {
+        packet.type = type;
+        packet.encrypted = encrypted;
+    }
+
+    ++packet.blockCount;
+    ++m_stats.blocks;
+    return packet;
+}
+
+void PacketAggregator::Emit(OpenPacket& packet, bool reliable, const PacketCallback& emit)
+{
+    emit(packet.type, packet.blocks, packet.blockCount, reliable, packet.encrypted);
+    ++m_stats.packets;
+
+    packet.blocks.Clear();
+    packet.blockCount = 0;
+}
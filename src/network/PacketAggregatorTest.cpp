@@ -0,0 +1,87 @@
+#include "../../include/PacketAggregator.h"
+#include "../../include/UnitTest.h"
+
+#include <vector>
+
+namespace {
+
+/**
+ * @brief A packet as handed to the callback
+ */
+struct Emitted
+{
+    uint8_t blockCount;
+    bool reliable;
+    bool encrypted;
+};
+
+ByteBuffer MakeBlock(uint16_t type, size_t size)
+{
+    ByteBuffer block;
+    block << type;
+    block << uint16_t(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        block << uint8_t(i);
+    }
+    return block;
+}
+
+PacketAggregator::PacketCallback Record(std::vector<Emitted>& emitted)
+{
+    return [&emitted](uint16_t, ByteBufferChain&, uint8_t blockCount, bool reliable, bool encrypted) {
+        Emitted packet = { blockCount, reliable, encrypted };
+        emitted.push_back(packet);
+    };
+}
+
+/**
+ * @brief Encrypted and plaintext blocks never share a packet, and keep their order
+ */
+void TestEncryptionChangeSplits()
+{
+    PacketAggregator aggregator;
+    std::vector<Emitted> emitted;
+    PacketAggregator::PacketCallback emit = Record(emitted);
+
+    aggregator.Add(1, MakeBlock(1, 10), true, false, emit);
+    aggregator.Add(2, MakeBlock(2, 10), true, false, emit);
+    aggregator.Add(3, MakeBlock(3, 10), true, true, emit);
+    aggregator.Add(4, MakeBlock(4, 10), true, true, emit);
+    aggregator.Add(5, MakeBlock(5, 10), true, false, emit);
+    aggregator.Flush(emit);
+
+    TEST_CHECK(emitted.size() == 3);
+    TEST_CHECK(emitted.size() == 3 && emitted[0].blockCount == 2 && !emitted[0].encrypted);
+    TEST_CHECK(emitted.size() == 3 && emitted[1].blockCount == 2 && emitted[1].encrypted);
+    TEST_CHECK(emitted.size() == 3 && emitted[2].blockCount == 1 && !emitted[2].encrypted);
+    TEST_CHECK(!aggregator.HasPending());
+}
+
+/**
+ * @brief The flag is passed through for packets of either reliability
+ */
+void TestFlagReachesCallback()
+{
+    PacketAggregator aggregator;
+    std::vector<Emitted> emitted;
+    PacketAggregator::PacketCallback emit = Record(emitted);
+
+    aggregator.Add(1, MakeBlock(1, 10), false, true, emit);
+    aggregator.Add(2, MakeBlock(2, 10), true, false, emit);
+    TEST_CHECK(emitted.empty());
+    aggregator.Flush(emit);
+
+    TEST_CHECK(emitted.size() == 2);
+    TEST_CHECK(emitted.size() == 2 && emitted[0].reliable && !emitted[0].encrypted);
+    TEST_CHECK(emitted.size() == 2 && !emitted[1].reliable && emitted[1].encrypted);
+}
+
+} // namespace
+
+int main()
+{
+    TestEncryptionChangeSplits();
+    TestFlagReachesCallback();
+    return UnitTest::Result("PacketAggregatorTest");
+}
@@ -0,0 +1,220 @@
+#include "../../include/PacketCompressor.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+
+namespace {
+
+/**
+ * @brief zstd contexts of the calling thread
+ *
+ * Contexts are reused for every packet the thread compresses, whatever
+ * the connection, so their allocations are made once per thread.
+ */
+struct ThreadContexts {
+    ZSTD_CCtx* compress;
+    ZSTD_DCtx* decompress;
+    ByteBuffer input;
+
+    ThreadContexts() : compress(ZSTD_createCCtx()), decompress(ZSTD_createDCtx()) {}
+
+    ~ThreadContexts()
+    {
+        ZSTD_freeCCtx(compress);
+        ZSTD_freeDCtx(decompress);
+    }
+
+    static ThreadContexts& Get()
+    {
+        static thread_local ThreadContexts contexts;
+        return contexts;
+    }
+};
+
+}
+#endif
+
+CompressionDictionary::~CompressionDictionary()
+{
+#ifdef HAVE_ZSTD
+    ZSTD_freeCDict(m_compress);
+    ZSTD_freeDDict(m_decompress);
+#endif
+}
+
+CompressionDictionary::Ptr CompressionDictionary::Load(const std::string& path, int level)
+{
+#ifdef HAVE_ZSTD
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        return Ptr();
+    }
+
+    std::shared_ptr<CompressionDictionary> dictionary(new CompressionDictionary());
+    dictionary->m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (dictionary->m_data.empty())
+    {
+        return Ptr();
+    }
+
+    dictionary->m_compress = ZSTD_createCDict(dictionary->m_data.data(), dictionary->m_data.size(), level);
+    dictionary->m_decompress = ZSTD_createDDict(dictionary->m_data.data(), dictionary->m_data.size());
+    if (!dictionary->m_compress || !dictionary->m_decompress)
+    {
+        return Ptr();
+    }
+
+    return dictionary;
+#else
+    (void)path;
+    (void)level;
+    return Ptr();
+#endif
+}
+
+bool CompressionDictionary::Train(const std::vector<ByteBuffer>& samples, size_t capacity, ByteBuffer& dictionary)
+{
+#ifdef HAVE_ZSTD
+    ByteBuffer joined;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        joined.append(samples[i].contents(), samples[i].wpos());
+        sizes.push_back(samples[i].wpos());
+    }
+
+    dictionary.clear();
+    byte* trained = dictionary.extendUninitialized(capacity);
+    size_t size = ZDICT_trainFromBuffer(trained, capacity,
+        joined.contents(), sizes.data(), (unsigned)sizes.size());
+    if (ZDICT_isError(size))
+    {
+        dictionary.clear();
+        return false;
+    }
+
+    dictionary.wpos(size);
+    dictionary.shrinkToWpos();
+    return true;
+#else
+    (void)samples;
+    (void)capacity;
+    dictionary.clear();
+    return false;
+#endif
+}
+
+PacketCompressor::PacketCompressor(size_t threshold, int level)
+    : m_threshold(threshold)
+    , m_level(level)
+    , m_enabled(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool PacketCompressor::IsAvailable()
+{
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PacketCompressor::Enable(const CompressionDictionary::Ptr& dictionary)
+{
+    m_dictionary = dictionary;
+    m_enabled = IsAvailable();
+}
+
+bool PacketCompressor::Compress(const ByteBufferChain& payload, ByteBuffer& output)
+{
+    size_t length = payload.GetTotalLength();
+    if (!m_enabled || length < m_threshold)
+    {
+        return false;
+    }
+
+#ifdef HAVE_ZSTD
+    ThreadContexts& contexts = ThreadContexts::Get();
+
+    // zstd wants contiguous input; single-segment payloads are used in place
+    const byte* input;
+    if (payload.GetSegmentCount() == 1)
+    {
+        size_t segmentLength;
+        input = payload.GetSegment(0, segmentLength);
+    }
+    else
+    {
+        contexts.input.clear();
+        payload.Flatten(contexts.input);
+        input = contexts.input.contents();
+    }
+
+    output.clear();
+    byte* destination = output.extendUninitialized(ZSTD_compressBound(length));
+    size_t compressed = m_dictionary
+        ? ZSTD_compress_usingCDict(contexts.compress, destination, output.size(), input, length, m_dictionary->m_compress)
+        : ZSTD_compressCCtx(contexts.compress, destination, output.size(), input, length, m_level);
+
+    if (ZSTD_isError(compressed) || compressed >= length)
+    {
+        output.clear();
+        ++m_stats.skipped;
+        return false;
+    }
+
+    output.wpos(compressed);
+    output.shrinkToWpos();
+    ++m_stats.packets;
+    m_stats.bytesIn += length;
+    m_stats.bytesOut += compressed;
+    return true;
+#else
+    (void)output;
+    return false;
+#endif
+}
+
+bool PacketCompressor::Decompress(const byte* data, size_t length, ByteBuffer& output)
+{
+#ifdef HAVE_ZSTD
+    if (m_enabled)
+    {
+        // The frame header carries the payload size; refuse anything oversized
+        // before allocating for it
+        unsigned long long size = ZSTD_getFrameContentSize(data, length);
+        if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR && size <= MAX_DECOMPRESSED_SIZE)
+        {
+            ThreadContexts& contexts = ThreadContexts::Get();
+
+            output.clear();
+            byte* destination = output.extendUninitialized((size_t)size);
+            size_t decompressed = m_dictionary
+                ? ZSTD_decompress_usingDDict(contexts.decompress, destination, (size_t)size, data, length, m_dictionary->m_decompress)
+                : ZSTD_decompressDCtx(contexts.decompress, destination, (size_t)size, data, length);
+
+            if (!ZSTD_isError(decompressed) && decompressed == size)
+            {
+                output.wpos(decompressed);
+                return true;
+            }
+        }
+    }
+#else
+    (void)data;
+    (void)length;
+#endif
+
+    output.clear();
+    ++m_stats.failed;
+    return false;
+}
@@ -0,0 +1,206 @@
+#include "../../include/PacketCompressor.h"
+#include "../../include/MessageTypes.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_ZSTD
+
+namespace {
+
+const size_t TRAINING_PACKETS = 4000;
+const size_t DICTIONARY_CAPACITY = 4 * 1024;
+const int LEVEL = 1;
+
+/**
+ * @brief Deterministic generator so runs compare
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint32_t Next(uint32_t range)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)((state >> 33) % range);
+    }
+};
+
+/**
+ * @brief Write a block header with a zero length, patched once the data is written
+ */
+void BeginBlock(ByteBuffer& payload, uint16_t type)
+{
+    payload << type;
+    payload << uint16_t(0);
+}
+
+/**
+ * @brief Build a payload shaped like the packets the dictionary is meant for
+ *
+ * A few MSG_OBJECT_CREATE blocks, each with an object id, position,
+ * display fields and a name from a small set, and sometimes a
+ * MSG_WORLD_STATE block.
+ */
+ByteBuffer MakePayload(Random& random)
+{
+    static const char* const names[] = { "Forest Wolf", "Kobold Miner", "Town Guard", "Defias Thug", "Murloc Raider", "Stormwind Guard" };
+
+    ByteBuffer payload;
+    size_t objects = 1 + random.Next(6);
+    for (size_t i = 0; i < objects; ++i)
+    {
+        ByteBuffer block;
+        BeginBlock(block, MSG_OBJECT_CREATE);
+        block << uint32_t(0x100000 + random.Next(5000));
+        block << uint8_t(3 + random.Next(2));
+        block << float(-9000.0f + random.Next(2000) * 0.25f);
+        block << float(400.0f + random.Next(2000) * 0.25f);
+        block << float(40.0f + random.Next(400) * 0.125f);
+        block << float(random.Next(628) * 0.01f);
+        block << uint32_t(500 + random.Next(40));
+        block << uint32_t(1 + random.Next(60));
+        block << uint32_t(0x00000008);
+        std::string name = names[random.Next(sizeof(names) / sizeof(names[0]))];
+        block << uint8_t(name.length());
+        block.append(name);
+        PatchBlockLength(block);
+        payload.append(block.contents(), block.wpos());
+    }
+
+    if (random.Next(4) == 0)
+    {
+        ByteBuffer block;
+        BeginBlock(block, MSG_WORLD_STATE);
+        block << uint32_t(0x5F000000 + random.Next(86400));
+        block << uint8_t(random.Next(4));
+        block << float(random.Next(100) * 0.01f);
+        PatchBlockLength(block);
+        payload.append(block.contents(), block.wpos());
+    }
+    return payload;
+}
+
+/**
+ * @brief Compress and decompress every payload and report ratio and speed
+ */
+void Run(const char* label, const CompressionDictionary::Ptr& dictionary, const std::vector<ByteBuffer>& payloads, size_t threshold)
+{
+    PacketCompressor sender(threshold, LEVEL);
+    PacketCompressor receiver(threshold, LEVEL);
+    sender.Enable(dictionary);
+    receiver.Enable(dictionary);
+
+    std::vector<ByteBufferChain> chains(payloads.size());
+    for (size_t i = 0; i < payloads.size(); ++i)
+    {
+        chains[i].AppendOwned(ByteBuffer(payloads[i]));
+    }
+
+    size_t totalBytes = 0;
+    std::vector<ByteBuffer> compressed(payloads.size());
+    std::vector<bool> sentCompressed(payloads.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < payloads.size(); ++i)
+    {
+        sentCompressed[i] = sender.Compress(chains[i], compressed[i]);
+        totalBytes += payloads[i].wpos();
+    }
+    double compressNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    size_t wireBytes = 0;
+    size_t decompressedBytes = 0;
+    size_t mismatches = 0;
+    ByteBuffer output;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < payloads.size(); ++i)
+    {
+        if (!sentCompressed[i])
+        {
+            wireBytes += payloads[i].wpos();
+            continue;
+        }
+        wireBytes += compressed[i].wpos();
+        if (!receiver.Decompress(compressed[i].contents(), compressed[i].wpos(), output))
+        {
+            ++mismatches;
+            continue;
+        }
+        decompressedBytes += output.wpos();
+        mismatches += output.wpos() != payloads[i].wpos() || memcmp(output.contents(), payloads[i].contents(), output.wpos()) != 0;
+    }
+    double decompressNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    PacketCompressor::Stats stats;
+    sender.GetStats(stats);
+    printf("%-15s threshold %3zu: %6llu compressed, %5llu skipped, ratio %.3f (%.3f on the wire), "
+           "%.2f ns/byte compress, %.2f ns/byte decompress, %zu mismatches\n",
+           label, threshold, (unsigned long long)stats.packets, (unsigned long long)stats.skipped,
+           stats.bytesIn ? double(stats.bytesOut) / stats.bytesIn : 1.0, double(wireBytes) / totalBytes,
+           compressNs / totalBytes, decompressNs / (decompressedBytes ? decompressedBytes : 1), mismatches);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t packets = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    std::string path = argc > 2 ? argv[2] : "packet_compressor_benchmark.dict";
+
+    // Train on one run of traffic, measure on another
+    Random trainingRandom(7);
+    std::vector<ByteBuffer> samples;
+    for (size_t i = 0; i < TRAINING_PACKETS; ++i)
+    {
+        samples.push_back(MakePayload(trainingRandom));
+    }
+
+    ByteBuffer trained;
+    if (!CompressionDictionary::Train(samples, DICTIONARY_CAPACITY, trained))
+    {
+        printf("dictionary training failed\n");
+        return 1;
+    }
+    std::ofstream(path.c_str(), std::ios::binary).write((const char*)trained.contents(), trained.wpos());
+    CompressionDictionary::Ptr dictionary = CompressionDictionary::Load(path, LEVEL);
+    remove(path.c_str());
+    if (!dictionary)
+    {
+        printf("could not load the trained dictionary from %s\n", path.c_str());
+        return 1;
+    }
+    printf("dictionary: %zu bytes from %zu samples\n", dictionary->GetSize(), samples.size());
+
+    Random random(42);
+    std::vector<ByteBuffer> payloads;
+    payloads.reserve(packets);
+    for (size_t i = 0; i < packets; ++i)
+    {
+        payloads.push_back(MakePayload(random));
+    }
+
+    // Without a dictionary small packets rarely shrink; the threshold
+    // decides how many are even tried
+    Run("no dictionary", CompressionDictionary::Ptr(), payloads, 0);
+    Run("no dictionary", CompressionDictionary::Ptr(), payloads, 128);
+    Run("dictionary", dictionary, payloads, 0);
+    Run("dictionary", dictionary, payloads, 128);
+    return 0;
+}
+
+#else
+
+int main()
+{
+    printf("built without HAVE_ZSTD, nothing to measure\n");
+    return 0;
+}
+
+#endif
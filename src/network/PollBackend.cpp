@@ -0,0 +1,419 @@
+#include "../../include/PollBackend.h"
+#include "../../include/Log.h"
+
+#include <map>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/select.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#include <poll.h>
+#endif
+
+/**
+ * @brief select() based backend, available everywhere
+ */
+class SelectPollBackend : public PollBackend
+{
+public:
+    bool Add(int fd, uint32_t events)
+    {
+        if (fd >= FD_SETSIZE)
+        {
+            return false;
+        }
+
+        m_watched[fd] = events;
+        return true;
+    }
+
+    bool Modify(int fd, uint32_t events)
+    {
+        std::map<int, uint32_t>::iterator itr = m_watched.find(fd);
+        if (itr == m_watched.end())
+        {
+            return false;
+        }
+
+        itr->second = events;
+        return true;
+    }
+
+    bool Remove(int fd)
+    {
+        return m_watched.erase(fd) > 0;
+    }
+
+    int Wait(std::vector<Event>& events, uint32_t timeoutMs)
+    {
+        events.clear();
+
+        fd_set readSet, writeSet, errorSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&errorSet);
+
+        int maxFd = -1;
+        for (std::map<int, uint32_t>::const_iterator itr = m_watched.begin(); itr != m_watched.end(); ++itr)
+        {
+            if (itr->second & POLL_READ)
+                FD_SET(itr->first, &readSet);
+            if (itr->second & POLL_WRITE)
+                FD_SET(itr->first, &writeSet);
+            FD_SET(itr->first, &errorSet);
+            if (itr->first > maxFd)
+                maxFd = itr->first;
+        }
+
+        struct timeval tv;
+        tv.tv_sec = timeoutMs / 1000;
+        tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+        int result = select(maxFd + 1, &readSet, &writeSet, &errorSet, &tv);
+        if (result <= 0)
+        {
+            return result < 0 && errno != EINTR ? -1 : 0;
+        }
+
+        for (std::map<int, uint32_t>::const_iterator itr = m_watched.begin(); itr != m_watched.end(); ++itr)
+        {
+            Event event;
+            event.fd = itr->first;
+            event.events = 0;
+            if (FD_ISSET(itr->first, &readSet))
+                event.events |= POLL_READ;
+            if (FD_ISSET(itr->first, &writeSet))
+                event.events |= POLL_WRITE;
+            if (FD_ISSET(itr->first, &errorSet))
+                event.events |= POLL_ERROR;
+            if (event.events)
+                events.push_back(event);
+        }
+
+        return (int)events.size();
+    }
+
+    const char* GetName() const
+    {
+        return "select";
+    }
+
+private:
+    std::map<int, uint32_t> m_watched;
+};
+
+#ifdef __linux__
+/**
+ * @brief Level-triggered epoll backend
+ */
+class EpollPollBackend : public PollBackend
+{
+public:
+    EpollPollBackend() : m_epollFd(epoll_create1(EPOLL_CLOEXEC)), m_ready(256)
+    {
+    }
+
+    ~EpollPollBackend()
+    {
+        if (m_epollFd >= 0)
+        {
+            close(m_epollFd);
+        }
+    }
+
+    bool IsValid() const
+    {
+        return m_epollFd >= 0;
+    }
+
+    bool Add(int fd, uint32_t events)
+    {
+        return Control(EPOLL_CTL_ADD, fd, events);
+    }
+
+    bool Modify(int fd, uint32_t events)
+    {
+        return Control(EPOLL_CTL_MOD, fd, events);
+    }
+
+    bool Remove(int fd)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        return epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, &ev) == 0;
+    }
+
+    int Wait(std::vector<Event>& events, uint32_t timeoutMs)
+    {
+        events.clear();
+
+        int count = epoll_wait(m_epollFd, &m_ready[0], (int)m_ready.size(), (int)timeoutMs);
+        if (count <= 0)
+        {
+            return count < 0 && errno != EINTR ? -1 : 0;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            Event event;
+            event.fd = m_ready[i].data.fd;
+            event.events = 0;
+            if (m_ready[i].events & (EPOLLIN | EPOLLRDHUP))
+                event.events |= POLL_READ;
+            if (m_ready[i].events & EPOLLOUT)
+                event.events |= POLL_WRITE;
+            if (m_ready[i].events & (EPOLLERR | EPOLLHUP))
+                event.events |= POLL_ERROR;
+            events.push_back(event);
+        }
+
+        // Grow the ready list when it was filled completely
+        if ((size_t)count == m_ready.size())
+        {
+            m_ready.resize(m_ready.size() * 2);
+        }
+
+        return count;
+    }
+
+    const char* GetName() const
+    {
+        return "epoll";
+    }
+
+private:
+    bool Control(int op, int fd, uint32_t events)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLRDHUP;
+        if (events & POLL_READ)
+            ev.events |= EPOLLIN;
+        if (events & POLL_WRITE)
+            ev.events |= EPOLLOUT;
+        ev.data.fd = fd;
+        return epoll_ctl(m_epollFd, op, fd, &ev) == 0;
+    }
+
+    int m_epollFd;
+    std::vector<struct epoll_event> m_ready;
+};
+#endif
+
+#ifdef HAVE_LIBURING
+/**
+ * @brief io_uring backend using one-shot poll requests
+ * 
+ * Every watched socket has one poll request in flight. The request is
+ * re-armed after it completes; a generation counter in the user data
+ * filters out completions for sockets that were removed or re-added.
+ */
+class IoUringPollBackend : public PollBackend
+{
+public:
+    IoUringPollBackend() : m_valid(io_uring_queue_init(1024, &m_ring, 0) == 0), m_generation(0)
+    {
+    }
+
+    ~IoUringPollBackend()
+    {
+        if (m_valid)
+        {
+            io_uring_queue_exit(&m_ring);
+        }
+    }
+
+    bool IsValid() const
+    {
+        return m_valid;
+    }
+
+    bool Add(int fd, uint32_t events)
+    {
+        Watch& watch = m_watched[fd];
+        watch.events = events;
+        watch.generation = ++m_generation;
+        return Arm(fd, watch);
+    }
+
+    bool Modify(int fd, uint32_t events)
+    {
+        std::map<int, Watch>::iterator itr = m_watched.find(fd);
+        if (itr == m_watched.end())
+        {
+            return false;
+        }
+
+        Cancel(itr->first, itr->second);
+        return Add(fd, events);
+    }
+
+    bool Remove(int fd)
+    {
+        std::map<int, Watch>::iterator itr = m_watched.find(fd);
+        if (itr == m_watched.end())
+        {
+            return false;
+        }
+
+        Cancel(itr->first, itr->second);
+        m_watched.erase(itr);
+        return true;
+    }
+
+    int Wait(std::vector<Event>& events, uint32_t timeoutMs)
+    {
+        events.clear();
+        io_uring_submit(&m_ring);
+
+        struct __kernel_timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = (long long)(timeoutMs % 1000) * 1000000;
+
+        struct io_uring_cqe* cqe = NULL;
+        int result = io_uring_wait_cqe_timeout(&m_ring, &cqe, &ts);
+        if (result < 0)
+        {
+            return result == -ETIME || result == -EINTR ? 0 : -1;
+        }
+
+        unsigned head;
+        unsigned count = 0;
+        io_uring_for_each_cqe(&m_ring, head, cqe)
+        {
+            ++count;
+            uint64_t userData = (uint64_t)(uintptr_t)io_uring_cqe_get_data(cqe);
+            int fd = (int)(userData & 0xFFFFFFFF);
+            uint32_t generation = (uint32_t)(userData >> 32);
+
+            std::map<int, Watch>::iterator itr = m_watched.find(fd);
+            if (itr == m_watched.end() || itr->second.generation != generation || cqe->res < 0)
+            {
+                continue;
+            }
+
+            Event event;
+            event.fd = fd;
+            event.events = 0;
+            if (cqe->res & (POLLIN | POLLRDHUP))
+                event.events |= POLL_READ;
+            if (cqe->res & POLLOUT)
+                event.events |= POLL_WRITE;
+            if (cqe->res & (POLLERR | POLLHUP))
+                event.events |= POLL_ERROR;
+            events.push_back(event);
+
+            Arm(fd, itr->second);
+        }
+        io_uring_cq_advance(&m_ring, count);
+
+        return (int)events.size();
+    }
+
+    const char* GetName() const
+    {
+        return "io_uring";
+    }
+
+private:
+    struct Watch
+    {
+        uint32_t events;
+        uint32_t generation;
+    };
+
+    static void* UserData(int fd, const Watch& watch)
+    {
+        return (void*)(uintptr_t)(((uint64_t)watch.generation << 32) | (uint32_t)fd);
+    }
+
+    struct io_uring_sqe* GetSqe()
+    {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+        if (!sqe)
+        {
+            io_uring_submit(&m_ring);
+            sqe = io_uring_get_sqe(&m_ring);
+        }
+        return sqe;
+    }
+
+    bool Arm(int fd, const Watch& watch)
+    {
+        struct io_uring_sqe* sqe = GetSqe();
+        if (!sqe)
+        {
+            return false;
+        }
+
+        unsigned mask = POLLRDHUP;
+        if (watch.events & POLL_READ)
+            mask |= POLLIN;
+        if (watch.events & POLL_WRITE)
+            mask |= POLLOUT;
+        io_uring_prep_poll_add(sqe, fd, mask);
+        io_uring_sqe_set_data(sqe, UserData(fd, watch));
+        return true;
+    }
+
+    void Cancel(int fd, const Watch& watch)
+    {
+        struct io_uring_sqe* sqe = GetSqe();
+        if (sqe)
+        {
+            io_uring_prep_cancel(sqe, UserData(fd, watch), 0);
+            io_uring_sqe_set_data(sqe, NULL);
+        }
+    }
+
+    struct io_uring m_ring;
+    bool m_valid;
+    uint32_t m_generation;
+    std::map<int, Watch> m_watched;
+};
+#endif
+
+PollBackend* PollBackend::Create(const std::string& name)
+{
+#ifdef HAVE_LIBURING
+    if (name == "io_uring")
+    {
+        IoUringPollBackend* backend = new IoUringPollBackend();
+        if (backend->IsValid())
+        {
+            return backend;
+        }
+
+        delete backend;
+        ERROR_LOG("io_uring backend unavailable, falling back to epoll");
+    }
+#endif
+
+#ifdef __linux__
+    if (name != "select")
+    {
+        EpollPollBackend* backend = new EpollPollBackend();
+        if (backend->IsValid())
+        {
+            return backend;
+        }
+
+        delete backend;
+        ERROR_LOG("epoll backend unavailable, falling back to select");
+    }
+#endif
+
+    return new SelectPollBackend();
+}
@@ -0,0 +1,58 @@
+#include "../../include/PolledSocketHandler.h"
+#include <Sockets/Socket.h>
+
+#include <chrono>
+
+/**
+ * @brief Get the current monotonic time in milliseconds
+ */
+static uint64_t NowMs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PolledSocketHandler::PolledSocketHandler()
+    : m_added(false)
+    , m_lastHousekeeping(0)
+{
+}
+
+PolledSocketHandler::~PolledSocketHandler()
+{
+}
+
+void PolledSocketHandler::Add(Socket* socket)
+{
+    SocketHandler::Add(socket);
+    m_dispatcher.Register(socket);
+    m_added = true;
+}
+
+void PolledSocketHandler::Remove(Socket* socket)
+{
+    m_dispatcher.Unregister(socket);
+    SocketHandler::Remove(socket);
+}
+
+int PolledSocketHandler::Poll(uint32_t maxWaitMs)
+{
+    if (!m_dispatcher.HasBackend())
+    {
+        uint32_t timeout = m_dispatcher.GetTimeout(maxWaitMs);
+        return Select(timeout / 1000, (timeout % 1000) * 1000);
+    }
+
+    int count = m_dispatcher.Poll(maxWaitMs);
+
+    // Let the socket library adopt new sockets and delete closed ones
+    uint64_t now = NowMs();
+    if (m_added || now - m_lastHousekeeping >= HOUSEKEEPING_INTERVAL)
+    {
+        m_added = false;
+        m_lastHousekeeping = now;
+        Select(0, 0);
+    }
+
+    return count;
+}
@@ -0,0 +1,193 @@
+#include "../../include/ReliabilityWindow.h"
+#include "../../include/RttEstimator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace {
+
+typedef SendWindow<64> BenchSendWindow;
+typedef ReceiveWindow<256> BenchReceiveWindow;
+
+const uint32_t TICK_MS = 33;          // 30 Hz
+const uint32_t ONE_WAY_DELAY_MS = 50;
+
+/**
+ * @brief Deterministic generator so runs compare
+ */
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    double Next()
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return double(state >> 11) / double(1ULL << 53);
+    }
+};
+
+/**
+ * @brief Datagram on the simulated link
+ */
+struct Datagram
+{
+    uint32_t arrival;
+    uint16_t sequence;
+    uint32_t ackBits;
+};
+
+/**
+ * @brief Result of one simulated session
+ */
+struct Result
+{
+    size_t sent;
+    size_t retransmits;
+    size_t timeouts;
+    size_t heldTicks;
+    size_t backlog;
+    std::vector<uint32_t> latencies;
+    double nsPerTick;
+};
+
+/**
+ * @brief Run a server-to-client session through a lossy link
+ *
+ * Follows GameSocket: reliable packets go through the send window, are
+ * held while it is full, and are resent from ForEachLost with the RTO of
+ * an RttEstimator. The client acknowledges with its own 30 Hz packets.
+ * Both directions lose the same share of datagrams.
+ */
+Result Run(double loss, size_t packetsPerTick, uint32_t seconds, uint64_t seed)
+{
+    Random random(seed);
+    BenchSendWindow window;
+    BenchReceiveWindow receiver;
+    RttEstimator rtt;
+    std::deque<Datagram> toClient, toServer;
+    std::vector<uint32_t> firstSent(65536, 0);
+    std::vector<bool> delivered(65536, false);
+    size_t held = 0;
+    uint16_t nextSequence = 0;
+
+    Result result = Result();
+    uint32_t duration = seconds * 1000;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t now = 0; now < duration; now += TICK_MS)
+    {
+        // Acks that reached the server
+        while (!toServer.empty() && toServer.front().arrival <= now)
+        {
+            Datagram ack = toServer.front();
+            toServer.pop_front();
+            window.AcknowledgeBits(ack.sequence, ack.ackBits, [&](const BenchSendWindow::Entry& entry) {
+                if (entry.sendCount == 1)
+                {
+                    rtt.AddSample(now - entry.sentTime);
+                }
+            });
+        }
+
+        // Resends, then the tick's new packets
+        bool timedOut = false;
+        window.ForEachLost(now, rtt.GetRto(), [&](BenchSendWindow::Entry& entry, bool expired) {
+            entry.sentTime = now;
+            ++entry.sendCount;
+            ++result.retransmits;
+            timedOut = timedOut || expired;
+            if (random.Next() >= loss)
+            {
+                Datagram datagram = { now + ONE_WAY_DELAY_MS, entry.sequence, 0 };
+                toClient.push_back(datagram);
+            }
+        });
+        if (timedOut)
+        {
+            rtt.OnTimeout();
+            ++result.timeouts;
+        }
+
+        held += packetsPerTick;
+        while (held && window.CanInsert(nextSequence))
+        {
+            uint16_t sequence = nextSequence++;
+            window.Insert(sequence, ByteBufferChain(), now);
+            firstSent[sequence] = now;
+            delivered[sequence] = false;
+            ++result.sent;
+            --held;
+            if (random.Next() >= loss)
+            {
+                Datagram datagram = { now + ONE_WAY_DELAY_MS, sequence, 0 };
+                toClient.push_back(datagram);
+            }
+        }
+        result.heldTicks += held != 0;
+
+        // The client records what arrived and acknowledges it
+        while (!toClient.empty() && toClient.front().arrival <= now)
+        {
+            uint16_t sequence = toClient.front().sequence;
+            toClient.pop_front();
+            receiver.Record(sequence);
+            if (!delivered[sequence])
+            {
+                delivered[sequence] = true;
+                result.latencies.push_back(now - firstSent[sequence]);
+            }
+        }
+        if (receiver.HasReceived() && random.Next() >= loss)
+        {
+            Datagram ack = { now + ONE_WAY_DELAY_MS, receiver.GetLatest(), receiver.GetAckBits() };
+            toServer.push_back(ack);
+        }
+    }
+    result.backlog = held;
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    result.nsPerTick = elapsed / (duration / TICK_MS);
+    return result;
+}
+
+void Report(double loss, size_t packetsPerTick, uint32_t seconds)
+{
+    Result result = Run(loss, packetsPerTick, seconds, 42);
+    std::vector<uint32_t>& latencies = result.latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    double mean = 0.0;
+    for (size_t i = 0; i < latencies.size(); ++i)
+    {
+        mean += latencies[i];
+    }
+    mean /= latencies.empty() ? 1 : latencies.size();
+    uint32_t p99 = latencies.empty() ? 0 : latencies[latencies.size() * 99 / 100];
+    uint32_t max = latencies.empty() ? 0 : latencies.back();
+
+    printf("loss %4.1f%%, %zu pkt/tick: %zu sent, %zu delivered, %.1f%% resent, %zu RTO expiries, "
+           "latency mean %.0f p99 %u max %u ms, window full on %zu ticks, %zu left held, %.0f ns/tick\n",
+           loss * 100.0, packetsPerTick, result.sent, latencies.size(),
+           100.0 * result.retransmits / (result.sent ? result.sent : 1), result.timeouts,
+           mean, p99, max, result.heldTicks, result.backlog, result.nsPerTick);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint32_t seconds = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 600;
+
+    // 30 Hz ticks, 100 ms round trip; lossless as the baseline. The last
+    // run sends more than the 33 sequence window carries once losses stall
+    // it, so packets back up behind it
+    Report(0.0, 2, seconds);
+    Report(0.05, 2, seconds);
+    Report(0.05, 6, seconds);
+    return 0;
+}
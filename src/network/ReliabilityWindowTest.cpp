@@ -0,0 +1,205 @@
+#include "../../include/ReliabilityWindow.h"
+#include "../../include/UnitTest.h"
+
+
+namespace {
+
+typedef SendWindow<64> TestSendWindow;
+typedef ReceiveWindow<256> TestReceiveWindow;
+
+/**
+ * @brief Packet as GameSocket holds it, reduced to what the tests need
+ */
+struct Packet
+{
+    bool reliable;
+};
+
+typedef HeldPacketQueue<Packet, 256> TestHeldQueue;
+
+/**
+ * @brief Sender and receiver joined by a lossless link
+ *
+ * Follows GameSocket::HoldPacket and ReleaseHeldPackets: every packet is
+ * offered to the held queue before it takes a sequence number, and
+ * released packets go through Send again. Acks are sent in batches, as
+ * with ACK_DELAY, so many packets arrive between two acks.
+ */
+struct Link
+{
+    TestSendWindow sender;
+    TestReceiveWindow receiver;
+    TestHeldQueue held;
+    uint16_t nextSequence;
+    size_t delivered;
+    size_t overflowed;
+
+    explicit Link(uint16_t firstSequence) : nextSequence(firstSequence), delivered(0), overflowed(0) {}
+
+    void Send(bool reliable)
+    {
+        Packet packet = { reliable };
+        TestHeldQueue::Result result = held.Offer(sender, nextSequence, reliable, [&]() { return packet; });
+        if (result == TestHeldQueue::HOLD_SEND)
+        {
+            Transmit(packet);
+        }
+        overflowed += result == TestHeldQueue::HOLD_OVERFLOW;
+    }
+
+    void Transmit(const Packet& packet)
+    {
+        uint16_t sequence = nextSequence++;
+        if (packet.reliable)
+        {
+            TEST_CHECK(sender.Insert(sequence, ByteBufferChain(), 0) != nullptr);
+            receiver.Record(sequence);
+        }
+        ++delivered;
+    }
+
+    void Acknowledge()
+    {
+        sender.AcknowledgeBits(receiver.GetLatest(), receiver.GetAckBits());
+        held.Release(sender, nextSequence, [this](Packet& packet) { Send(packet.reliable); });
+    }
+};
+
+/**
+ * @brief A burst of more packets than one ack covers, without loss, drains
+ *
+ * Every reliable packet is delivered; unreliable ones are dropped while
+ * the window is full rather than queued behind the reliable ones.
+ */
+void TestBurstDrains(uint16_t firstSequence, size_t count, int unreliableEvery)
+{
+    Link link(firstSequence);
+    size_t reliable = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool isReliable = unreliableEvery == 0 || i % unreliableEvery != 0;
+        reliable += isReliable;
+        link.Send(isReliable);
+    }
+
+    TEST_CHECK(link.sender.GetInFlight() <= TestSendWindow::GetCapacity());
+    TEST_CHECK(link.held.GetHeld() != 0);
+    TEST_CHECK((link.held.GetDropped() != 0) == (unreliableEvery != 0));
+
+    for (int round = 0; round < 16 && (link.sender.GetInFlight() || link.held.GetHeld()); ++round)
+    {
+        link.Acknowledge();
+    }
+
+    TEST_CHECK(link.sender.GetInFlight() == 0);
+    TEST_CHECK(link.held.GetHeld() == 0);
+    TEST_CHECK(link.delivered == count - link.held.GetDropped());
+    TEST_CHECK(link.delivered >= reliable);
+    TEST_CHECK(link.overflowed == 0);
+}
+
+/**
+ * @brief The held queue is bounded; the packets past it are reported
+ */
+void TestHeldQueueBounded()
+{
+    Link link(0);
+    size_t count = ACK_SEQUENCE_COVERAGE + TestHeldQueue::GetCapacity() + 10;
+    for (size_t i = 0; i < count; ++i)
+    {
+        link.Send(true);
+    }
+
+    TEST_CHECK(link.sender.GetInFlight() == ACK_SEQUENCE_COVERAGE);
+    TEST_CHECK(link.held.GetHeld() == TestHeldQueue::GetCapacity());
+    TEST_CHECK(link.overflowed == 10);
+
+    // Unreliable packets are dropped, not queued, while packets are held
+    link.Send(false);
+    TEST_CHECK(link.held.GetHeld() == TestHeldQueue::GetCapacity());
+    TEST_CHECK(link.held.GetDropped() == 1);
+}
+
+/**
+ * @brief The span in flight never exceeds what one ack reports
+ */
+void TestSpanIsCapped()
+{
+    TestSendWindow window;
+    TEST_CHECK(TestSendWindow::GetCapacity() == ACK_SEQUENCE_COVERAGE);
+    TEST_CHECK(window.Insert(100, ByteBufferChain(), 0) != nullptr);
+    TEST_CHECK(window.CanInsert((uint16_t)(100 + ACK_SEQUENCE_COVERAGE - 1)));
+    TEST_CHECK(!window.CanInsert((uint16_t)(100 + ACK_SEQUENCE_COVERAGE)));
+    TEST_CHECK(window.Insert((uint16_t)(100 + ACK_SEQUENCE_COVERAGE), ByteBufferChain(), 0) == nullptr);
+
+    // The newest sequence that fits is still covered by an ack for itself
+    TEST_CHECK(window.Insert((uint16_t)(100 + ACK_SEQUENCE_COVERAGE - 1), ByteBufferChain(), 0) != nullptr);
+    TestReceiveWindow receiver;
+    receiver.Record(100);
+    receiver.Record((uint16_t)(100 + ACK_SEQUENCE_COVERAGE - 1));
+    TEST_CHECK(window.AcknowledgeBits(receiver.GetLatest(), receiver.GetAckBits()) == 2);
+    TEST_CHECK(window.GetInFlight() == 0);
+}
+
+/**
+ * @brief A lost ack is made up for by the next one
+ */
+void TestLostAck()
+{
+    Link link(0);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        link.Send(true);
+    }
+
+    // The ack for the first 20 packets is lost; more packets fill the
+    // window, and the next ack must still reach back to the first one
+    for (size_t i = 0; i < 20; ++i)
+    {
+        link.Send(true);
+    }
+    TEST_CHECK(link.sender.GetInFlight() == ACK_SEQUENCE_COVERAGE);
+
+    link.Acknowledge();
+    TEST_CHECK(link.sender.GetInFlight() == 40 - ACK_SEQUENCE_COVERAGE);
+    link.Acknowledge();
+    TEST_CHECK(link.sender.GetInFlight() == 0);
+    TEST_CHECK(link.delivered == 40);
+}
+
+/**
+ * @brief Clear forgets the acknowledgments as well as the packets
+ */
+void TestClear()
+{
+    TestSendWindow window;
+    for (uint16_t sequence = 10; sequence <= 20; ++sequence)
+    {
+        window.Insert(sequence, ByteBufferChain(), 0);
+    }
+    TEST_CHECK(window.Acknowledge(20));
+    window.Clear();
+    TEST_CHECK(window.GetInFlight() == 0);
+
+    // Sequence 10 again is a new packet, not one overtaken by the old ack
+    TEST_CHECK(window.Insert(10, ByteBufferChain(), 0) != nullptr);
+    size_t lost = window.ForEachLost(0, 1000, [](TestSendWindow::Entry&, bool) {});
+    TEST_CHECK(lost == 0);
+    TEST_CHECK(window.GetOldest() == 10);
+    TEST_CHECK(window.Acknowledge(10));
+    TEST_CHECK(window.GetInFlight() == 0);
+}
+
+} // namespace
+
+int main()
+{
+    TestSpanIsCapped();
+    TestBurstDrains(0, 74, 0);
+    TestBurstDrains(65500, 74, 0);     // across the sequence wrap
+    TestBurstDrains(1000, 300, 3);     // unreliable packets share the sequence space
+    TestLostAck();
+    TestHeldQueueBounded();
+    TestClear();
+    return UnitTest::Result("ReliabilityWindowTest");
+}
@@ -0,0 +1,216 @@
+#include "../../include/SendScheduler.h"
+
+#include <cstring>
+#include <algorithm>
+
+/**
+ * @brief Longest an unreliable message may wait per class (ms, 0 = forever)
+ */
+static const uint32_t s_maxAge[PRIORITY_COUNT] = { 0, 100, 200, 500, 5000 };
+
+/**
+ * @brief Most messages a class may queue before unreliable ones are dropped
+ */
+static const size_t s_maxQueued[PRIORITY_COUNT] = { 0, 32, 512, 512, 128 };
+
+/**
+ * @brief Budget increase per second of uncongested sending (bytes/s)
+ */
+static const uint32_t RATE_INCREASE = 2048;
+
+SendScheduler::SendScheduler(uint32_t maxRate, uint32_t minRate, uint32_t burst, uint32_t overhead)
+    : m_superseded(0)
+    , m_maxRate(maxRate)
+    , m_minRate(std::min(minRate, maxRate))
+    , m_rate(maxRate)
+    , m_burst(burst)
+    , m_overhead(overhead)
+    , m_tokens(burst)
+    , m_lastRefill(0)
+    , m_refilled(false)
+    , m_congested(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void SendScheduler::SetBudget(uint32_t maxRate, uint32_t minRate, uint32_t burst)
+{
+    m_maxRate = maxRate;
+    m_minRate = std::min(minRate, maxRate);
+    m_rate = std::min(std::max(m_rate, m_minRate), m_maxRate);
+    m_burst = burst;
+    m_tokens = std::min<int64_t>(m_tokens, m_burst);
+}
+
+void SendScheduler::Enqueue(SendPriority priority, uint16_t type, const ByteBufferChain::SharedBuffer& block, bool reliable, uint32_t coalesceKey, uint32_t now, bool encrypted)
+{
+    // A null block marks a superseded message
+    if (!block)
+    {
+        return;
+    }
+
+    // Latest state wins: overwrite the queued message in place, or
+    // supersede it when the key moved to another class
+    if (coalesceKey && !reliable)
+    {
+        std::unordered_map<uint32_t, Coalesced>::iterator itr = m_coalesce.find(coalesceKey);
+        if (itr != m_coalesce.end())
+        {
+            Message* queued = itr->second.message;
+            ++m_stats.coalesced[itr->second.priority];
+            if (itr->second.priority == (size_t)priority)
+            {
+                queued->type = type;
+                queued->block = block;
+                queued->encrypted = encrypted;
+                queued->queuedTime = now;
+                return;
+            }
+
+            queued->block.reset();
+            queued->coalesceKey = 0;
+            ++m_superseded;
+            m_coalesce.erase(itr);
+        }
+    }
+
+    Message message;
+    message.type = type;
+    message.block = block;
+    message.reliable = reliable;
+    message.encrypted = encrypted;
+    message.coalesceKey = reliable ? 0 : coalesceKey;
+    message.queuedTime = now;
+    m_queues[priority].push_back(message);
+
+    if (message.coalesceKey)
+    {
+        Coalesced coalesced = { &m_queues[priority].back(), (size_t)priority };
+        m_coalesce[message.coalesceKey] = coalesced;
+    }
+
+    // Shed the oldest unreliable messages of an overflowing class
+    std::deque<Message>& queue = m_queues[priority];
+    while (s_maxQueued[priority] && queue.size() > s_maxQueued[priority] && !queue.front().reliable)
+    {
+        m_stats.dropped[priority] += queue.front().block ? 1 : 0;
+        PopFront(priority);
+    }
+}
+
+size_t SendScheduler::Flush(uint32_t now, const SendCallback& send)
+{
+    // Refill the bucket and grow the budget while nothing timed out
+    if (!m_refilled)
+    {
+        m_refilled = true;
+        m_lastRefill = now;
+    }
+
+    uint32_t elapsed = now - m_lastRefill;
+    if (elapsed)
+    {
+        m_lastRefill = now;
+        m_tokens = std::min<int64_t>(m_burst, m_tokens + (int64_t)elapsed * m_rate / 1000);
+
+        if (!m_congested)
+        {
+            m_rate = std::min<uint32_t>(m_maxRate, m_rate + (uint32_t)((uint64_t)elapsed * RATE_INCREASE / 1000));
+        }
+        m_congested = false;
+    }
+
+    size_t released = 0;
+    for (size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+    {
+        Expire(priority, now);
+
+        std::deque<Message>& queue = m_queues[priority];
+        for (SkipSuperseded(priority); !queue.empty(); SkipSuperseded(priority))
+        {
+            // Messages larger than the bucket wait for a full bucket and
+            // go into debt, instead of waiting for tokens that never come
+            uint32_t cost = Cost(queue.front());
+            if (priority != PRIORITY_CONTROL && m_tokens < (int64_t)std::min(cost, m_burst))
+            {
+                break;
+            }
+
+            m_tokens -= cost;
+            m_stats.bytesSent += cost;
+            ++m_stats.sent[priority];
+            ++released;
+
+            send(queue.front());
+            PopFront(priority);
+        }
+
+        // Lower classes must not overtake a class that is waiting for budget
+        if (!queue.empty())
+        {
+            break;
+        }
+    }
+
+    return released;
+}
+
+void SendScheduler::OnCongestion()
+{
+    m_rate = std::max(m_minRate, m_rate / 2);
+    m_congested = true;
+}
+
+size_t SendScheduler::GetQueuedCount() const
+{
+    size_t count = 0;
+    for (size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+    {
+        count += m_queues[priority].size();
+    }
+    return count - m_superseded;
+}
+
+void SendScheduler::Expire(size_t priority, uint32_t now)
+{
+    if (!s_maxAge[priority])
+    {
+        return;
+    }
+
+    std::deque<Message>& queue = m_queues[priority];
+    for (SkipSuperseded(priority); !queue.empty() && !queue.front().reliable && now - queue.front().queuedTime > s_maxAge[priority]; SkipSuperseded(priority))
+    {
+        PopFront(priority);
+        ++m_stats.dropped[priority];
+    }
+}
+
+void SendScheduler::PopFront(size_t priority)
+{
+    std::deque<Message>& queue = m_queues[priority];
+    if (queue.front().coalesceKey)
+    {
+        m_coalesce.erase(queue.front().coalesceKey);
+    }
+    if (!queue.front().block)
+    {
+        --m_superseded;
+    }
+    queue.pop_front();
+}
+
+void SendScheduler::SkipSuperseded(size_t priority)
+{
+    std::deque<Message>& queue = m_queues[priority];
+    while (!queue.empty() && !queue.front().block)
+    {
+        PopFront(priority);
+    }
+}
+
+uint32_t SendScheduler::Cost(const Message& message) const
+{
+    return (uint32_t)message.block->wpos() + m_overhead;
+}
@@ -0,0 +1,133 @@
+#include "../../include/SendScheduler.h"
+#include "../../include/UnitTest.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+ByteBufferChain::SharedBuffer MakeBlock(size_t size)
+{
+    std::shared_ptr<ByteBuffer> block = std::make_shared<ByteBuffer>();
+    for (size_t i = 0; i < size; ++i)
+    {
+        *block << uint8_t(i);
+    }
+    return block;
+}
+
+/**
+ * @brief Flush every tick until the time limit, recording what was sent
+ */
+uint32_t FlushUntilEmpty(SendScheduler& scheduler, uint32_t start, uint32_t limit, std::vector<uint16_t>& sent)
+{
+    uint32_t now = start;
+    for (; now <= limit && scheduler.GetQueuedCount(); now += 10)
+    {
+        scheduler.Flush(now, [&sent](const SendScheduler::Message& message) {
+            sent.push_back(message.type);
+        });
+    }
+    return now;
+}
+
+/**
+ * @brief A message costing more than the bucket holds is sent, and does not starve lower classes
+ */
+void TestOverBurstMessage()
+{
+    // 1000 bytes/s, 500 byte bucket
+    SendScheduler scheduler(1000, 1000, 500, 0);
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 1, MakeBlock(2000), true, 0, 0);
+    scheduler.Enqueue(PRIORITY_CHAT, 2, MakeBlock(100), true, 0, 0);
+
+    std::vector<uint16_t> sent;
+    FlushUntilEmpty(scheduler, 0, 10000, sent);
+
+    TEST_CHECK(scheduler.GetQueuedCount() == 0);
+    TEST_CHECK(sent.size() == 2);
+    TEST_CHECK(sent.size() == 2 && sent[0] == 1 && sent[1] == 2);
+}
+
+/**
+ * @brief The debt of an over-burst message is repaid before anything else goes out
+ */
+void TestDebtIsRepaid()
+{
+    SendScheduler scheduler(1000, 1000, 500, 0);
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 1, MakeBlock(2000), true, 0, 0);
+
+    std::vector<uint16_t> sent;
+    scheduler.Flush(0, [&sent](const SendScheduler::Message& message) { sent.push_back(message.type); });
+    TEST_CHECK(sent.size() == 1);
+
+    // 1500 bytes of debt take 1.5 s at 1000 bytes/s, plus 100 ms for the next message
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 2, MakeBlock(100), true, 0, 0);
+    uint32_t done = FlushUntilEmpty(scheduler, 10, 10000, sent);
+    TEST_CHECK(sent.size() == 2);
+    TEST_CHECK(done >= 1600);
+}
+
+/**
+ * @brief Control messages go out regardless of the budget; other classes keep their order
+ */
+void TestPriorityOrder()
+{
+    SendScheduler scheduler(1000, 1000, 500, 0);
+    scheduler.Enqueue(PRIORITY_CHAT, 4, MakeBlock(100), true, 0, 0);
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 2, MakeBlock(450), true, 0, 0);
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 3, MakeBlock(450), true, 0, 0);
+    scheduler.Enqueue(PRIORITY_CONTROL, 1, MakeBlock(5000), true, 0, 0);
+
+    std::vector<uint16_t> sent;
+    scheduler.Flush(0, [&sent](const SendScheduler::Message& message) { sent.push_back(message.type); });
+    TEST_CHECK(sent.size() == 1 && sent[0] == 1);
+
+    FlushUntilEmpty(scheduler, 10, 20000, sent);
+    TEST_CHECK(sent.size() == 4);
+    TEST_CHECK(sent.size() == 4 && sent[1] == 2 && sent[2] == 3 && sent[3] == 4);
+}
+
+/**
+ * @brief An update whose key moved to another class replaces the copy in the old class
+ */
+void TestCoalesceAcrossClasses()
+{
+    SendScheduler scheduler(100000, 100000, 100000, 0);
+    scheduler.Enqueue(PRIORITY_DISTANT_OBJECTS, 1, MakeBlock(10), false, 7, 0);
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 2, MakeBlock(10), false, 7, 0);
+    TEST_CHECK(scheduler.GetQueuedCount() == 1);
+
+    // And back again, then once more in the same class
+    scheduler.Enqueue(PRIORITY_DISTANT_OBJECTS, 3, MakeBlock(10), false, 7, 0);
+    scheduler.Enqueue(PRIORITY_DISTANT_OBJECTS, 4, MakeBlock(10), false, 7, 0);
+    scheduler.Enqueue(PRIORITY_NEARBY_OBJECTS, 5, MakeBlock(10), false, 8, 0);
+    TEST_CHECK(scheduler.GetQueuedCount() == 2);
+
+    std::vector<uint16_t> sent;
+    scheduler.Flush(0, [&sent](const SendScheduler::Message& message) { sent.push_back(message.type); });
+    TEST_CHECK(sent.size() == 2 && sent[0] == 5 && sent[1] == 4);
+    TEST_CHECK(scheduler.GetQueuedCount() == 0);
+
+    SendScheduler::Stats stats;
+    scheduler.GetStats(stats);
+    TEST_CHECK(stats.coalesced[PRIORITY_DISTANT_OBJECTS] == 2);
+    TEST_CHECK(stats.coalesced[PRIORITY_NEARBY_OBJECTS] == 1);
+    TEST_CHECK(stats.sent[PRIORITY_DISTANT_OBJECTS] == 1 && stats.sent[PRIORITY_NEARBY_OBJECTS] == 1);
+    TEST_CHECK(stats.dropped[PRIORITY_DISTANT_OBJECTS] == 0 && stats.dropped[PRIORITY_NEARBY_OBJECTS] == 0);
+
+    // The key is free again once its message went out
+    scheduler.Enqueue(PRIORITY_CHAT, 6, MakeBlock(10), false, 7, 0);
+    TEST_CHECK(scheduler.GetQueuedCount() == 1);
+}
+
+} // namespace
+
+int main()
+{
+    TestOverBurstMessage();
+    TestDebtIsRepaid();
+    TestPriorityOrder();
+    TestCoalesceAcrossClasses();
+    return UnitTest::Result("SendSchedulerTest");
+}
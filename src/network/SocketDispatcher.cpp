@@ -0,0 +1,167 @@
+#include "../../include/SocketDispatcher.h"
+#include "../../include/Log.h"
+#include <Sockets/Socket.h>
+
+#include <chrono>
+
+SocketDispatcher::SocketDispatcher()
+{
+}
+
+SocketDispatcher::~SocketDispatcher()
+{
+}
+
+bool SocketDispatcher::SetBackend(const std::string& name)
+{
+    std::unique_ptr<PollBackend> backend(PollBackend::Create(name));
+    bool requested = name == backend->GetName();
+
+    for (std::unordered_map<int, uint32_t>::const_iterator itr = m_watchedEvents.begin(); itr != m_watchedEvents.end(); ++itr)
+    {
+        if (m_backend)
+        {
+            m_backend->Remove(itr->first);
+        }
+        backend->Add(itr->first, itr->second);
+    }
+
+    m_backend = std::move(backend);
+    INFO_LOG(format("Using %1% socket readiness backend") % m_backend->GetName());
+    return requested;
+}
+
+void SocketDispatcher::Register(Socket* socket, uint32_t events)
+{
+    int fd = (int)socket->GetSocket();
+    bool watched = m_sockets.find(fd) != m_sockets.end();
+    m_sockets[fd] = socket;
+    m_watchedEvents[fd] = events;
+
+    // A socket can be registered explicitly and again when it is added
+    if (watched)
+    {
+        if (m_backend)
+        {
+            m_backend->Modify(fd, events);
+        }
+        return;
+    }
+
+    if (m_backend && !m_backend->Add(fd, events))
+    {
+        ERROR_LOG(format("Failed to watch socket %1% with %2%") % fd % m_backend->GetName());
+    }
+}
+
+void SocketDispatcher::Modify(Socket* socket, uint32_t events)
+{
+    int fd = (int)socket->GetSocket();
+    if (m_sockets.find(fd) == m_sockets.end())
+    {
+        return;
+    }
+
+    m_watchedEvents[fd] = events;
+    if (m_backend)
+    {
+        m_backend->Modify(fd, events);
+    }
+}
+
+void SocketDispatcher::Unregister(Socket* socket)
+{
+    // The descriptor may already be closed, or reused by another socket
+    int fd = (int)socket->GetSocket();
+    std::unordered_map<int, Socket*>::iterator itr = m_sockets.find(fd);
+    if (itr == m_sockets.end() || itr->second != socket)
+    {
+        for (itr = m_sockets.begin(); itr != m_sockets.end() && itr->second != socket; ++itr)
+        {
+        }
+        if (itr == m_sockets.end())
+        {
+            return;
+        }
+        fd = itr->first;
+    }
+
+    m_sockets.erase(itr);
+
+    m_watchedEvents.erase(fd);
+    if (m_backend)
+    {
+        m_backend->Remove(fd);
+    }
+}
+
+void SocketDispatcher::ScheduleDeadline(uint32_t delayMs)
+{
+    m_deadlines.push(Now() + delayMs);
+}
+
+uint32_t SocketDispatcher::GetTimeout(uint32_t maxWaitMs)
+{
+    uint64_t now = Now();
+    while (!m_deadlines.empty() && m_deadlines.top() <= now)
+    {
+        m_deadlines.pop();
+    }
+
+    if (m_deadlines.empty())
+    {
+        return maxWaitMs;
+    }
+
+    uint64_t untilDeadline = m_deadlines.top() - now;
+    return untilDeadline < maxWaitMs ? (uint32_t)untilDeadline : maxWaitMs;
+}
+
+int SocketDispatcher::Poll(uint32_t maxWaitMs)
+{
+    if (!m_backend)
+    {
+        return -1;
+    }
+
+    int count = m_backend->Wait(m_events, GetTimeout(maxWaitMs));
+    if (count <= 0)
+    {
+        return count;
+    }
+
+    for (size_t i = 0; i < m_events.size(); ++i)
+    {
+        const PollBackend::Event& event = m_events[i];
+
+        // A callback may have closed and unregistered the socket
+        std::unordered_map<int, Socket*>::iterator itr = m_sockets.find(event.fd);
+        if (itr == m_sockets.end())
+        {
+            continue;
+        }
+
+        // Errors are picked up by the read path
+        if (event.events & (PollBackend::POLL_READ | PollBackend::POLL_ERROR))
+        {
+            itr->second->OnRead();
+        }
+
+        if (event.events & PollBackend::POLL_WRITE)
+        {
+            itr = m_sockets.find(event.fd);
+            if (itr != m_sockets.end())
+            {
+                itr->second->OnWrite();
+            }
+        }
+    }
+
+    return count;
+}
+
+uint64_t SocketDispatcher::Now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}